@@ -3,76 +3,55 @@
 
 
 
+/*
+ * Normalize the color image by the maximum norm of the pixels
+ * if it exceeds 1.0
+ */
+template <class T>
+static void
+color_image_normalizer(ImgVector<T>* image)
+{
+	double max_int = image->reduce_norm().max();
+	if (max_int > 1.0) {
+		*image /= max_int;
+	}
+}
+
+
 // ----- Specialize -----
 template <>
 void
 BlockMatching<ImgClass::RGB>::image_normalizer(void)
 {
-	// Previous
-	double max_int = .0;
-	for (size_t i = 0; i < _image_prev.size(); i++) {
-		if (norm(_image_prev[i]) > max_int) {
-			max_int = norm(_image_prev[i]);
-		}
-	}
-	if (max_int > 1.0) {
-		_image_prev /= max_int;
-	}
-	// Current
-	max_int = .0;
-	for (size_t i = 0; i < _image_current.size(); i++) {
-		if (norm(_image_current[i]) > max_int) {
-			max_int = norm(_image_current[i]);
-		}
-	}
-	if (max_int > 1.0) {
-		_image_current /= max_int;
-	}
-	// Next
-	max_int = .0;
-	for (size_t i = 0; i < _image_next.size(); i++) {
-		if (norm(_image_next[i]) > max_int) {
-			max_int = norm(_image_next[i]);
-		}
-	}
-	if (max_int > 1.0) {
-		_image_next /= max_int;
-	}
+	color_image_normalizer(&_image_prev); // Previous
+	color_image_normalizer(&_image_current); // Current
+	color_image_normalizer(&_image_next); // Next
+}
+
+template <>
+void
+BlockMatching<ImgClass::RGBf>::image_normalizer(void)
+{
+	color_image_normalizer(&_image_prev); // Previous
+	color_image_normalizer(&_image_current); // Current
+	color_image_normalizer(&_image_next); // Next
 }
 
 template <>
 void
 BlockMatching<ImgClass::Lab>::image_normalizer(void)
 {
-	// Previous
-	double max_int = .0;
-	for (size_t i = 0; i < _image_prev.size(); i++) {
-		if (norm(_image_prev[i]) > max_int) {
-			max_int = norm(_image_prev[i]);
-		}
-	}
-	if (max_int > 1.0) {
-		_image_prev /= max_int;
-	}
-	// Current
-	max_int = .0;
-	for (size_t i = 0; i < _image_current.size(); i++) {
-		if (norm(_image_current[i]) > max_int) {
-			max_int = norm(_image_current[i]);
-		}
-	}
-	if (max_int > 1.0) {
-		_image_current /= max_int;
-	}
-	// Next
-	max_int = .0;
-	for (size_t i = 0; i < _image_next.size(); i++) {
-		if (norm(_image_next[i]) > max_int) {
-			max_int = norm(_image_next[i]);
-		}
-	}
-	if (max_int > 1.0) {
-		_image_next /= max_int;
-	}
+	color_image_normalizer(&_image_prev); // Previous
+	color_image_normalizer(&_image_current); // Current
+	color_image_normalizer(&_image_next); // Next
+}
+
+template <>
+void
+BlockMatching<ImgClass::Labf>::image_normalizer(void)
+{
+	color_image_normalizer(&_image_prev); // Previous
+	color_image_normalizer(&_image_current); // Current
+	color_image_normalizer(&_image_next); // Next
 }
 
@@ -13,11 +13,7 @@
 #include "Color.h"
 #include "Vector.h"
 #include "ImgClass.h"
-
-namespace ImgClass {
-	class RGB;
-	class Lab;
-}
+#include "IntegralImage.h"
 
 template <class T>
 class BlockMatching
@@ -38,6 +34,10 @@ class BlockMatching
 		ImgVector<T> _color_quantized_prev;
 		ImgVector<T> _color_quantized_current;
 		ImgVector<T> _color_quantized_next;
+		// Integral images of the images for ZNCC (built in block_matching_lattice())
+		IntegralImage<T> _integral_prev;
+		IntegralImage<T> _integral_current;
+		IntegralImage<T> _integral_next;
 		ImgVector<Vector_ST<double> > _motion_vector_time;
 		ImgVector<VECTOR_2D<double> > _motion_vector_prev;
 		ImgVector<VECTOR_2D<double> > _motion_vector_next;
@@ -110,9 +110,13 @@ class BlockMatching
 		void vector_interpolation(const std::list<VECTOR_2D<int> >& flat_blocks, ImgVector<bool>* estimated);
 
 		// Correlation function
+		const IntegralImage<T>* integral_image(const ImgVector<T>& image) const; // nullptr if the integral image of image is not built
 		double MAD(const ImgVector<T>& reference, const ImgVector<T>& interest, const int x_ref, const int y_ref, const int x_int, const int y_int);
-		double MAD_cubic(const ImgVector<T>& reference, const ImgVector<T>& interest, const double x_ref, const double y_ref, const double x_int, const double y_int);
+		double MAD_cubic(const ImgVector<T>& reference, const ImgVector<T>& interest, const double x_ref, const double y_ref, const double x_int, const double y_int, typename ImgPromote<T>::type* block_reference, typename ImgPromote<T>::type* block_interest); // block_* : scratch of _block_size^2 pixels
 		double ZNCC(const ImgVector<T>& reference, const ImgVector<T>& interest, const int x_ref, const int y_ref, const int x_int, const int y_int);
+		// Correlation function on the search window copied by ImgVector<T>::copy_window_zeropad() (candidate : top left of the block in the window)
+		double MAD_window(const T* candidate, const int window_stride, const T* block);
+		double ZNCC_window(const ImgVector<T>& reference, const ImgVector<T>& interest, const int x_ref, const int y_ref, const int x_int, const int y_int, const T* candidate, const int window_stride, const T* block);
 		// Arbitrary shaped correlation function
 		double MAD_region(const ImgVector<T>& reference, const ImgVector<T>& interest, const int x_diff, const int y_diff, const std::vector<VECTOR_2D<int> >& region_interest);
 		double MAD_region_cubic(const ImgVector<T>& reference, const ImgVector<T>& interest, const double x_diff, const double y_diff, const std::vector<VECTOR_2D<int> >& region_interest);
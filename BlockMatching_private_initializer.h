@@ -54,8 +54,8 @@ BlockMatching<T>::BlockMatching(const ImgVector<T>& image_prev, const ImgVector<
 	_cells_height = int(ceil(double(_height) / double(_block_size)));
 	_subpixel_scale = Subpixel_Scale;
 
-	_image_prev.copy(image_prev);
-	_image_current.copy(image_current);
+	_image_prev.view(image_prev);
+	_image_current.view(image_current);
 
 	// Normalize the image
 	image_normalizer();
@@ -94,9 +94,9 @@ BlockMatching<T>::BlockMatching(const ImgVector<T>& image_prev, const ImgVector<
 	_cells_height = int(ceil(double(_height) / double(_block_size)));
 	_subpixel_scale = Subpixel_Scale;
 
-	_image_prev.copy(image_prev);
-	_image_current.copy(image_current);
-	_image_next.copy(image_next);
+	_image_prev.view(image_prev);
+	_image_current.view(image_current);
+	_image_next.view(image_next);
 
 	// Normalize the image
 	image_normalizer();
@@ -141,10 +141,10 @@ BlockMatching<T>::BlockMatching(const ImgVector<T>& image_prev, const ImgVector<
 	_cells_height = _height;
 	_subpixel_scale = Subpixel_Scale;
 
-	_image_prev.copy(image_prev);
-	_image_current.copy(image_current);
-	_region_map_prev.copy(region_map_prev);
-	_region_map_current.copy(region_map_current);
+	_image_prev.view(image_prev);
+	_image_current.view(image_current);
+	_region_map_prev.view(region_map_prev);
+	_region_map_current.view(region_map_current);
 	// Normalize the image
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_BLOCKMATCHING)
 	std::cout << " Block Matching : Normalize the input images" << std::endl;
@@ -203,12 +203,12 @@ BlockMatching<T>::BlockMatching(const ImgVector<T>& image_prev, const ImgVector<
 	_cells_height = _height;
 	_subpixel_scale = Subpixel_Scale;
 
-	_image_prev.copy(image_prev);
-	_image_current.copy(image_current);
-	_image_next.copy(image_next);
-	_region_map_prev.copy(region_map_prev);
-	_region_map_current.copy(region_map_current);
-	_region_map_next.copy(region_map_next);
+	_image_prev.view(image_prev);
+	_image_current.view(image_current);
+	_image_next.view(image_next);
+	_region_map_prev.view(region_map_prev);
+	_region_map_current.view(region_map_current);
+	_region_map_next.view(region_map_next);
 
 	// Normalize the image
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_BLOCKMATCHING)
@@ -244,13 +244,13 @@ BlockMatching<T>::BlockMatching(const BlockMatching& copy)
 	_cells_height = copy._cells_height;
 	_subpixel_scale = copy._subpixel_scale;
 
-	_image_prev.copy(copy._image_prev);
-	_image_current.copy(copy._image_current);
-	_image_next.copy(copy._image_next);
+	_image_prev.view(copy._image_prev);
+	_image_current.view(copy._image_current);
+	_image_next.view(copy._image_next);
 
-	_region_map_prev.copy(copy._region_map_prev);
-	_region_map_current.copy(copy._region_map_current);
-	_region_map_next.copy(copy._region_map_next);
+	_region_map_prev.view(copy._region_map_prev);
+	_region_map_current.view(copy._region_map_current);
+	_region_map_next.view(copy._region_map_next);
 	_color_quantized_prev.copy(copy._color_quantized_prev);
 	_color_quantized_current.copy(copy._color_quantized_current);
 	_color_quantized_next.copy(copy._color_quantized_next);
@@ -303,8 +303,8 @@ BlockMatching<T>::reset(const ImgVector<T>& image_prev, const ImgVector<T>& imag
 	_cells_height = int(ceil(double(_height) / double(_block_size)));
 	_subpixel_scale = Subpixel_Scale;
 
-	_image_prev.copy(image_prev);
-	_image_current.copy(image_current);
+	_image_prev.view(image_prev);
+	_image_current.view(image_current);
 	_image_next.clear();
 
 	_region_map_prev.clear();
@@ -350,9 +350,9 @@ BlockMatching<T>::reset(const ImgVector<T>& image_prev, const ImgVector<T>& imag
 	_cells_height = int(ceil(double(_height) / double(_block_size)));
 	_subpixel_scale = Subpixel_Scale;
 
-	_image_prev.copy(image_prev);
-	_image_current.copy(image_current);
-	_image_next.copy(image_next);
+	_image_prev.view(image_prev);
+	_image_current.view(image_current);
+	_image_next.view(image_next);
 
 	_region_map_prev.clear();
 	_region_map_current.clear();
@@ -400,12 +400,12 @@ BlockMatching<T>::reset(const ImgVector<T>& image_prev, const ImgVector<size_t>&
 	_cells_height = _height;
 	_subpixel_scale = Subpixel_Scale;
 
-	_image_prev.copy(image_prev);
-	_image_current.copy(image_current);
+	_image_prev.view(image_prev);
+	_image_current.view(image_current);
 	_image_next.clear();
 
-	_region_map_prev.copy(region_map_prev);
-	_region_map_current.copy(region_map_current);
+	_region_map_prev.view(region_map_prev);
+	_region_map_current.view(region_map_current);
 	_region_map_next.clear();
 
 	_motion_vector_time.clear();
@@ -463,13 +463,13 @@ BlockMatching<T>::reset(const ImgVector<T>& image_prev, const ImgVector<size_t>&
 	_cells_height = _height;
 	_subpixel_scale = Subpixel_Scale;
 
-	_image_prev.copy(image_prev);
-	_image_current.copy(image_current);
-	_image_next.copy(image_next);
+	_image_prev.view(image_prev);
+	_image_current.view(image_current);
+	_image_next.view(image_next);
 
-	_region_map_prev.copy(region_map_prev);
-	_region_map_current.copy(region_map_current);
-	_region_map_next.copy(region_map_next);
+	_region_map_prev.view(region_map_prev);
+	_region_map_current.view(region_map_current);
+	_region_map_next.view(region_map_next);
 
 	_motion_vector_time.clear();
 	_motion_vector_prev.clear();
@@ -573,10 +573,18 @@ template <>
 void
 BlockMatching<ImgClass::RGB>::image_normalizer(void);
 
+template <>
+void
+BlockMatching<ImgClass::RGBf>::image_normalizer(void);
+
 template <>
 void
 BlockMatching<ImgClass::Lab>::image_normalizer(void);
 
+template <>
+void
+BlockMatching<ImgClass::Labf>::image_normalizer(void);
+
 
 
 // ----- Decrease Color -----
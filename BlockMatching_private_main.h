@@ -33,8 +33,7 @@ template <class T>
 void
 BlockMatching<T>::block_matching_lattice(const int search_range, const double coeff_MAD, const double coeff_ZNCC)
 {
-	double (BlockMatching<T>::*MAD_func)(const ImgVector<T>&, const ImgVector<T>&, const int, const int, const int, const int) = &BlockMatching<T>::MAD;
-	double (BlockMatching<T>::*NCC_func)(const ImgVector<T>&, const ImgVector<T>&, const int, const int, const int, const int) = &BlockMatching<T>::ZNCC;
+	typedef typename ImgPromote<T>::type promoted_type;
 
 	if (this->isNULL()) {
 		std::cerr << "void BlockMatching<T>::block_matching_lattice(const int) : _block_size < 0" << std::endl;
@@ -50,6 +49,12 @@ BlockMatching<T>::block_matching_lattice(const int search_range, const double co
 	if (_image_next.isNULL() == false) {
 		_motion_vector_next.reset(_cells_width, _cells_height);
 	}
+	// Integral images for ZNCC
+	_integral_prev.reset(_image_prev);
+	_integral_current.reset(_image_current);
+	if (_image_next.isNULL() == false) {
+		_integral_next.reset(_image_next);
+	}
 	// Set reference_images
 	std::vector<ImgVector<T>*> reference_images;
 	std::vector<ImgVector<VECTOR_2D<double> > *> motion_vectors;
@@ -67,81 +72,98 @@ BlockMatching<T>::block_matching_lattice(const int search_range, const double co
 		printf(" Block Matching :   0.0%%\x1b[1A\n");
 #endif
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel
 #endif
-		for (int Y_b = 0; Y_b < _cells_height; Y_b++) {
-			int y_b = Y_b * _block_size;
-			for (int X_b = 0; X_b < _cells_width; X_b++) {
-				int x_b = X_b * _block_size;
-				int x_start, x_end;
-				int y_start, y_end;
-				// Compute start and end coordinates
-				if (search_range < 0) {
-					x_start = 1 - _block_size;
-					x_end = _width - 1;
-					y_start = 1 - _block_size;
-					y_end = _height - 1;
-				} else {
-					x_start = std::max(x_b - (search_range / 2), 1 - _block_size);
-					x_end = std::min(x_b + search_range / 2, _width - 1);
-					y_start = std::max(y_b - (search_range / 2), 1 - _block_size);
-					y_end = std::min(y_b + search_range / 2, _height - 1);
-				}
-				double E_min = DBL_MAX;
-				VECTOR_2D<double> MV(.0, .0);
-				for (int y = y_start; y <= y_end; y++) {
-					for (int x = x_start; x <= x_end; x++) {
-						VECTOR_2D<double> v_tmp(double(x - x_b), double(y - y_b));
-						double MAD = (this->*MAD_func)(
-						    *(reference_images[ref]), _image_current,
-						    x, y, x_b, y_b);
-						double ZNCC = (this->*NCC_func)(
-						    *(reference_images[ref]), _image_current,
-						    x, y, x_b, y_b);
-						double E_tmp = coeff_MAD * MAD + coeff_ZNCC * (1.0 - ZNCC);
-						if (E_tmp < E_min) {
-							E_min = E_tmp;
-							MV = v_tmp;
-						} else if (fabs(E_tmp - E_min) < 1.0E-6
-						    && norm_squared(MV) >= norm_squared(v_tmp)) {
-							E_min = E_tmp;
-							MV = v_tmp;
-						}
+		{
+			// Scratch of the blocks sampled by MAD_cubic()
+			std::vector<promoted_type> block_reference(size_t(_block_size) * size_t(_block_size));
+			std::vector<promoted_type> block_interest(size_t(_block_size) * size_t(_block_size));
+			// The search window of the reference and the block of the current frame copied with zero padding
+			std::vector<T> window;
+			std::vector<T> block(size_t(_block_size) * size_t(_block_size));
+#ifdef _OPENMP
+#pragma omp for
+#endif
+			for (int Y_b = 0; Y_b < _cells_height; Y_b++) {
+				int y_b = Y_b * _block_size;
+				for (int X_b = 0; X_b < _cells_width; X_b++) {
+					int x_b = X_b * _block_size;
+					int x_start, x_end;
+					int y_start, y_end;
+					// Compute start and end coordinates
+					if (search_range < 0) {
+						x_start = 1 - _block_size;
+						x_end = _width - 1;
+						y_start = 1 - _block_size;
+						y_end = _height - 1;
+					} else {
+						x_start = std::max(x_b - (search_range / 2), 1 - _block_size);
+						x_end = std::min(x_b + search_range / 2, _width - 1);
+						y_start = std::max(y_b - (search_range / 2), 1 - _block_size);
+						y_end = std::min(y_b + search_range / 2, _height - 1);
 					}
-				}
-				if (_subpixel_scale > 1) { // Sub-pixel scale search of infimum
-					VECTOR_2D<double> MV_subpel(.0, .0);
-					double MAD_min = DBL_MAX;
-					for (int y = -_subpixel_scale + 1; y < _subpixel_scale; y++) {
-						for (int x = -_subpixel_scale + 1; x < _subpixel_scale; x++) {
-							VECTOR_2D<double> v_tmp(double(x) / double(_subpixel_scale), double(y) / double(_subpixel_scale));
-							double MAD = MAD_cubic(
+					const int window_width = x_end - x_start + _block_size;
+					const int window_height = y_end - y_start + _block_size;
+					window.resize(size_t(window_width) * size_t(window_height));
+					reference_images[ref]->copy_window_zeropad(window.data(), x_start, y_start, window_width, window_height);
+					_image_current.copy_window_zeropad(block.data(), x_b, y_b, _block_size, _block_size);
+					double E_min = DBL_MAX;
+					VECTOR_2D<double> MV(.0, .0);
+					for (int y = y_start; y <= y_end; y++) {
+						for (int x = x_start; x <= x_end; x++) {
+							VECTOR_2D<double> v_tmp(double(x - x_b), double(y - y_b));
+							const T* candidate = window.data() + size_t(window_width) * size_t(y - y_start) + size_t(x - x_start);
+							double MAD = MAD_window(candidate, window_width, block.data());
+							double ZNCC = ZNCC_window(
 							    *(reference_images[ref]), _image_current,
-							    double(x_b) + MV.x + v_tmp.x,
-							    double(y_b) + MV.y + v_tmp.y,
-							    double(x_b),
-							    double(y_b));
-							if (MAD < MAD_min) {
-								MAD_min = MAD;
-								MV_subpel = v_tmp;
-							} else if (fabs(MAD - MAD_min) < 1.0E-6
-							    && norm_squared(MV_subpel) >= norm_squared(v_tmp)) {
-								MAD_min = MAD;
-								MV_subpel = v_tmp;
+							    x, y, x_b, y_b,
+							    candidate, window_width, block.data());
+							double E_tmp = coeff_MAD * MAD + coeff_ZNCC * (1.0 - ZNCC);
+							if (E_tmp < E_min) {
+								E_min = E_tmp;
+								MV = v_tmp;
+							} else if (fabs(E_tmp - E_min) < 1.0E-6
+							    && norm_squared(MV) >= norm_squared(v_tmp)) {
+								E_min = E_tmp;
+								MV = v_tmp;
 							}
 						}
 					}
-					MV += MV_subpel;
+					if (_subpixel_scale > 1) { // Sub-pixel scale search of infimum
+						VECTOR_2D<double> MV_subpel(.0, .0);
+						double MAD_min = DBL_MAX;
+						for (int y = -_subpixel_scale + 1; y < _subpixel_scale; y++) {
+							for (int x = -_subpixel_scale + 1; x < _subpixel_scale; x++) {
+								VECTOR_2D<double> v_tmp(double(x) / double(_subpixel_scale), double(y) / double(_subpixel_scale));
+								double MAD = MAD_cubic(
+								    *(reference_images[ref]), _image_current,
+								    double(x_b) + MV.x + v_tmp.x,
+								    double(y_b) + MV.y + v_tmp.y,
+								    double(x_b),
+								    double(y_b),
+								    block_reference.data(), block_interest.data());
+								if (MAD < MAD_min) {
+									MAD_min = MAD;
+									MV_subpel = v_tmp;
+								} else if (fabs(MAD - MAD_min) < 1.0E-6
+								    && norm_squared(MV_subpel) >= norm_squared(v_tmp)) {
+									MAD_min = MAD;
+									MV_subpel = v_tmp;
+								}
+							}
+						}
+						MV += MV_subpel;
+					}
+					motion_vectors[ref]->at(X_b, Y_b) = MV;
 				}
-				motion_vectors[ref]->at(X_b, Y_b) = MV;
-			}
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_BLOCKMATCHING)
-			double ratio = double(++finished) / _cells_height;
-			if (round(ratio * 1000.0) > progress) {
-				progress = static_cast<unsigned int>(round(ratio * 1000.0)); // Take account of Over-Run
-				printf("\r Block Matching : %5.1f%%\x1b[1A\n", progress * 0.1);
-			}
+				double ratio = double(++finished) / _cells_height;
+				if (round(ratio * 1000.0) > progress) {
+					progress = static_cast<unsigned int>(round(ratio * 1000.0)); // Take account of Over-Run
+					printf("\r Block Matching : %5.1f%%\x1b[1A\n", progress * 0.1);
+				}
 #endif
+			}
 		}
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_BLOCKMATCHING)
 		printf("\n");
@@ -387,30 +409,95 @@ BlockMatching<T>::MAD(const ImgVector<T>& reference, const ImgVector<T>& interes
 	return sad / double(_block_size * _block_size);
 }
 
+/*
+ * The block at candidate in the search window of window_stride pixels per row
+ * is compared with the block copied contiguously, so no boundary check is needed.
+ */
 template <class T>
 double
-BlockMatching<T>::MAD_cubic(const ImgVector<T>& reference, const ImgVector<T>& interest, const double x_ref, const double y_ref, const double x_int, const double y_int)
+BlockMatching<T>::MAD_window(const T* candidate, const int window_stride, const T* block)
 {
 	double sad = 0;
 
 	for (int y = 0; y < _block_size; y++) {
+		const T* row_candidate = candidate + size_t(window_stride) * size_t(y);
+		const T* row_block = block + size_t(_block_size) * size_t(y);
 		for (int x = 0; x < _block_size; x++) {
-			sad += norm(
-			    reference.get_mirror_cubic(x_ref + x, y_ref + y)
-			    - interest.get_mirror_cubic(x_int + x, y_int + y));
+			sad += norm(row_candidate[x] - row_block[x]);
 		}
 	}
 	return sad / double(_block_size * _block_size);
 }
 
+template <class T>
+double
+BlockMatching<T>::MAD_cubic(const ImgVector<T>& reference, const ImgVector<T>& interest, const double x_ref, const double y_ref, const double x_int, const double y_int, typename ImgPromote<T>::type* block_reference, typename ImgPromote<T>::type* block_interest)
+{
+	double sad = 0;
+
+	// The weights are shared by all pixels of the block
+	reference.sample_mirror_cubic(block_reference, x_ref, y_ref, _block_size, _block_size);
+	interest.sample_mirror_cubic(block_interest, x_int, y_int, _block_size, _block_size);
+	for (size_t n = 0; n < size_t(_block_size) * size_t(_block_size); n++) {
+		sad += norm(block_reference[n] - block_interest[n]);
+	}
+	return sad / double(_block_size * _block_size);
+}
+
 
 
 
+template <class T>
+const IntegralImage<T> *
+BlockMatching<T>::integral_image(const ImgVector<T>& image) const
+{
+	const IntegralImage<T>* integral = nullptr;
+	if (&image == &_image_prev) {
+		integral = &_integral_prev;
+	} else if (&image == &_image_current) {
+		integral = &_integral_current;
+	} else if (&image == &_image_next) {
+		integral = &_integral_next;
+	}
+	if (integral != nullptr
+	    && (integral->width() != image.width() || integral->height() != image.height())) {
+		integral = nullptr;
+	}
+	return integral;
+}
+
+
+/*
+ * The sums over the blocks are taken from the integral images if they are built,
+ * so only the cross term is accumulated pixel by pixel.
+ */
 template <class T>
 double
 BlockMatching<T>::ZNCC(const ImgVector<T>& reference, const ImgVector<T>& interest, const int x_ref, const int y_ref, const int x_int, const int y_int)
 {
 	double N = _block_size * _block_size;
+	const IntegralImage<T>* integral_reference = this->integral_image(reference);
+	const IntegralImage<T>* integral_interest = this->integral_image(interest);
+
+	if (integral_reference != nullptr && integral_interest != nullptr) {
+		typename IntegralImage<T>::accumulator_type sum_reference = integral_reference->sum(x_ref, y_ref, _block_size, _block_size);
+		typename IntegralImage<T>::accumulator_type sum_interest = integral_interest->sum(x_int, y_int, _block_size, _block_size);
+		double sum_sq_reference = integral_reference->sum_squared(x_ref, y_ref, _block_size, _block_size);
+		double sum_sq_interest = integral_interest->sum_squared(x_int, y_int, _block_size, _block_size);
+		double sum_sq_reference_interest = 0;
+
+		for (int y = 0; y < _block_size; y++) {
+			for (int x = 0; x < _block_size; x++) {
+				sum_sq_reference_interest += inner_prod(
+				    reference.get_zeropad(x_ref + x, y_ref + y),
+				    interest.get_zeropad(x_int + x, y_int + y));
+			}
+		}
+		return (N * sum_sq_reference_interest - inner_prod(sum_reference, sum_interest))
+		    / (sqrt((N * sum_sq_reference - inner_prod(sum_reference, sum_reference))
+		    * (N * sum_sq_interest - inner_prod(sum_interest, sum_interest)))
+		    + DBL_EPSILON);
+	}
 	T sum_reference = T();
 	T sum_interest = T();
 	double sum_sq_reference = 0;
@@ -439,6 +526,57 @@ BlockMatching<T>::ZNCC(const ImgVector<T>& reference, const ImgVector<T>& intere
 }
 
 
+template <class T>
+double
+BlockMatching<T>::ZNCC_window(const ImgVector<T>& reference, const ImgVector<T>& interest, const int x_ref, const int y_ref, const int x_int, const int y_int, const T* candidate, const int window_stride, const T* block)
+{
+	double N = _block_size * _block_size;
+	const IntegralImage<T>* integral_reference = this->integral_image(reference);
+	const IntegralImage<T>* integral_interest = this->integral_image(interest);
+
+	if (integral_reference != nullptr && integral_interest != nullptr) {
+		typename IntegralImage<T>::accumulator_type sum_reference = integral_reference->sum(x_ref, y_ref, _block_size, _block_size);
+		typename IntegralImage<T>::accumulator_type sum_interest = integral_interest->sum(x_int, y_int, _block_size, _block_size);
+		double sum_sq_reference = integral_reference->sum_squared(x_ref, y_ref, _block_size, _block_size);
+		double sum_sq_interest = integral_interest->sum_squared(x_int, y_int, _block_size, _block_size);
+		double sum_sq_reference_interest = 0;
+
+		for (int y = 0; y < _block_size; y++) {
+			const T* row_candidate = candidate + size_t(window_stride) * size_t(y);
+			const T* row_block = block + size_t(_block_size) * size_t(y);
+			for (int x = 0; x < _block_size; x++) {
+				sum_sq_reference_interest += inner_prod(row_candidate[x], row_block[x]);
+			}
+		}
+		return (N * sum_sq_reference_interest - inner_prod(sum_reference, sum_interest))
+		    / (sqrt((N * sum_sq_reference - inner_prod(sum_reference, sum_reference))
+		    * (N * sum_sq_interest - inner_prod(sum_interest, sum_interest)))
+		    + DBL_EPSILON);
+	}
+	T sum_reference = T();
+	T sum_interest = T();
+	double sum_sq_reference = 0;
+	double sum_sq_interest = 0;
+	double sum_sq_reference_interest = 0;
+
+	for (int y = 0; y < _block_size; y++) {
+		const T* row_candidate = candidate + size_t(window_stride) * size_t(y);
+		const T* row_block = block + size_t(_block_size) * size_t(y);
+		for (int x = 0; x < _block_size; x++) {
+			sum_reference += row_candidate[x];
+			sum_interest += row_block[x];
+			sum_sq_reference += inner_prod(row_candidate[x], row_candidate[x]);
+			sum_sq_interest += inner_prod(row_block[x], row_block[x]);
+			sum_sq_reference_interest += inner_prod(row_candidate[x], row_block[x]);
+		}
+	}
+	return (N * sum_sq_reference_interest - inner_prod(sum_reference, sum_interest))
+	    / (sqrt((N * sum_sq_reference - inner_prod(sum_reference, sum_reference))
+	    * (N * sum_sq_interest - inner_prod(sum_interest, sum_interest)))
+	    + DBL_EPSILON);
+}
+
+
 
 
 template <class T>
@@ -461,14 +599,22 @@ template <class T>
 double
 BlockMatching<T>::MAD_region_cubic(const ImgVector<T>& reference, const ImgVector<T>& interest, const double x_diff, const double y_diff, const std::vector<VECTOR_2D<int> >& region_interest)
 {
+	typedef typename ImgPromote<T>::type promoted_type;
+	std::vector<double> x(region_interest.size());
+	std::vector<double> y(region_interest.size());
+	std::vector<promoted_type> values(region_interest.size());
 	double N = .0;
 	double sad = .0;
 
-	for (const VECTOR_2D<int>& r : region_interest) {
+	for (size_t n = 0; n < region_interest.size(); n++) {
+		x[n] = double(region_interest[n].x) + x_diff;
+		y[n] = double(region_interest[n].y) + y_diff;
+	}
+	reference.sample_mirror_cubic(values.data(), x.data(), y.data(), region_interest.size());
+	for (size_t n = 0; n < region_interest.size(); n++) {
+		const VECTOR_2D<int>& r = region_interest[n];
 		N += 1.0;
-		sad += norm(
-		    interest.get_zeropad(r.x, r.y)
-		    - reference.get_mirror_cubic(double(r.x) + x_diff, double(r.y) + y_diff));
+		sad += norm(interest.get_zeropad(r.x, r.y) - values[n]);
 	}
 	return sad / N;
 }
@@ -4,9 +4,15 @@
 #include <ostream>
 
 namespace ImgClass {
-	class RGB;
+	template <class S> class basic_RGB;
 	class HSV;
-	class Lab;
+	template <class S> class basic_Lab;
+
+	// Color types of the scalar S
+	typedef basic_RGB<double> RGB;
+	typedef basic_RGB<float> RGBf;
+	typedef basic_Lab<double> Lab;
+	typedef basic_Lab<float> Labf;
 
 	extern const double X_n;
 	extern const double Y_n;
@@ -16,77 +22,98 @@ namespace ImgClass {
 
 
 namespace ImgClass {
-	class RGB
+	template <class S>
+	class basic_RGB
 	{
 		public:
 
-		double R;
-		double G;
-		double B;
+		typedef S value_type;
+
+		S R;
+		S G;
+		S B;
 
 		// Constructor
-		RGB(void);
-		RGB(const double& red, const double& green, const double& blue);
-		RGB(const RGB& rgb); // Copy constructor
-		RGB(const HSV& hsv); // Conversion
-		RGB(const Lab& lab); // Conversion
+		basic_RGB(void);
+		basic_RGB(const double& red, const double& green, const double& blue);
+		basic_RGB(const basic_RGB<S>& rgb); // Copy constructor
+		template <class S2> explicit basic_RGB(const basic_RGB<S2>& rgb); // Conversion of the scalar
+		basic_RGB(const HSV& hsv); // Conversion
+		basic_RGB(const basic_Lab<S>& lab); // Conversion
 
-		RGB& set(const double& red, const double& green, const double& blue);
-		RGB& gamma(const double& gamma_val);
+		basic_RGB<S>& set(const double& red, const double& green, const double& blue);
+		basic_RGB<S>& gamma(const double& gamma_val);
 
 		// Operators
 		explicit operator double() const; // return intensity
 
-		RGB& operator=(const RGB& rvalue);
-		RGB& operator=(const double& rvalue);
+		basic_RGB<S>& operator=(const basic_RGB<S>& rvalue);
+		basic_RGB<S>& operator=(const double& rvalue);
 
-		RGB& operator+=(const RGB& rcolor);
-		RGB& operator+=(const double& rvalue);
+		basic_RGB<S>& operator+=(const basic_RGB<S>& rcolor);
+		basic_RGB<S>& operator+=(const double& rvalue);
 
-		RGB& operator-=(const RGB& rcolor);
-		RGB& operator-=(const double& rvalue);
+		basic_RGB<S>& operator-=(const basic_RGB<S>& rcolor);
+		basic_RGB<S>& operator-=(const double& rvalue);
 
-		RGB& operator*=(const RGB& rcolor);
-		RGB& operator*=(const double& rvalue);
+		basic_RGB<S>& operator*=(const basic_RGB<S>& rcolor);
+		basic_RGB<S>& operator*=(const double& rvalue);
 
-		RGB& operator/=(const RGB& rcolor);
-		RGB& operator/=(const double& rvalue);
+		basic_RGB<S>& operator/=(const basic_RGB<S>& rcolor);
+		basic_RGB<S>& operator/=(const double& rvalue);
 	};
 }
 
 
-const ImgClass::RGB operator+(ImgClass::RGB rcolor);
-const ImgClass::RGB operator-(ImgClass::RGB rcolor);
+template <class S>
+const ImgClass::basic_RGB<S> operator+(ImgClass::basic_RGB<S> rcolor);
+template <class S>
+const ImgClass::basic_RGB<S> operator-(ImgClass::basic_RGB<S> rcolor);
 
-const ImgClass::RGB operator+(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor);
-const ImgClass::RGB operator-(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor);
+template <class S>
+const ImgClass::basic_RGB<S> operator+(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor);
+template <class S>
+const ImgClass::basic_RGB<S> operator-(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor);
 
-const ImgClass::RGB operator*(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor);
-const ImgClass::RGB operator*(const ImgClass::RGB& lcolor, const double& rvalue);
-const ImgClass::RGB operator*(const double& lvalue, const ImgClass::RGB& rcolor);
+template <class S>
+const ImgClass::basic_RGB<S> operator*(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor);
+template <class S>
+const ImgClass::basic_RGB<S> operator*(const ImgClass::basic_RGB<S>& lcolor, const double& rvalue);
+template <class S>
+const ImgClass::basic_RGB<S> operator*(const double& lvalue, const ImgClass::basic_RGB<S>& rcolor);
 
-const ImgClass::RGB operator/(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor);
-const ImgClass::RGB operator/(const ImgClass::RGB& lcolor, const double& rvalue);
+template <class S>
+const ImgClass::basic_RGB<S> operator/(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor);
+template <class S>
+const ImgClass::basic_RGB<S> operator/(const ImgClass::basic_RGB<S>& lcolor, const double& rvalue);
 
 // Comparator
-bool operator==(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor);
-bool operator!=(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor);
+template <class S>
+bool operator==(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor);
+template <class S>
+bool operator!=(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor);
 
 // Product
-double inner_prod(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor);
+template <class S>
+double inner_prod(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor);
 
 // Norm
-double norm_squared(const ImgClass::RGB& color);
-double norm(const ImgClass::RGB& color);
+template <class S>
+double norm_squared(const ImgClass::basic_RGB<S>& color);
+template <class S>
+double norm(const ImgClass::basic_RGB<S>& color);
 
 // Saturation
-ImgClass::RGB saturate(const ImgClass::RGB& value, const double& min, const double& max);
+template <class S>
+ImgClass::basic_RGB<S> saturate(const ImgClass::basic_RGB<S>& value, const double& min, const double& max);
 
 // Quantization
-ImgClass::RGB color_quantize(const ImgClass::RGB &value, const double &max = 255.0);
+template <class S>
+ImgClass::basic_RGB<S> color_quantize(const ImgClass::basic_RGB<S> &value, const double &max = 255.0);
 
 // Stream
-std::ostream& operator<<(std::ostream& os, const ImgClass::RGB& rcolor);
+template <class S>
+std::ostream& operator<<(std::ostream& os, const ImgClass::basic_RGB<S>& rcolor);
 
 
 
@@ -138,73 +165,95 @@ std::ostream& operator<<(std::ostream& os, const ImgClass::HSV& rval);
 /******** L*a*b* color space ********/
 // constructor will map RGB to L*a*b* color space
 namespace ImgClass {
-	class Lab
+	template <class S>
+	class basic_Lab
 	{
 		public:
 
-		double L;
-		double a;
-		double b;
+		typedef S value_type;
+
+		S L;
+		S a;
+		S b;
 
 		// Constructor
-		Lab(void);
-		Lab(const double& _L, const double& _a, const double& _b);
-		Lab(const Lab& color); // Copy constructor
-		Lab(const RGB& color);
+		basic_Lab(void);
+		basic_Lab(const double& _L, const double& _a, const double& _b);
+		basic_Lab(const basic_Lab<S>& color); // Copy constructor
+		template <class S2> explicit basic_Lab(const basic_Lab<S2>& color); // Conversion of the scalar
+		basic_Lab(const basic_RGB<S>& color);
 
-		Lab& set(const RGB& color);
+		basic_Lab<S>& set(const basic_RGB<S>& color);
 		// Operators
 		explicit operator double() const;
 
-		Lab& operator=(const Lab& value);
-		Lab& operator=(const double& value);
+		basic_Lab<S>& operator=(const basic_Lab<S>& value);
+		basic_Lab<S>& operator=(const double& value);
 
-		Lab& operator+=(const Lab& color);
-		Lab& operator+=(const double& value);
+		basic_Lab<S>& operator+=(const basic_Lab<S>& color);
+		basic_Lab<S>& operator+=(const double& value);
 
-		Lab& operator-=(const Lab& color);
-		Lab& operator-=(const double& value);
+		basic_Lab<S>& operator-=(const basic_Lab<S>& color);
+		basic_Lab<S>& operator-=(const double& value);
 
-		Lab& operator*=(const Lab& color);
-		Lab& operator*=(const double& value);
+		basic_Lab<S>& operator*=(const basic_Lab<S>& color);
+		basic_Lab<S>& operator*=(const double& value);
 
-		Lab& operator/=(const Lab& color);
-		Lab& operator/=(const double& value);
+		basic_Lab<S>& operator/=(const basic_Lab<S>& color);
+		basic_Lab<S>& operator/=(const double& value);
 	};
 }
 
 
 // Global Operators
 // Arithmetic
-const ImgClass::Lab operator+(ImgClass::Lab color);
-const ImgClass::Lab operator-(ImgClass::Lab color);
+template <class S>
+const ImgClass::basic_Lab<S> operator+(ImgClass::basic_Lab<S> color);
+template <class S>
+const ImgClass::basic_Lab<S> operator-(ImgClass::basic_Lab<S> color);
 
 // Comparator
-bool operator==(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor);
-bool operator!=(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor);
+template <class S>
+bool operator==(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor);
+template <class S>
+bool operator!=(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor);
 
-bool operator<(const ImgClass::Lab& lcolor, const double& rvalue);
-bool operator<(const double& lvalue, const ImgClass::Lab& rcolor);
+template <class S>
+bool operator<(const ImgClass::basic_Lab<S>& lcolor, const double& rvalue);
+template <class S>
+bool operator<(const double& lvalue, const ImgClass::basic_Lab<S>& rcolor);
 
-bool operator>(const ImgClass::Lab& lcolor, const double& rvalue);
-bool operator>(const double& lvalue, const ImgClass::Lab& rcolor);
+template <class S>
+bool operator>(const ImgClass::basic_Lab<S>& lcolor, const double& rvalue);
+template <class S>
+bool operator>(const double& lvalue, const ImgClass::basic_Lab<S>& rcolor);
 
 // Arithmetic non-substituting operator
-ImgClass::Lab operator+(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor);
+template <class S>
+ImgClass::basic_Lab<S> operator+(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor);
 
-ImgClass::Lab operator-(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor);
+template <class S>
+ImgClass::basic_Lab<S> operator-(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor);
 
-ImgClass::Lab operator*(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor);
-ImgClass::Lab operator*(const ImgClass::Lab& lcolor, const double& rvalue);
-ImgClass::Lab operator*(const double& lvalue, const ImgClass::Lab& rcolor);
+template <class S>
+ImgClass::basic_Lab<S> operator*(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor);
+template <class S>
+ImgClass::basic_Lab<S> operator*(const ImgClass::basic_Lab<S>& lcolor, const double& rvalue);
+template <class S>
+ImgClass::basic_Lab<S> operator*(const double& lvalue, const ImgClass::basic_Lab<S>& rcolor);
 
-ImgClass::Lab operator/(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor);
-ImgClass::Lab operator/(const ImgClass::Lab& lcolor, const double& rvalue);
+template <class S>
+ImgClass::basic_Lab<S> operator/(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor);
+template <class S>
+ImgClass::basic_Lab<S> operator/(const ImgClass::basic_Lab<S>& lcolor, const double& rvalue);
 
 // Norm
-const ImgClass::Lab abs(const ImgClass::Lab& color);
-double norm_squared(const ImgClass::Lab& color);
-double norm(const ImgClass::Lab& color);
+template <class S>
+const ImgClass::basic_Lab<S> abs(const ImgClass::basic_Lab<S>& color);
+template <class S>
+double norm_squared(const ImgClass::basic_Lab<S>& color);
+template <class S>
+double norm(const ImgClass::basic_Lab<S>& color);
 #ifndef NORM_DOUBLE
 #define NORM_DOUBLE
 double norm(const double& value);
@@ -212,20 +261,24 @@ double norm_squared(const double& value);
 #endif
 
 // Product
-double inner_prod(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor);
+template <class S>
+double inner_prod(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor);
 #ifndef INNER_PROD_DOUBLE
 #define INNER_PROD_DOUBLE
 double inner_prod(const double& lvalue, const double& rvalue);
 #endif
 
 // Saturation
-ImgClass::Lab saturate(const ImgClass::Lab& value, const double& min, const double& max);
+template <class S>
+ImgClass::basic_Lab<S> saturate(const ImgClass::basic_Lab<S>& value, const double& min, const double& max);
 
 // Quantization
-ImgClass::Lab color_quantize(const ImgClass::Lab& value);
+template <class S>
+ImgClass::basic_Lab<S> color_quantize(const ImgClass::basic_Lab<S>& value);
 
 // Stream
-std::ostream& operator<<(std::ostream& os, const ImgClass::Lab& rcolor);
+template <class S>
+std::ostream& operator<<(std::ostream& os, const ImgClass::basic_Lab<S>& rcolor);
 
 #endif
 
@@ -29,6 +29,9 @@ CrossCorrelation::CrossCorrelation(const ImgStatistics& img0, const ImgStatistic
 		_img1.copy(img1);
 		_width = img0.width();
 		_height = img0.height();
+		// The windowed statistics of NCC() are computed by the integral images
+		_img0.integrate();
+		_img1.integrate();
 	}
 }
 
@@ -0,0 +1,68 @@
+#ifndef LIB_ImgClass_ImgAllocator
+#define LIB_ImgClass_ImgAllocator
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/* Allocation policy of ImgVector
+ *
+ * ImgAllocator returns the memory aligned to ImgAllocator::Alignment bytes
+ * (the size of the cache line and AVX-512 register).
+ * The derived class overrides allocate() and deallocate() to change the policy.
+ * ImgVector constructs and destructs the pixels on the memory, so the allocator handles only raw bytes.
+ */
+class ImgAllocator
+{
+	public:
+		static const size_t Alignment = 64;
+
+		virtual ~ImgAllocator(void);
+
+		virtual void* allocate(const size_t bytes); // throw std::bad_alloc on failure
+		virtual void deallocate(void* memory, const size_t bytes);
+
+		static ImgAllocator* default_allocator(void);
+
+	protected:
+		static void* aligned_allocate(const size_t bytes);
+		static void aligned_deallocate(void* memory);
+};
+
+
+/* Frame pool allocator
+ *
+ * The released buffers are kept and recycled for the allocation of the same size,
+ * so the images allocated frame by frame (e.g. ImgVector in the loop of video frames)
+ * reuse the memory without malloc() and page faults.
+ * At most max_buffers buffers are kept for each size.
+ * The pool is thread-safe and it should outlive the images which use it.
+ */
+class ImgFramePool : public ImgAllocator
+{
+	private:
+		size_t _max_buffers;
+		size_t _cached_bytes;
+		std::map<size_t, std::vector<void*> > _buffers; // Released buffers for each size
+		std::mutex _mutex;
+
+	public:
+		explicit ImgFramePool(const size_t max_buffers = 4);
+		ImgFramePool(const ImgFramePool& copy) = delete;
+		ImgFramePool& operator=(const ImgFramePool& copy) = delete;
+
+		virtual ~ImgFramePool(void);
+
+		virtual void* allocate(const size_t bytes);
+		virtual void deallocate(void* memory, const size_t bytes);
+
+		void release(void); // Free all cached buffers
+		size_t cached_buffers(void);
+		size_t cached_bytes(void);
+};
+
+#include "ImgAllocator_private.h"
+
+#endif
+
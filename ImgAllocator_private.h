@@ -0,0 +1,146 @@
+#include <cstdint>
+#include <new>
+
+
+
+
+// ----- ImgAllocator -----
+inline
+ImgAllocator::~ImgAllocator(void)
+{
+}
+
+
+inline void *
+ImgAllocator::allocate(const size_t bytes)
+{
+	return ImgAllocator::aligned_allocate(bytes);
+}
+
+inline void
+ImgAllocator::deallocate(void* memory, const size_t)
+{
+	ImgAllocator::aligned_deallocate(memory);
+}
+
+
+inline ImgAllocator *
+ImgAllocator::default_allocator(void)
+{
+	static ImgAllocator allocator;
+	return &allocator;
+}
+
+
+/*
+ * Allocate the memory with the padding for the alignment.
+ * The address returned by ::operator new is stored just before the aligned address.
+ */
+inline void *
+ImgAllocator::aligned_allocate(const size_t bytes)
+{
+	void* raw = ::operator new(bytes + Alignment + sizeof(void*));
+	uintptr_t address = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+	address += (Alignment - address % Alignment) % Alignment;
+	reinterpret_cast<void**>(address)[-1] = raw;
+	return reinterpret_cast<void*>(address);
+}
+
+inline void
+ImgAllocator::aligned_deallocate(void* memory)
+{
+	if (memory != nullptr) {
+		::operator delete(reinterpret_cast<void**>(memory)[-1]);
+	}
+}
+
+
+
+
+// ----- ImgFramePool -----
+inline
+ImgFramePool::ImgFramePool(const size_t max_buffers)
+{
+	_max_buffers = max_buffers;
+	_cached_bytes = 0;
+}
+
+
+inline
+ImgFramePool::~ImgFramePool(void)
+{
+	this->release();
+}
+
+
+inline void *
+ImgFramePool::allocate(const size_t bytes)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::map<size_t, std::vector<void*> >::iterator ite = _buffers.find(bytes);
+		if (ite != _buffers.end() && ite->second.size() > 0) {
+			void* memory = ite->second.back();
+			ite->second.pop_back();
+			_cached_bytes -= bytes;
+			return memory;
+		}
+	}
+	return ImgAllocator::aligned_allocate(bytes);
+}
+
+inline void
+ImgFramePool::deallocate(void* memory, const size_t bytes)
+{
+	if (memory == nullptr) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::vector<void*>& buffers = _buffers[bytes];
+		if (buffers.size() < _max_buffers) {
+			buffers.push_back(memory);
+			_cached_bytes += bytes;
+			return;
+		}
+	}
+	ImgAllocator::aligned_deallocate(memory);
+}
+
+
+inline void
+ImgFramePool::release(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (std::map<size_t, std::vector<void*> >::iterator ite = _buffers.begin();
+	    ite != _buffers.end();
+	    ++ite) {
+		for (void* memory : ite->second) {
+			ImgAllocator::aligned_deallocate(memory);
+		}
+	}
+	_buffers.clear();
+	_cached_bytes = 0;
+}
+
+
+inline size_t
+ImgFramePool::cached_buffers(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	size_t count = 0;
+	for (std::map<size_t, std::vector<void*> >::const_iterator ite = _buffers.begin();
+	    ite != _buffers.end();
+	    ++ite) {
+		count += ite->second.size();
+	}
+	return count;
+}
+
+inline size_t
+ImgFramePool::cached_bytes(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _cached_bytes;
+}
+
@@ -1,35 +1,270 @@
 #ifndef LIB_ImgClass
 #define LIB_ImgClass
 
+#include <atomic>
 #include <cfloat>
 #include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
 
 #include <cxxabi.h>
 
+#include "ImgAllocator.h"
+#include "ImgExpression.h"
+#include "ImgKernel.h"
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 /* Macro for compatibility where the C++11 not supported
 #ifndef nullptr
 #define nullptr 0
 #endif
 */
 
+namespace ImgClass {
+	template <class S> class basic_RGB;
+	template <class S> class basic_Lab;
+	class half;
+}
+
+template <class T> class IntegralImage; // IntegralImage.h
+
+/* Scalar type of the pixel
+ *
+ * The weights of the interpolation are computed in ImgScalar<T>::type,
+ * so the single precision images (float, ImgClass::RGBf, ImgClass::Labf) are interpolated in float.
+ */
+template <class T>
+struct ImgScalar
+{
+	typedef double type;
+};
+
+template <>
+struct ImgScalar<float>
+{
+	typedef float type;
+};
+
+template <class S>
+struct ImgScalar<ImgClass::basic_RGB<S> >
+{
+	typedef S type;
+};
+
+template <class S>
+struct ImgScalar<ImgClass::basic_Lab<S> >
+{
+	typedef S type;
+};
+
+template <>
+struct ImgScalar<uint8_t>
+{
+	typedef float type;
+};
+
+template <>
+struct ImgScalar<uint16_t>
+{
+	typedef float type;
+};
+
+template <>
+struct ImgScalar<ImgClass::half>
+{
+	typedef float type;
+};
+
+
+/* Promoted type of the pixel
+ *
+ * The compact pixels (uint8_t, uint16_t and ImgClass::half) are stored in 1 or 2 bytes
+ * and they are promoted to float to be interpolated (get_*_cubic(), resample_bicubic()).
+ * demote() converts the promoted value to the storage type with rounding and saturation.
+ * The other pixels are not promoted.
+ */
+template <class T>
+struct ImgPromote
+{
+	typedef T type;
+	static const T& demote(const T& value);
+};
+
+template <>
+struct ImgPromote<uint8_t>
+{
+	typedef float type;
+	static uint8_t demote(const float value);
+};
+
+template <>
+struct ImgPromote<uint16_t>
+{
+	typedef float type;
+	static uint16_t demote(const float value);
+};
+
+template <>
+struct ImgPromote<ImgClass::half>
+{
+	typedef float type;
+	static ImgClass::half demote(const float value); // Defined in ImgHalf.h
+};
+
+
+/* Conversion of the pixels of RT to T (used by ImgVector<T>::cast_copy())
+ *
+ * The pixels are converted through ImgPromote<T>::type, so the compact pixels are rounded and saturated.
+ * The pairs which have the bulk converter (e.g. ImgClass::half and float) are specialized.
+ */
+template <class T, class RT>
+struct ImgConvert
+{
+	static void convert(const RT* src, T* dst, const size_t n);
+};
+
+
+/* Parallel loop over the pixels
+ *
+ * The range [0, n) is divided into the chunks of grain_size() pixels
+ * and func(begin, end) is called for each chunk in parallel.
+ * The range smaller than grain_size() is processed serially to avoid the overhead of the threads.
+ */
+class ImgParallel
+{
+	public:
+		static size_t grain_size(void);
+		static void set_grain_size(const size_t grain);
+		static size_t chunks(const size_t n, const size_t grain);
+		template <class F> static void for_each(const size_t n, F func);
+		template <class F> static void for_each(const size_t n, const size_t grain, F func); // Chunk c is [c * grain, min((c + 1) * grain, n))
+
+	private:
+		static std::atomic<size_t>& grain(void);
+};
+
+
+/* Accumulator type of the sum of the pixels
+ *
+ * The sums are accumulated in double (ImgClass::basic_RGB<double> and ImgClass::basic_Lab<double> for the colors)
+ * even if the pixels are float or integer.
+ */
+template <class T>
+struct ImgAccumulator
+{
+	typedef double type;
+};
+
+template <class S>
+struct ImgAccumulator<ImgClass::basic_RGB<S> >
+{
+	typedef ImgClass::basic_RGB<double> type;
+};
+
+template <class S>
+struct ImgAccumulator<ImgClass::basic_Lab<S> >
+{
+	typedef ImgClass::basic_Lab<double> type;
+};
+
+
+/* Whether the pixels are ordered by operator<
+ *
+ * The colors (ImgClass::RGB, ImgClass::Lab) are not ordered.
+ */
+template <class T>
+struct ImgComparable
+{
+	template <class U> static auto test(int) -> decltype(std::declval<const U&>() < std::declval<const U&>(), std::true_type());
+	template <class U> static std::false_type test(...);
+	static const bool value = decltype(test<T>(0))::value;
+};
+
+
+/* Fused reduction of the pixels
+ *
+ * min, max, sum, sum of squares and count are accumulated in a single pass.
+ * The sums are compensated by Kahan summation and the partial reductions are merged by merge().
+ * The variance is accumulated by Welford's update (Chan's update in merge()) as the mean and the sum of the squared deviations,
+ * so it does not cancel catastrophically on the pixels of the large offset.
+ * min and max are kept only if the pixels are ImgComparable (use ImgVector<T>::reduce_norm() for the colors).
+ */
+template <class T>
+class ImgReduction
+{
+	public:
+		typedef typename ImgAccumulator<T>::type accumulator_type;
+
+	private:
+		T _min;
+		T _max;
+		accumulator_type _sum;
+		accumulator_type _sum_compensation;
+		accumulator_type _sum_squared;
+		accumulator_type _sum_squared_compensation;
+		accumulator_type _mean;
+		accumulator_type _squared_deviation; // Sum of the squared deviations from _mean
+		size_t _count;
+
+		void order(const T& value, std::true_type);
+		void order(const T& value, std::false_type);
+
+	public:
+		ImgReduction(void);
+
+		void add(const T& value);
+		void merge(const ImgReduction<T>& reduction);
+
+		const T& min(void) const;
+		const T& max(void) const;
+		const accumulator_type& sum(void) const;
+		const accumulator_type& sum_squared(void) const;
+		size_t count(void) const;
+		accumulator_type mean(void) const;
+		accumulator_type variance(void) const;
+};
+
+
+/* Image of the pixels T
+ *
+ * The owned memory is shared by the copies (copy constructor, copy() and operator=) with the reference count
+ * and it is duplicated when a copy is modified (copy-on-write), so the copy is O(1) until the first write.
+ * The non-const accessors (operator[], at(), set_*(), data()) unshare the memory before returning.
+ * The external memory (attach(), e.g. ImgMapped) is copied by the copies except view(), which refers it read-only.
+ * The references and pointers returned by them should not be kept across a copy of *this.
+ * The duplication is locked, so the threads can write the different pixels of a copied image as the unshared one.
+ */
 template <class T>
 class ImgVector
 {
 	private:
 		T *_data;
 		size_t _reserved_size;
+		bool _external; // _data is not owned by *this
+		mutable std::atomic<bool> _shared; // _data may be shared (the reference count is checked only if it is true, the external _data is read-only if it is true)
+		ImgAllocator *_allocator; // Allocation policy of _data
 		int _width;
 		int _height;
 
 	public:
 		ImgVector(void);
+		explicit ImgVector(ImgAllocator* allocator);
 		ImgVector(const int Width, const int Height, const T& value = T());
 		ImgVector(const int Width, const int Height, const T* array);
 		ImgVector(const ImgVector<T>& copy); // Copy constructor
+		template<class E> ImgVector(const ImgExpression<E>& expression); // Evaluate the expression
 
 		virtual ~ImgVector(void);
 
+		ImgVector<T>& attach(const int Width, const int Height, T* array); // Refer the external array without ownership
+		ImgVector<T>& view(const ImgVector<T>& vector); // Refer the pixels of vector without copying until the first write
+		ImgVector<T>& set_allocator(ImgAllocator* allocator); // nullptr : ImgAllocator::default_allocator()
 		void clear(void);
 		void reserve(const int Width, const int Height);
 		void reset(const int Width, const int Height, const T& value = T()); // Delete current data and resize the array
@@ -39,16 +274,22 @@ class ImgVector
 		ImgVector<T>& copy(const ImgVector<T>& vector); // Assign vector to *this
 		ImgVector<T>& operator=(const ImgVector<T>& vector); // Assign vector to *this
 		template<class RT> ImgVector<T>& cast_copy(const ImgVector<RT>& vector);
+		template<class E> ImgVector<T>& operator=(const ImgExpression<E>& expression); // Evaluate the expression in a single pass
 
 		// Get Properties
 		size_t reserved_size(void) const;
 		int width(void) const;
 		int height(void) const;
 		size_t size(void) const;
+		bool isExternal(void) const;
+		bool isShared(void) const; // The memory is shared with the other copies
 		bool isNULL(void) const;
+		ImgAllocator* allocator(void) const;
 
 		// Data access
-		T* data(void) const;
+		void unshare(void); // Duplicate the shared memory to write the pixels
+		T* data(void);
+		const T* data(void) const;
 		// Reference to the pixel
 		T& operator[](const size_t n);
 		T& at(const size_t n);
@@ -74,10 +315,32 @@ class ImgVector
 		const T get_valpad(const int x, const int y, const T& value = T()) const;
 		const T get_repeat(const int x, const int y) const;
 		const T get_mirror(const int x, const int y) const;
-		// Get intensity interpolated by bicubic
-		const T get_zeropad_cubic(const double& x, const double& y, const double& B = 0.0, const double& C = (1.0 / 2.0)) const;
-		const T get_repeat_cubic(const double& x, const double& y, const double& B = 0.0, const double& C = (1.0 / 2.0)) const;
-		const T get_mirror_cubic(const double& x, const double& y, const double& B = 0.0, const double& C = (1.0 / 2.0)) const;
+		// Get intensity interpolated by bicubic (the compact pixels are promoted to ImgPromote<T>::type)
+		const typename ImgPromote<T>::type get_zeropad_cubic(const double& x, const double& y, const double& B = 0.0, const double& C = (1.0 / 2.0)) const;
+		const typename ImgPromote<T>::type get_repeat_cubic(const double& x, const double& y, const double& B = 0.0, const double& C = (1.0 / 2.0)) const;
+		const typename ImgPromote<T>::type get_mirror_cubic(const double& x, const double& y, const double& B = 0.0, const double& C = (1.0 / 2.0)) const;
+		// Get intensity interpolated by the kernel (ImgKernel::bilinear(), bicubic(B, C) or lanczos(N))
+		const typename ImgPromote<T>::type get_zeropad_interpolated(const double& x, const double& y, const ImgKernel& kernel) const;
+		const typename ImgPromote<T>::type get_repeat_interpolated(const double& x, const double& y, const ImgKernel& kernel) const;
+		const typename ImgPromote<T>::type get_mirror_interpolated(const double& x, const double& y, const ImgKernel& kernel) const;
+		// Sample the points (x[i], y[i]) by the kernel into values[i]
+		void sample_zeropad(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel) const;
+		void sample_repeat(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel) const;
+		void sample_mirror(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel) const;
+		// Sample the window (x + i, y + j) of window_width x window_height by the kernel into values in row-major order
+		void sample_zeropad(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel) const;
+		void sample_repeat(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel) const;
+		void sample_mirror(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel) const;
+		// Sample the points (x[i], y[i]) by bicubic into values[i] (the same values as get_*_cubic())
+		void sample_zeropad_cubic(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const double B = 0.0, const double C = (1.0 / 2.0)) const;
+		void sample_repeat_cubic(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const double B = 0.0, const double C = (1.0 / 2.0)) const;
+		void sample_mirror_cubic(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const double B = 0.0, const double C = (1.0 / 2.0)) const;
+		// Sample the window (x + i, y + j) of window_width x window_height by bicubic into values in row-major order
+		void sample_zeropad_cubic(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const double B = 0.0, const double C = (1.0 / 2.0)) const;
+		void sample_repeat_cubic(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const double B = 0.0, const double C = (1.0 / 2.0)) const;
+		void sample_mirror_cubic(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const double B = 0.0, const double C = (1.0 / 2.0)) const;
+		// Copy the window (x + i, y + j) of window_width x window_height into values in row-major order (zero outside of the image)
+		void copy_window_zeropad(T* values, const int x, const int y, const int window_width, const int window_height) const;
 
 		// Get statistical value
 		const T min(void) const;
@@ -86,6 +349,12 @@ class ImgVector
 		const T max(const int top_left_x, const int top_left_y, const int crop_width, const int crop_height) const;
 		const T variance(void) const;
 		const T variance(const int top_left_x, const int top_left_y, const int crop_width, const int crop_height) const;
+		const T variance(const int top_left_x, const int top_left_y, const int crop_width, const int crop_height, const IntegralImage<T>& integral) const; // O(1) by the summed-area table of *this
+		// Fused reduction (min, max, sum, sum of squares and count) in a single pass
+		ImgReduction<T> reduce(void) const;
+		ImgReduction<T> reduce(const int top_left_x, const int top_left_y, const int crop_width, const int crop_height) const;
+		template<class F> ImgReduction<typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type> reduce(F func) const; // Reduction of func(pixel)
+		ImgReduction<double> reduce_norm(void) const; // Reduction of norm(pixel) for the colors
 
 		// Cropping (Change the data of *this)
 		ImgVector<T>* crop(const int top_left_x, const int top_left_y, const int crop_width, const int crop_height) const;
@@ -93,11 +362,14 @@ class ImgVector
 		// Simple image processing (Change the data of *this)
 		void contrast_stretching(const T& Min, const T& Max);
 		template<class RT> void saturate(T (*)(const T&, const RT&, const RT&), const RT& min, const RT& max);
+		template<class F, class RT, class = typename std::enable_if<!std::is_same<F, std::nullptr_t>::value>::type> void saturate(F func, const RT& min, const RT& max); // func(value, min, max)
 		void map(T (*func)(T &value));
+		template<class F, class = typename std::enable_if<!std::is_same<F, std::nullptr_t>::value>::type> void map(F func); // func(value)
 
 		// Resampling (Change the data of *this)
 		void resample_zerohold(const int Width, const int Height);
 		void resample_bicubic(const int Width, const int Height, T (*Nearest_Integer_Method)(T& intensity) = nullptr, T (*Saturater)(T& intensity) = nullptr, const double B = (0.0 / 3.0), const double C = (1.0 / 2.0));
+		void resample(const int Width, const int Height, const ImgKernel& kernel, T (*Nearest_Integer_Method)(T& intensity) = nullptr, T (*Saturater)(T& intensity) = nullptr);
 
 		// Operators
 		template<class RT> ImgVector<T>& operator+=(const RT& rvalue);
@@ -111,7 +383,23 @@ class ImgVector
 		template<class RT> ImgVector<T>& operator/=(const ImgVector<RT>& rvector);
 
 	protected:
+		T* allocate(const size_t n) const; // Allocate and construct n pixels by _allocator
+		void deallocate(void);
+		void release(void); // Release the reference to _data without resetting *this
+		void share(const ImgVector<T>& vector);
+		void duplicate(void); // Slow path of unshare()
+		static std::mutex& duplicate_lock(const ImgVector<T>* vector); // Lock of duplicate() striped by the address
+		static std::atomic<size_t>* references(T* data); // Reference count of the memory allocated by allocate()
+		template<class E, class F> void evaluate(const E& expression, F func);
+		void minmax(T* min, T* max) const;
 		double cubic(const double x, const double B, const double C) const;
+		void kernel_weights(typename ImgScalar<T>::type* weight, const double fraction, const ImgKernel& kernel) const; // 2 * radius taps at the offsets 1 - radius, ..., radius from floor
+		template<int R, class F> typename ImgPromote<T>::type kernel_gather(const int x, const int y, const typename ImgScalar<T>::type* weight_x, const typename ImgScalar<T>::type* weight_y, F boundary) const;
+		template<class F> void sample_kernel(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel, F boundary) const;
+		template<class F> void sample_kernel(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel, F boundary) const;
+		template<int R, class F> void sample_radius(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel, F boundary) const;
+		template<int R, class F> void sample_radius(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel, F boundary) const;
+		void kernel_taps(int* index, typename ImgScalar<T>::type* weight, const int L, const int src_length, const int dst_length, const ImgKernel& kernel) const;
 };
 
 template<class T> T saturate(const T& value, const T& min, const T& max);
@@ -1,8 +1,261 @@
+#include <algorithm>
 #include <cassert>
+#include <climits>
 #include <cmath>
 #include <iostream>
 #include <new>
 #include <stdexcept>
+#include <vector>
+
+
+
+
+// ----- ImgParallel -----
+inline std::atomic<size_t> &
+ImgParallel::grain(void)
+{
+	static std::atomic<size_t> grain(16384);
+	return grain;
+}
+
+inline size_t
+ImgParallel::grain_size(void)
+{
+	return ImgParallel::grain().load(std::memory_order_relaxed);
+}
+
+inline void
+ImgParallel::set_grain_size(const size_t grain)
+{
+	ImgParallel::grain().store(grain > 0 ? grain : 1, std::memory_order_relaxed);
+}
+
+
+inline size_t
+ImgParallel::chunks(const size_t n, const size_t grain)
+{
+	return (n + grain - 1) / grain;
+}
+
+
+template <class F>
+void
+ImgParallel::for_each(const size_t n, F func)
+{
+	ImgParallel::for_each(n, ImgParallel::grain_size(), func);
+}
+
+template <class F>
+void
+ImgParallel::for_each(const size_t n, const size_t grain, F func)
+{
+	if (n <= grain) {
+		func(size_t(0), n);
+		return;
+	}
+	const long long chunks = static_cast<long long>(ImgParallel::chunks(n, grain));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+	for (long long c = 0; c < chunks; c++) {
+		size_t begin = size_t(c) * grain;
+		func(begin, std::min(begin + grain, n));
+	}
+}
+
+
+
+
+// ----- ImgPromote -----
+template <class T>
+const T &
+ImgPromote<T>::demote(const T& value)
+{
+	return value;
+}
+
+inline uint8_t
+ImgPromote<uint8_t>::demote(const float value)
+{
+	if (!(value > 0.0f)) { // Including NaN
+		return 0;
+	} else if (value >= 255.0f) {
+		return 255;
+	}
+	return uint8_t(value + 0.5f);
+}
+
+inline uint16_t
+ImgPromote<uint16_t>::demote(const float value)
+{
+	if (!(value > 0.0f)) {
+		return 0;
+	} else if (value >= 65535.0f) {
+		return 65535;
+	}
+	return uint16_t(value + 0.5f);
+}
+
+
+template <class T, class RT>
+void
+ImgConvert<T, RT>::convert(const RT* src, T* dst, const size_t n)
+{
+	typedef typename ImgPromote<T>::type promoted_type;
+	for (size_t i = 0; i < n; i++) {
+		dst[i] = ImgPromote<T>::demote(promoted_type(src[i]));
+	}
+}
+
+
+
+
+// ----- ImgReduction -----
+template <class T>
+ImgReduction<T>::ImgReduction(void)
+{
+	_min = T();
+	_max = T();
+	_sum = accumulator_type();
+	_sum_compensation = accumulator_type();
+	_sum_squared = accumulator_type();
+	_sum_squared_compensation = accumulator_type();
+	_mean = accumulator_type();
+	_squared_deviation = accumulator_type();
+	_count = 0;
+}
+
+
+template <class T>
+void
+ImgReduction<T>::order(const T& value, std::true_type)
+{
+	if (_count == 0) {
+		_min = value;
+		_max = value;
+	} else if (value < _min) {
+		_min = value;
+	} else if (_max < value) {
+		_max = value;
+	}
+}
+
+template <class T>
+void
+ImgReduction<T>::order(const T& value, std::false_type)
+{
+	if (_count == 0) {
+		_min = value;
+		_max = value;
+	}
+}
+
+
+template <class T>
+void
+ImgReduction<T>::add(const T& value)
+{
+	this->order(value, std::integral_constant<bool, ImgComparable<T>::value>());
+	accumulator_type x(value);
+	// Kahan summation
+	accumulator_type y = x - _sum_compensation;
+	accumulator_type t = _sum + y;
+	_sum_compensation = (t - _sum) - y;
+	_sum = t;
+	y = x * x - _sum_squared_compensation;
+	t = _sum_squared + y;
+	_sum_squared_compensation = (t - _sum_squared) - y;
+	_sum_squared = t;
+	// Welford's update
+	_count++;
+	accumulator_type delta = x - _mean;
+	_mean += delta / double(_count);
+	_squared_deviation += delta * (x - _mean);
+}
+
+template <class T>
+void
+ImgReduction<T>::merge(const ImgReduction<T>& reduction)
+{
+	if (reduction._count == 0) {
+		return;
+	} else if (_count == 0) {
+		*this = reduction;
+		return;
+	}
+	this->order(reduction._min, std::integral_constant<bool, ImgComparable<T>::value>());
+	this->order(reduction._max, std::integral_constant<bool, ImgComparable<T>::value>());
+	accumulator_type y = (reduction._sum - reduction._sum_compensation) - _sum_compensation;
+	accumulator_type t = _sum + y;
+	_sum_compensation = (t - _sum) - y;
+	_sum = t;
+	y = (reduction._sum_squared - reduction._sum_squared_compensation) - _sum_squared_compensation;
+	t = _sum_squared + y;
+	_sum_squared_compensation = (t - _sum_squared) - y;
+	_sum_squared = t;
+	// Chan's update
+	const size_t count = _count + reduction._count;
+	accumulator_type delta = reduction._mean - _mean;
+	_mean += delta * (double(reduction._count) / double(count));
+	_squared_deviation += reduction._squared_deviation + delta * delta * (double(_count) * double(reduction._count) / double(count));
+	_count = count;
+}
+
+
+template <class T>
+const T &
+ImgReduction<T>::min(void) const
+{
+	return _min;
+}
+
+template <class T>
+const T &
+ImgReduction<T>::max(void) const
+{
+	return _max;
+}
+
+template <class T>
+const typename ImgReduction<T>::accumulator_type &
+ImgReduction<T>::sum(void) const
+{
+	return _sum;
+}
+
+template <class T>
+const typename ImgReduction<T>::accumulator_type &
+ImgReduction<T>::sum_squared(void) const
+{
+	return _sum_squared;
+}
+
+template <class T>
+size_t
+ImgReduction<T>::count(void) const
+{
+	return _count;
+}
+
+template <class T>
+typename ImgReduction<T>::accumulator_type
+ImgReduction<T>::mean(void) const
+{
+	if (_count == 0) {
+		return accumulator_type();
+	}
+	return _sum / double(_count);
+}
+
+template <class T>
+typename ImgReduction<T>::accumulator_type
+ImgReduction<T>::variance(void) const
+{
+	if (_count == 0) {
+		return accumulator_type();
+	}
+	return _squared_deviation / double(_count);
+}
 
 
 
@@ -12,22 +265,40 @@ ImgVector<T>::ImgVector(void)
 {
 	_data = nullptr;
 	_reserved_size = 0;
+	_external = false;
+	_shared = false;
+	_allocator = ImgAllocator::default_allocator();
 	_width = 0;
 	_height = 0;
 }
 
 
+template <class T>
+ImgVector<T>::ImgVector(ImgAllocator* allocator)
+{
+	_data = nullptr;
+	_reserved_size = 0;
+	_external = false;
+	_shared = false;
+	_allocator = allocator != nullptr ? allocator : ImgAllocator::default_allocator();
+	_width = 0;
+	_height = 0;
+}
+
 template <class T>
 ImgVector<T>::ImgVector(const int Width, const int Height, const T& value)
 {
 	_data = nullptr;
 	_reserved_size = 0;
+	_external = false;
+	_shared = false;
+	_allocator = ImgAllocator::default_allocator();
 	_width = 0;
 	_height = 0;
 	if (Width > 0 && Height > 0) {
 		_reserved_size = size_t(Width) * size_t(Height);
 		try {
-			_data = new T[_reserved_size];
+			_data = this->allocate(_reserved_size);
 		}
 		catch (const std::bad_alloc& bad) {
 			std::cerr << bad.what() << std::endl
@@ -48,12 +319,15 @@ ImgVector<T>::ImgVector(const int Width, const int Height, const T* array)
 {
 	_data = nullptr;
 	_reserved_size = 0;
+	_external = false;
+	_shared = false;
+	_allocator = ImgAllocator::default_allocator();
 	_width = 0;
 	_height = 0;
 	if (Width > 0 && Height > 0) {
 		_reserved_size = size_t(Width) * size_t(Height);
 		try {
-			_data = new T[_reserved_size];
+			_data = this->allocate(_reserved_size);
 		}
 		catch (const std::bad_alloc& bad) {
 			std::cerr << bad.what() << std::endl
@@ -77,32 +351,54 @@ ImgVector<T>::ImgVector(const ImgVector<T>& copy)
 {
 	_data = nullptr;
 	_reserved_size = 0;
+	_external = false;
+	_shared = false;
+	_allocator = copy._allocator; // Inherit the allocation policy
 	_width = 0;
 	_height = 0;
 	if (copy._width > 0 && copy._height > 0) {
-		_reserved_size = copy.size();
-		try {
-			_data = new T[_reserved_size];
-		}
-		catch (const std::bad_alloc& bad) {
-			std::cerr << bad.what() << std::endl
-			    << "ImgVector::ImgVector(const ImgVector<T>&) : Cannot Allocate Memory" << std::endl;
-			_data = nullptr;
-			throw;
-		}
-		_width = copy._width;
-		_height = copy._height;
-		for (size_t n = 0; n < _reserved_size; n++) {
-			_data[n] = copy._data[n];
+		if (copy._external == false) { // Share the memory until the first write
+			this->share(copy);
+		} else {
+			_reserved_size = copy.size();
+			try {
+				_data = this->allocate(_reserved_size);
+			}
+			catch (const std::bad_alloc& bad) {
+				std::cerr << bad.what() << std::endl
+				    << "ImgVector::ImgVector(const ImgVector<T>&) : Cannot Allocate Memory" << std::endl;
+				_data = nullptr;
+				throw;
+			}
+			_width = copy._width;
+			_height = copy._height;
+			for (size_t n = 0; n < _reserved_size; n++) {
+				_data[n] = copy._data[n];
+			}
 		}
 	}
 }
 
 
+template <class T>
+template <class E>
+ImgVector<T>::ImgVector(const ImgExpression<E>& expression)
+{
+	_data = nullptr;
+	_reserved_size = 0;
+	_external = false;
+	_shared = false;
+	_allocator = ImgAllocator::default_allocator();
+	_width = 0;
+	_height = 0;
+	*this = expression;
+}
+
+
 template <class T>
 ImgVector<T>::~ImgVector(void)
 {
-	delete[] _data;
+	this->deallocate();
 }
 
 
@@ -114,22 +410,226 @@ ImgVector<T>::reserve(const int Width, const int Height)
 	if (_reserved_size < new_size) {
 		T* new_data = nullptr;
 		try {
-			new_data = new T[new_size];
+			new_data = this->allocate(new_size);
 		}
 		catch (const std::bad_alloc& bad) {
 			std::cerr << bad.what() << std::endl
 			    << "ImgVector<T>::reserve(const int, const int) : Cannot allocate Memory" << std::endl;
 			throw;
 		}
-		_reserved_size = new_size;
 		for (size_t y = 0; y < size_t(_height); y++) {
 			for (size_t x = 0; x < size_t(_width); x++) {
 				new_data[size_t(_width) * y + x] = _data[size_t(_width) * y + x];
 			}
 		}
-		delete[] _data;
+		this->deallocate();
 		_data = new_data;
+		_reserved_size = new_size;
+	}
+}
+
+
+/*
+ * Refer the external array of Width x Height without ownership.
+ * The array is not deleted by *this and it should outlive *this.
+ * If *this needs larger memory (e.g. reset() to larger size) then it allocates its own memory.
+ */
+template <class T>
+ImgVector<T> &
+ImgVector<T>::attach(const int Width, const int Height, T* array)
+{
+	this->deallocate();
+	if (Width > 0 && Height > 0 && array != nullptr) {
+		_data = array;
+		_reserved_size = size_t(Width) * size_t(Height);
+		_external = true;
+		_width = Width;
+		_height = Height;
+	} else {
+		_width = 0;
+		_height = 0;
+	}
+	return *this;
+}
+
+
+/*
+ * Refer the pixels of vector without copying and duplicate them on the first write (copy-on-write).
+ * The owned memory of vector is shared with the reference count as copy().
+ * The external memory of vector (e.g. ImgMapped) is referred read-only and it should outlive *this,
+ * so the large images are not loaded into the memory until they are modified.
+ */
+template <class T>
+ImgVector<T> &
+ImgVector<T>::view(const ImgVector<T>& vector)
+{
+	if (this == &vector) {
+		return *this;
+	} else if (vector.isNULL()) {
+		this->deallocate();
+		_width = 0;
+		_height = 0;
+	} else if (vector._external == false) { // Shared if the allocators are the same (see copy())
+		this->deallocate();
+		this->copy(vector);
+	} else {
+		this->deallocate();
+		_data = vector._data;
+		_reserved_size = vector.size();
+		_external = true;
+		_shared.store(true, std::memory_order_relaxed);
+		_width = vector._width;
+		_height = vector._height;
 	}
+	return *this;
+}
+
+
+/*
+ * Allocate the memory of n pixels by _allocator and construct the pixels on it.
+ * The pixels are default-initialized as new T[n].
+ * The reference count is placed in the header of ImgAllocator::Alignment bytes before the pixels.
+ */
+template <class T>
+T *
+ImgVector<T>::allocate(const size_t n) const
+{
+	static_assert(sizeof(std::atomic<size_t>) <= ImgAllocator::Alignment, "ImgVector<T>::allocate : size of the header");
+	void* header = _allocator->allocate(ImgAllocator::Alignment + n * sizeof(T));
+	new (header) std::atomic<size_t>(1);
+	T* memory = reinterpret_cast<T*>(static_cast<char*>(header) + ImgAllocator::Alignment);
+	size_t constructed = 0;
+	try {
+		for (; constructed < n; constructed++) {
+			new (memory + constructed) T;
+		}
+	}
+	catch (...) {
+		for (size_t i = 0; i < constructed; i++) {
+			memory[i].~T();
+		}
+		ImgVector<T>::references(memory)->~atomic();
+		_allocator->deallocate(header, ImgAllocator::Alignment + n * sizeof(T));
+		throw;
+	}
+	return memory;
+}
+
+/*
+ * Release the memory.
+ * The shared memory is destructed by the last reference.
+ */
+template <class T>
+void
+ImgVector<T>::deallocate(void)
+{
+	this->release();
+	_data = nullptr;
+	_reserved_size = 0;
+	_external = false;
+	_shared = false;
+}
+
+
+template <class T>
+void
+ImgVector<T>::release(void)
+{
+	if (_external == false && _data != nullptr) {
+		std::atomic<size_t>* count = ImgVector<T>::references(_data);
+		if (count->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			for (size_t n = 0; n < _reserved_size; n++) {
+				_data[n].~T();
+			}
+			count->~atomic();
+			_allocator->deallocate(count, ImgAllocator::Alignment + _reserved_size * sizeof(T));
+		}
+	}
+}
+
+
+/*
+ * Refer the memory of vector with the reference count.
+ * vector should own its memory allocated by the same allocator as *this.
+ */
+template <class T>
+void
+ImgVector<T>::share(const ImgVector<T>& vector)
+{
+	if (_data != vector._data) {
+		this->deallocate();
+		ImgVector<T>::references(vector._data)->fetch_add(1, std::memory_order_relaxed);
+		_data = vector._data;
+		_reserved_size = vector._reserved_size;
+	}
+	_shared.store(true, std::memory_order_relaxed);
+	vector._shared.store(true, std::memory_order_relaxed);
+	_width = vector._width;
+	_height = vector._height;
+}
+
+template <class T>
+std::atomic<size_t> *
+ImgVector<T>::references(T* data)
+{
+	return reinterpret_cast<std::atomic<size_t>*>(reinterpret_cast<char*>(data) - ImgAllocator::Alignment);
+}
+
+
+/*
+ * Apply func(_data[n], expression[n]) to all pixels in a single pass.
+ * The scalar expression is broadcast, otherwise the size of the expression should be the same as *this.
+ */
+template <class T>
+template <class E, class F>
+void
+ImgVector<T>::evaluate(const E& expression, F func)
+{
+	if (E::Broadcast == false
+	    && (_width != expression.width() || _height != expression.height())) {
+		std::cerr << "void ImgVector<T>::evaluate(const E&, F) : Size of the expression is not match" << std::endl;
+		throw std::invalid_argument("Size of the expression is not match");
+	}
+	this->unshare();
+	T* data = _data;
+	ImgParallel::for_each(this->size(),
+	    [data, &expression, &func](const size_t begin, const size_t end) {
+		for (size_t n = begin; n < end; n++) {
+			func(data[n], expression[n]);
+		}
+	});
+}
+
+
+/*
+ * Change the allocation policy.
+ * The data is moved to the memory allocated by the new allocator.
+ * The allocator should outlive *this.
+ */
+template <class T>
+ImgVector<T> &
+ImgVector<T>::set_allocator(ImgAllocator* allocator)
+{
+	if (allocator == nullptr) {
+		allocator = ImgAllocator::default_allocator();
+	}
+	if (allocator == _allocator) {
+		return *this;
+	} else if (_external || _data == nullptr) {
+		_allocator = allocator;
+		return *this;
+	}
+	ImgVector<T> moved(allocator);
+	if (this->isNULL() == false) {
+		moved.copy(*this);
+	}
+	this->deallocate();
+	_allocator = allocator;
+	_data = moved._data;
+	_reserved_size = moved._reserved_size;
+	moved._data = nullptr;
+	moved._reserved_size = 0;
+	return *this;
 }
 
 
@@ -149,17 +649,20 @@ ImgVector<T>::reset(const int Width, const int Height, const T& value)
 {
 	if (Width > 0 && Height > 0) {
 		size_t new_size = size_t(Width) * size_t(Height);
+		if (this->isShared()) { // All pixels are overwritten
+			this->deallocate();
+		}
 		if (_reserved_size < new_size) {
 			T* new_data = nullptr;
 			try {
-				new_data = new T[new_size];
+				new_data = this->allocate(new_size);
 			}
 			catch (const std::bad_alloc& bad) {
 				std::cerr << bad.what() << std::endl
 				    << "ImgVector::reset(const int, const int, const T&) : Cannot Allocate Memory" << std::endl;
 				throw;
 			}
-			delete[] _data;
+			this->deallocate();
 			_data = new_data;
 			_reserved_size = new_size;
 		}
@@ -177,16 +680,20 @@ ImgVector<T>::reset(const int Width, const int Height, const T* array)
 {
 	if (Width > 0 && Height > 0) {
 		size_t new_size = size_t(Width) * size_t(Height);
+		if (this->isShared()) { // All pixels are overwritten
+			this->deallocate();
+		}
 		if (_reserved_size < new_size) {
 			T* new_data = nullptr;
 			try {
-				new_data = new T[new_size];
+				new_data = this->allocate(new_size);
 			}
 			catch (const std::bad_alloc& bad) {
 				std::cerr << bad.what() << std::endl
 				    << "ImgVector::reset(const int, const int, const T*) : Cannot Allocate Memory" << std::endl;
 				throw;
 			}
+			this->deallocate();
 			_data = new_data;
 			_reserved_size = new_size;
 		}
@@ -210,7 +717,7 @@ ImgVector<T>::resize(const int Width, const int Height, const T& value)
 		if (_reserved_size < new_size) { // New size is greater than previous size
 			T *new_data = nullptr;
 			try {
-				new_data = new T[new_size];
+				new_data = this->allocate(new_size);
 			}
 			catch (const std::bad_alloc& bad) {
 				std::cerr << bad.what() << std::endl
@@ -227,10 +734,11 @@ ImgVector<T>::resize(const int Width, const int Height, const T& value)
 					}
 				}
 			}
-			delete[] _data;
+			this->deallocate();
 			_data = new_data;
 			_reserved_size = new_size;
 		} else if (Width > _width) { // New size is less than or equal to previous but new_width > previous_width
+			this->unshare();
 			for (int y = Height - 1; y >= 0; y--) {
 				for (int x = Width - 1; x >= 0; x--) {
 					if (y < _height && x < _width) {
@@ -242,6 +750,7 @@ ImgVector<T>::resize(const int Width, const int Height, const T& value)
 				}
 			}
 		} else {
+			this->unshare();
 			for (size_t y = 0; y < size_t(Height); y++) {
 				for (size_t x = 0; x < size_t(Width); x++) {
 					if (y < size_t(_height) && x < size_t(_width)) {
@@ -253,8 +762,7 @@ ImgVector<T>::resize(const int Width, const int Height, const T& value)
 			}
 		}
 	} else {
-		delete[] _data;
-		_data = nullptr;
+		this->deallocate();
 	}
 	_width = Width;
 	_height = Height;
@@ -267,18 +775,25 @@ ImgVector<T>::copy(const ImgVector<T>& vector)
 {
 	if (this != &vector
 	    && vector._width > 0 && vector._height > 0) {
+		if (_external == false && vector._external == false
+		    && _allocator == vector._allocator) { // Share the memory until the first write
+			this->share(vector);
+			return *this;
+		} else if (this->isShared()) { // All pixels are overwritten
+			this->deallocate();
+		}
 		size_t new_size = vector.size();
 		if (_reserved_size < new_size) {
 			T *new_data = nullptr;
 			try {
-				new_data = new T[new_size];
+				new_data = this->allocate(new_size);
 			}
 			catch (const std::bad_alloc& bad) {
 				std::cerr << bad.what() << std::endl
 				    << "ImgVector::copy(const ImgVector<T>&) : Cannot Allocate Memory" << std::endl;
 				throw;
 			}
-			delete[] _data;
+			this->deallocate();
 			_data = new_data;
 			_reserved_size = new_size;
 		}
@@ -298,25 +813,68 @@ ImgVector<T>::cast_copy(const ImgVector<RT>& vector)
 {
 	if (vector.width() > 0 && vector.height() > 0) {
 		size_t new_size = vector.size();
+		if (this->isShared()) { // All pixels are overwritten
+			this->deallocate();
+		}
 		if (_reserved_size < new_size) {
 			T *new_data = nullptr;
 			try {
-				new_data = new T[new_size];
+				new_data = this->allocate(new_size);
 			}
 			catch (const std::bad_alloc& bad) {
 				std::cerr << bad.what() << std::endl
 				    << "ImgVector::operator=(ImgVector<T>&) : Cannot Allocate Memory" << std::endl;
 				throw;
 			}
-			delete[] _data;
+			this->deallocate();
 			_data = new_data;
 			_reserved_size = new_size;
 		}
 		_width = vector.width();
 		_height = vector.height();
-		for (size_t n = 0; n < new_size; n++) {
-			_data[n] = T(vector.get(n)); // copy with cast
+		const RT* src = vector.data();
+		T* dst = _data;
+		ImgParallel::for_each(new_size, [src, dst](const size_t begin, const size_t end) {
+			ImgConvert<T, RT>::convert(src + begin, dst + begin, end - begin); // copy with cast
+		});
+	}
+	return *this;
+}
+
+
+/*
+ * Evaluate the expression and assign it to *this.
+ * *this can be the operand of the expression since the pixels are computed independently.
+ */
+template <class T>
+template <class E>
+ImgVector<T> &
+ImgVector<T>::operator=(const ImgExpression<E>& expression)
+{
+	const E& derived = expression.derived();
+	if (derived.width() > 0 && derived.height() > 0) {
+		size_t new_size = size_t(derived.width()) * size_t(derived.height());
+		if (this->isShared()) { // The shared memory is kept by the other references while the expression refers it
+			this->deallocate();
 		}
+		if (_reserved_size < new_size) {
+			T *new_data = nullptr;
+			try {
+				new_data = this->allocate(new_size);
+			}
+			catch (const std::bad_alloc& bad) {
+				std::cerr << bad.what() << std::endl
+				    << "ImgVector::operator=(const ImgExpression<E>&) : Cannot Allocate Memory" << std::endl;
+				throw;
+			}
+			this->deallocate();
+			_data = new_data;
+			_reserved_size = new_size;
+		}
+		_width = derived.width();
+		_height = derived.height();
+		this->evaluate(derived,
+		    [](T& value, const typename E::value_type& result) { value = result; });
 	}
 	return *this;
 }
@@ -328,18 +886,25 @@ ImgVector<T>::operator=(const ImgVector<T>& vector)
 {
 	if (this != &vector
 	    && vector._width > 0 && vector._height > 0) {
+		if (_external == false && vector._external == false
+		    && _allocator == vector._allocator) { // Share the memory until the first write
+			this->share(vector);
+			return *this;
+		} else if (this->isShared()) { // All pixels are overwritten
+			this->deallocate();
+		}
 		size_t new_size = vector.size();
 		if (_reserved_size < new_size) {
 			T *new_data = nullptr;
 			try {
-				new_data = new T[new_size];
+				new_data = this->allocate(new_size);
 			}
 			catch (const std::bad_alloc& bad) {
 				std::cerr << bad.what() << std::endl
 				    << "ImgVector::operator=(ImgVector<T>&) : Cannot Allocate Memory" << std::endl;
 				throw;
 			}
-			delete[] _data;
+			this->deallocate();
 			_data = new_data;
 			_reserved_size = new_size;
 		}
@@ -364,6 +929,14 @@ ImgVector<T>::reserved_size(void) const
 }
 
 
+template <class T>
+ImgAllocator *
+ImgVector<T>::allocator(void) const
+{
+	return _allocator;
+}
+
+
 template <class T>
 int
 ImgVector<T>::width(void) const
@@ -386,6 +959,27 @@ ImgVector<T>::size(void) const
 }
 
 
+template <class T>
+bool
+ImgVector<T>::isExternal(void) const
+{
+	return _external;
+}
+
+
+template <class T>
+bool
+ImgVector<T>::isShared(void) const
+{
+	if (_data == nullptr) {
+		return false;
+	} else if (_external) { // Read-only view
+		return _shared.load(std::memory_order_relaxed);
+	}
+	return ImgVector<T>::references(_data)->load(std::memory_order_acquire) > 1;
+}
+
+
 template <class T>
 bool
 ImgVector<T>::isNULL(void) const
@@ -400,8 +994,74 @@ ImgVector<T>::isNULL(void) const
 
 
 
+/*
+ * Duplicate the shared memory so that *this is the unique owner.
+ * The reference count is not checked unless the memory has been shared,
+ * so the write to the uniquely owned memory costs only a test of _shared.
+ * The threads writing the pixels of the same image at the same time duplicate the memory only once
+ * (_shared is cleared after _data is replaced, so the threads which see it cleared see the new _data).
+ */
+template <class T>
+void
+ImgVector<T>::unshare(void)
+{
+	if (_shared.load(std::memory_order_acquire)) {
+		this->duplicate();
+	}
+}
+
+template <class T>
+void
+ImgVector<T>::duplicate(void)
+{
+	std::lock_guard<std::mutex> lock(ImgVector<T>::duplicate_lock(this));
+	if (_shared.load(std::memory_order_relaxed) == false) { // Duplicated by the other thread
+		return;
+	} else if (this->isShared() == false) { // The other references have been released
+		_shared.store(false, std::memory_order_release);
+		return;
+	}
+	T* new_data = nullptr;
+	try {
+		new_data = this->allocate(_reserved_size);
+	}
+	catch (const std::bad_alloc& bad) {
+		std::cerr << bad.what() << std::endl
+		    << "ImgVector<T>::unshare(void) : Cannot Allocate Memory" << std::endl;
+		throw;
+	}
+	for (size_t n = 0; n < this->size(); n++) {
+		new_data[n] = _data[n];
+	}
+	this->release();
+	_data = new_data;
+	_external = false;
+	_shared.store(false, std::memory_order_release);
+}
+
+template <class T>
+std::mutex &
+ImgVector<T>::duplicate_lock(const ImgVector<T>* vector)
+{
+	static std::mutex locks[64];
+	return locks[(reinterpret_cast<uintptr_t>(vector) / sizeof(ImgVector<T>)) % 64];
+}
+
+
 template <class T>
 T *
+ImgVector<T>::data(void)
+{
+	if (this->isNULL()) {
+		return nullptr;
+	} else {
+		this->unshare();
+		return _data;
+	}
+}
+
+template <class T>
+const T *
 ImgVector<T>::data(void) const
 {
 	if (this->isNULL()) {
@@ -416,6 +1076,7 @@ template <class T>
 T &
 ImgVector<T>::operator[](const size_t n)
 {
+	this->unshare();
 	return _data[n];
 }
 
@@ -431,7 +1092,8 @@ template <class T>
 T &
 ImgVector<T>::at(const size_t n)
 {
-	assert(0 <= n && n < size_t(_width) * size_t(_height));
+	this->unshare();
+	assert(n < size_t(_width) * size_t(_height));
 	return _data[n];
 }
 
@@ -439,7 +1101,7 @@ template <class T>
 const T &
 ImgVector<T>::at(const size_t n) const
 {
-	assert(0 <= n && n < size_t(_width) * size_t(_height));
+	assert(n < size_t(_width) * size_t(_height));
 	return _data[n];
 }
 
@@ -448,6 +1110,7 @@ template <class T>
 T &
 ImgVector<T>::at(const int x, const int y)
 {
+	this->unshare();
 	assert(0 <= x && x < _width && 0 <= y && y < _height);
 	return _data[size_t(_width) * size_t(y) + size_t(x)];
 }
@@ -468,6 +1131,7 @@ ImgVector<T>::at_repeat(const int x, const int y)
 	size_t x_repeat, y_repeat;
 
 	assert(_width > 0 && _height > 0);
+	this->unshare();
 	if (x >= 0) {
 		x_repeat = static_cast<size_t>(x % _width);
 	} else {
@@ -510,6 +1174,7 @@ ImgVector<T>::at_mirror(const int x, const int y)
 	int y_mirror = y;
 
 	assert(_width > 0 && _height > 0);
+	this->unshare();
 	if (x_mirror < 0) {
 		x_mirror = -x_mirror - 1; // should be set the offset when Mirroring over negative
 	}
@@ -546,6 +1211,7 @@ const T
 ImgVector<T>::set_zeropad(const int x, const int y, const T& value)
 {
 	if (0 <= x && x < _width && 0 <= y && y < _height) {
+		this->unshare();
 		_data[size_t(_width) * size_t(y) + size_t(x)] = value;
 		return _data[size_t(_width) * size_t(y) + size_t(x)];
 	} else {
@@ -569,6 +1235,7 @@ ImgVector<T>::set_repeat(const int x, const int y, const T& value)
 	} else {
 		y_repeat = static_cast<size_t>(_height - (int(std::abs(double(y) + 1.0)) % _height));
 	}
+	this->unshare();
 	_data[size_t(_width) * y_repeat + x_repeat] = value;
 	return _data[size_t(_width) * y_repeat + x_repeat];
 }
@@ -589,6 +1256,7 @@ ImgVector<T>::set_mirror(const int x, const int y, const T& value)
 	}
 	x_mirror = int(round(_width - 0.5 - std::fabs(_width - 0.5 - (x_mirror % (2 * _width)))));
 	y_mirror = int(round(_height - 0.5 - std::fabs(_height - 0.5 - (y_mirror % (2 * _height)))));
+	this->unshare();
 	_data[size_t(_width) * size_t(y_mirror) + size_t(x_mirror)] = value;
 	return _data[size_t(_width) * size_t(y_mirror) + size_t(x_mirror)];
 }
@@ -598,7 +1266,7 @@ template <class T>
 const T
 ImgVector<T>::get(const size_t n) const
 {
-	assert(0 <= n && n < size_t(_width) * size_t(_height));
+	assert(n < size_t(_width) * size_t(_height));
 	return _data[n];
 }
 
@@ -625,135 +1293,493 @@ ImgVector<T>::get_zeropad(const int x, const int y) const
 }
 
 template <class T>
-const T
-ImgVector<T>::get_valpad(const int x, const int y, const T& value) const
+const T
+ImgVector<T>::get_valpad(const int x, const int y, const T& value) const
+{
+	assert(_width > 0 && _height > 0);
+	if (x < 0 || _width <= x || y < 0 || _height <= y) {
+		return value;
+	} else {
+		return _data[size_t(_width) * size_t(y) + size_t(x)];
+	}
+}
+
+template <class T>
+const T
+ImgVector<T>::get_repeat(const int x, const int y) const
+{
+	size_t x_repeat, y_repeat;
+
+	assert(_width > 0 && _height > 0);
+	if (x >= 0) {
+		x_repeat = static_cast<size_t>(x % _width);
+	} else {
+		x_repeat = static_cast<size_t>(_width - (int(std::abs(double(x) + 1.0)) % _width));
+	}
+	if (y >= 0) {
+		y_repeat = static_cast<size_t>(y % _height);
+	} else {
+		y_repeat = static_cast<size_t>(_height - (int(std::abs(double(y) + 1.0)) % _height));
+	}
+	return _data[size_t(_width) * y_repeat + x_repeat];
+}
+
+template <class T>
+const T
+ImgVector<T>::get_mirror(const int x, const int y) const
+{
+	int x_mirror = x;
+	int y_mirror = y;
+
+	assert(_width > 0 && _height > 0);
+	if (x_mirror < 0) {
+		x_mirror = -x_mirror - 1; // should be set the offset when Mirroring over negative
+	}
+	if (y_mirror < 0) {
+		y_mirror = -y_mirror - 1;
+	}
+	x_mirror = int(round(_width - 0.5 - std::fabs(_width - 0.5 - (x_mirror % (2 * _width)))));
+	y_mirror = int(round(_height - 0.5 - std::fabs(_height - 0.5 - (y_mirror % (2 * _height)))));
+	return _data[size_t(_width) * size_t(y_mirror) + size_t(x_mirror)];
+}
+
+
+
+
+// Get continuous function interpolated by bicubic
+template <class T>
+const typename ImgPromote<T>::type
+ImgVector<T>::get_zeropad_cubic(const double& x, const double& y, const double& B, const double& C) const
+{
+	typedef typename ImgPromote<T>::type promoted_type;
+	typename ImgScalar<T>::type bicubic_x[4];
+	typename ImgScalar<T>::type bicubic_y[4];
+	promoted_type value = promoted_type();
+
+	assert(_width > 0 && _height > 0);
+	if (fabs(x - floor(x)) < DBL_EPSILON
+	    && fabs(y - floor(y)) < DBL_EPSILON) {
+		value = promoted_type(this->get_zeropad(int(x), int(y)));
+	} else {
+		for (int n = 0; n < 4; n++) {
+			bicubic_x[n] = this->cubic(n - 1.0 - (x - floor(x)), B, C);
+			bicubic_y[n] = this->cubic(n - 1.0 - (y - floor(y)), B, C);
+		}
+		for (int m = 0; m < 4; m++) {
+			for (int n = 0; n < 4; n++) {
+				value += promoted_type(this->get_zeropad(int(floor(x)) + n - 1, int(floor(y)) + m - 1))
+				    * bicubic_x[n] * bicubic_y[m];
+			}
+		}
+	}
+	return value;
+}
+
+template <class T>
+const typename ImgPromote<T>::type
+ImgVector<T>::get_repeat_cubic(const double& x, const double& y, const double& B, const double& C) const
+{
+	typedef typename ImgPromote<T>::type promoted_type;
+	typename ImgScalar<T>::type bicubic_x[4];
+	typename ImgScalar<T>::type bicubic_y[4];
+	promoted_type value = promoted_type();
+
+	assert(_width > 0 && _height > 0);
+	if (fabs(x - floor(x)) < DBL_EPSILON
+	    && fabs(y - floor(y)) < DBL_EPSILON) {
+		value = promoted_type(this->get_zeropad(int(x), int(y)));
+	} else {
+		for (int n = 0; n < 4; n++) {
+			bicubic_x[n] = this->cubic(n - 1.0 - (x - floor(x)), B, C);
+			bicubic_y[n] = this->cubic(n - 1.0 - (y - floor(y)), B, C);
+		}
+		for (int m = 0; m < 4; m++) {
+			for (int n = 0; n < 4; n++) {
+				value += promoted_type(this->get_repeat(int(floor(x)) + n - 1, int(floor(y)) + m - 1))
+				    * bicubic_x[n] * bicubic_y[m];
+			}
+		}
+	}
+	return value;
+}
+
+template <class T>
+const typename ImgPromote<T>::type
+ImgVector<T>::get_mirror_cubic(const double& x, const double& y, const double& B, const double& C) const
+{
+	typedef typename ImgPromote<T>::type promoted_type;
+	typename ImgScalar<T>::type bicubic_x[4];
+	typename ImgScalar<T>::type bicubic_y[4];
+	promoted_type value = promoted_type();
+
+	assert(_width > 0 && _height > 0);
+	if (fabs(x - floor(x)) < DBL_EPSILON
+	    && fabs(y - floor(y)) < DBL_EPSILON) {
+		value = promoted_type(this->get_zeropad(int(x), int(y)));
+	} else {
+		for (int n = 0; n < 4; n++) {
+			bicubic_x[n] = this->cubic(n - 1.0 - (x - floor(x)), B, C);
+			bicubic_y[n] = this->cubic(n - 1.0 - (y - floor(y)), B, C);
+		}
+		for (int m = 0; m < 4; m++) {
+			for (int n = 0; n < 4; n++) {
+				value += promoted_type(this->get_mirror(int(floor(x)) + n - 1, int(floor(y)) + m - 1))
+				    * bicubic_x[n] * bicubic_y[m];
+			}
+		}
+	}
+	return value;
+}
+
+
+
+
+/*
+ * Interpolation by the kernel.
+ * The pixel itself is returned at the integral coordinates like get_*_cubic().
+ */
+template <class T>
+const typename ImgPromote<T>::type
+ImgVector<T>::get_zeropad_interpolated(const double& x, const double& y, const ImgKernel& kernel) const
+{
+	typename ImgPromote<T>::type value;
+	this->sample_zeropad(&value, &x, &y, 1, kernel);
+	return value;
+}
+
+template <class T>
+const typename ImgPromote<T>::type
+ImgVector<T>::get_repeat_interpolated(const double& x, const double& y, const ImgKernel& kernel) const
+{
+	typename ImgPromote<T>::type value;
+	this->sample_repeat(&value, &x, &y, 1, kernel);
+	return value;
+}
+
+template <class T>
+const typename ImgPromote<T>::type
+ImgVector<T>::get_mirror_interpolated(const double& x, const double& y, const ImgKernel& kernel) const
+{
+	typename ImgPromote<T>::type value;
+	this->sample_mirror(&value, &x, &y, 1, kernel);
+	return value;
+}
+
+
+/*
+ * Sample many points by the kernel.
+ * The taps and the weights of a block of points are computed first and then the pixels are gathered,
+ * so the windows inside the image are read by the row pointers without the boundary checks.
+ */
+template <class T>
+void
+ImgVector<T>::sample_zeropad(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel) const
+{
+	this->sample_kernel(values, x, y, n, kernel,
+	    [this](const int x_tap, const int y_tap) { return this->get_zeropad(x_tap, y_tap); });
+}
+
+template <class T>
+void
+ImgVector<T>::sample_repeat(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel) const
+{
+	this->sample_kernel(values, x, y, n, kernel,
+	    [this](const int x_tap, const int y_tap) { return this->get_repeat(x_tap, y_tap); });
+}
+
+template <class T>
+void
+ImgVector<T>::sample_mirror(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel) const
+{
+	this->sample_kernel(values, x, y, n, kernel,
+	    [this](const int x_tap, const int y_tap) { return this->get_mirror(x_tap, y_tap); });
+}
+
+
+/*
+ * Sample the window at the unit spacing from (x, y) by the kernel.
+ * The weights are computed once for each column and each row of the window.
+ */
+template <class T>
+void
+ImgVector<T>::sample_zeropad(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel) const
+{
+	this->sample_kernel(values, x, y, window_width, window_height, kernel,
+	    [this](const int x_tap, const int y_tap) { return this->get_zeropad(x_tap, y_tap); });
+}
+
+template <class T>
+void
+ImgVector<T>::sample_repeat(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel) const
+{
+	this->sample_kernel(values, x, y, window_width, window_height, kernel,
+	    [this](const int x_tap, const int y_tap) { return this->get_repeat(x_tap, y_tap); });
+}
+
+template <class T>
+void
+ImgVector<T>::sample_mirror(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel) const
+{
+	this->sample_kernel(values, x, y, window_width, window_height, kernel,
+	    [this](const int x_tap, const int y_tap) { return this->get_mirror(x_tap, y_tap); });
+}
+
+
+/*
+ * Sample many points by bicubic.
+ * The values are the same as get_*_cubic() at each point.
+ */
+template <class T>
+void
+ImgVector<T>::sample_zeropad_cubic(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const double B, const double C) const
+{
+	this->sample_zeropad(values, x, y, n, ImgKernel::bicubic(B, C));
+}
+
+template <class T>
+void
+ImgVector<T>::sample_repeat_cubic(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const double B, const double C) const
+{
+	this->sample_repeat(values, x, y, n, ImgKernel::bicubic(B, C));
+}
+
+template <class T>
+void
+ImgVector<T>::sample_mirror_cubic(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const double B, const double C) const
+{
+	this->sample_mirror(values, x, y, n, ImgKernel::bicubic(B, C));
+}
+
+
+template <class T>
+void
+ImgVector<T>::sample_zeropad_cubic(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const double B, const double C) const
+{
+	this->sample_zeropad(values, x, y, window_width, window_height, ImgKernel::bicubic(B, C));
+}
+
+template <class T>
+void
+ImgVector<T>::sample_repeat_cubic(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const double B, const double C) const
+{
+	this->sample_repeat(values, x, y, window_width, window_height, ImgKernel::bicubic(B, C));
+}
+
+template <class T>
+void
+ImgVector<T>::sample_mirror_cubic(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const double B, const double C) const
 {
-	assert(_width > 0 && _height > 0);
-	if (x < 0 || _width <= x || y < 0 || _height <= y) {
-		return value;
-	} else {
-		return _data[size_t(_width) * size_t(y) + size_t(x)];
-	}
+	this->sample_mirror(values, x, y, window_width, window_height, ImgKernel::bicubic(B, C));
 }
 
+
+/*
+ * The rows of the window inside of the image are copied contiguously,
+ * so the kernels (e.g. the search window of the block matching) can read the window without the boundary checks.
+ */
 template <class T>
-const T
-ImgVector<T>::get_repeat(const int x, const int y) const
+void
+ImgVector<T>::copy_window_zeropad(T* values, const int x, const int y, const int window_width, const int window_height) const
 {
-	size_t x_repeat, y_repeat;
-
 	assert(_width > 0 && _height > 0);
-	if (x >= 0) {
-		x_repeat = static_cast<size_t>(x % _width);
-	} else {
-		x_repeat = static_cast<size_t>(_width - (int(std::abs(double(x) + 1.0)) % _width));
-	}
-	if (y >= 0) {
-		y_repeat = static_cast<size_t>(y % _height);
-	} else {
-		y_repeat = static_cast<size_t>(_height - (int(std::abs(double(y) + 1.0)) % _height));
+	const int x_begin = std::min(std::max(x, 0), x + window_width);
+	const int x_end = std::max(std::min(x + window_width, _width), x_begin);
+	for (int j = 0; j < window_height; j++) {
+		T* row = values + size_t(window_width) * size_t(j);
+		if (y + j < 0 || _height <= y + j || x_begin >= x_end) {
+			std::fill(row, row + window_width, T());
+			continue;
+		}
+		const T* src = _data + size_t(_width) * size_t(y + j);
+		std::fill(row, row + (x_begin - x), T());
+		std::copy(src + x_begin, src + x_end, row + (x_begin - x));
+		std::fill(row + (x_end - x), row + window_width, T());
 	}
-	return _data[size_t(_width) * y_repeat + x_repeat];
 }
 
+
+/*
+ * The radius of the kernel is dispatched to the template parameter,
+ * so the loops over the taps are unrolled for each kernel.
+ */
 template <class T>
-const T
-ImgVector<T>::get_mirror(const int x, const int y) const
+template <class F>
+void
+ImgVector<T>::sample_kernel(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel, F boundary) const
 {
-	int x_mirror = x;
-	int y_mirror = y;
-
-	assert(_width > 0 && _height > 0);
-	if (x_mirror < 0) {
-		x_mirror = -x_mirror - 1; // should be set the offset when Mirroring over negative
-	}
-	if (y_mirror < 0) {
-		y_mirror = -y_mirror - 1;
+	switch (kernel.radius()) {
+		case 1:
+			this->sample_radius<1>(values, x, y, n, kernel, boundary);
+			break;
+		case 2:
+			this->sample_radius<2>(values, x, y, n, kernel, boundary);
+			break;
+		case 3:
+			this->sample_radius<3>(values, x, y, n, kernel, boundary);
+			break;
+		default:
+			this->sample_radius<ImgKernel::MaxRadius>(values, x, y, n, kernel, boundary);
 	}
-	x_mirror = int(round(_width - 0.5 - std::fabs(_width - 0.5 - (x_mirror % (2 * _width)))));
-	y_mirror = int(round(_height - 0.5 - std::fabs(_height - 0.5 - (y_mirror % (2 * _height)))));
-	return _data[size_t(_width) * size_t(y_mirror) + size_t(x_mirror)];
 }
 
+template <class T>
+template <class F>
+void
+ImgVector<T>::sample_kernel(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel, F boundary) const
+{
+	switch (kernel.radius()) {
+		case 1:
+			this->sample_radius<1>(values, x, y, window_width, window_height, kernel, boundary);
+			break;
+		case 2:
+			this->sample_radius<2>(values, x, y, window_width, window_height, kernel, boundary);
+			break;
+		case 3:
+			this->sample_radius<3>(values, x, y, window_width, window_height, kernel, boundary);
+			break;
+		default:
+			this->sample_radius<ImgKernel::MaxRadius>(values, x, y, window_width, window_height, kernel, boundary);
+	}
+}
 
 
-
-// Get continuous function interpolated by bicubic
 template <class T>
-const T
-ImgVector<T>::get_zeropad_cubic(const double& x, const double& y, const double& B, const double& C) const
+template <int R, class F>
+void
+ImgVector<T>::sample_radius(typename ImgPromote<T>::type* values, const double* x, const double* y, const size_t n, const ImgKernel& kernel, F boundary) const
 {
-	double bicubic_x[4];
-	double bicubic_y[4];
-	T value = T();
+	typedef typename ImgPromote<T>::type promoted_type;
+	typedef typename ImgScalar<T>::type scalar_type;
+	const size_t Block = 64;
 
 	assert(_width > 0 && _height > 0);
-	if (fabs(x - floor(x)) < DBL_EPSILON
-	    && fabs(y - floor(y)) < DBL_EPSILON) {
-		value = this->get_zeropad(int(x), int(y));
-	} else {
-		for (int n = 0; n < 4; n++) {
-			bicubic_x[n] = this->cubic(n - 1.0 - (x - floor(x)), B, C);
-			bicubic_y[n] = this->cubic(n - 1.0 - (y - floor(y)), B, C);
-		}
-		for (int m = 0; m < 4; m++) {
-			for (int n = 0; n < 4; n++) {
-				value += this->get_zeropad(int(floor(x)) + n - 1, int(floor(y)) + m - 1)
-				    * bicubic_x[n] * bicubic_y[m];
+	assert(kernel.radius() == R);
+	ImgParallel::for_each(n,
+	    [this, values, x, y, &kernel, &boundary](const size_t begin, const size_t end) {
+		int index_x[Block];
+		int index_y[Block];
+		bool integral[Block];
+		scalar_type weight_x[Block][2 * R];
+		scalar_type weight_y[Block][2 * R];
+
+		for (size_t block = begin; block < end; block += Block) {
+			const size_t length = end - block < Block ? end - block : Block;
+			// Taps and weights
+			for (size_t i = 0; i < length; i++) {
+				const double floor_x = floor(x[block + i]);
+				const double floor_y = floor(y[block + i]);
+				integral[i] = fabs(x[block + i] - floor_x) < DBL_EPSILON
+				    && fabs(y[block + i] - floor_y) < DBL_EPSILON;
+				if (integral[i]) { // The same as get_*_cubic()
+					index_x[i] = int(x[block + i]);
+					index_y[i] = int(y[block + i]);
+				} else {
+					index_x[i] = int(floor_x);
+					index_y[i] = int(floor_y);
+					this->kernel_weights(weight_x[i], x[block + i] - floor_x, kernel);
+					this->kernel_weights(weight_y[i], y[block + i] - floor_y, kernel);
+				}
+			}
+			// Gather
+			for (size_t i = 0; i < length; i++) {
+				if (integral[i]) {
+					values[block + i] = promoted_type(this->get_zeropad(index_x[i], index_y[i]));
+				} else {
+					values[block + i] = this->template kernel_gather<R>(index_x[i], index_y[i], weight_x[i], weight_y[i], boundary);
+				}
 			}
 		}
-	}
-	return value;
+	});
 }
 
 template <class T>
-const T
-ImgVector<T>::get_repeat_cubic(const double& x, const double& y, const double& B, const double& C) const
+template <int R, class F>
+void
+ImgVector<T>::sample_radius(typename ImgPromote<T>::type* values, const double x, const double y, const int window_width, const int window_height, const ImgKernel& kernel, F boundary) const
 {
-	double bicubic_x[4];
-	double bicubic_y[4];
-	T value = T();
+	typedef typename ImgPromote<T>::type promoted_type;
+	typedef typename ImgScalar<T>::type scalar_type;
+	std::vector<int> index_x;
+	std::vector<int> index_y;
+	std::vector<int> integral_x; // Index of the integral coordinate or INT_MIN
+	std::vector<int> integral_y;
+	std::vector<scalar_type> weight_x;
+	std::vector<scalar_type> weight_y;
 
 	assert(_width > 0 && _height > 0);
-	if (fabs(x - floor(x)) < DBL_EPSILON
-	    && fabs(y - floor(y)) < DBL_EPSILON) {
-		value = this->get_zeropad(int(x), int(y));
-	} else {
-		for (int n = 0; n < 4; n++) {
-			bicubic_x[n] = this->cubic(n - 1.0 - (x - floor(x)), B, C);
-			bicubic_y[n] = this->cubic(n - 1.0 - (y - floor(y)), B, C);
-		}
-		for (int m = 0; m < 4; m++) {
-			for (int n = 0; n < 4; n++) {
-				value += this->get_repeat(int(floor(x)) + n - 1, int(floor(y)) + m - 1)
-				    * bicubic_x[n] * bicubic_y[m];
+	assert(kernel.radius() == R);
+	if (window_width <= 0 || window_height <= 0) {
+		return;
+	}
+	try {
+		index_x.resize(size_t(window_width));
+		integral_x.resize(size_t(window_width));
+		weight_x.resize(2 * R * size_t(window_width));
+		index_y.resize(size_t(window_height));
+		integral_y.resize(size_t(window_height));
+		weight_y.resize(2 * R * size_t(window_height));
+	}
+	catch (const std::bad_alloc& bad) {
+		std::cerr << bad.what() << std::endl
+		    << "void ImgVector<T>::sample_radius(typename ImgPromote<T>::type*, const double, const double, const int, const int, const ImgKernel&, F) const : Cannot Allocate Memory" << std::endl;
+		throw;
+	}
+	// The coordinates are computed as (x + i, y + j) like the callers of get_*_cubic()
+	for (int i = 0; i < window_width; i++) {
+		const double x_i = x + i;
+		const double floor_x = floor(x_i);
+		index_x[i] = int(floor_x);
+		integral_x[i] = fabs(x_i - floor_x) < DBL_EPSILON ? int(x_i) : INT_MIN;
+		this->kernel_weights(&weight_x[2 * R * i], x_i - floor_x, kernel);
+	}
+	for (int j = 0; j < window_height; j++) {
+		const double y_j = y + j;
+		const double floor_y = floor(y_j);
+		index_y[j] = int(floor_y);
+		integral_y[j] = fabs(y_j - floor_y) < DBL_EPSILON ? int(y_j) : INT_MIN;
+		this->kernel_weights(&weight_y[2 * R * j], y_j - floor_y, kernel);
+	}
+	const size_t grain = std::max(size_t(1), ImgParallel::grain_size() / size_t(window_width));
+	ImgParallel::for_each(size_t(window_height), grain,
+	    [&](const size_t begin, const size_t end) {
+		for (size_t j = begin; j < end; j++) {
+			promoted_type* row = values + size_t(window_width) * j;
+			for (int i = 0; i < window_width; i++) {
+				if (integral_x[i] != INT_MIN && integral_y[j] != INT_MIN) {
+					row[i] = promoted_type(this->get_zeropad(integral_x[i], integral_y[j]));
+				} else {
+					row[i] = this->template kernel_gather<R>(index_x[i], index_y[j], &weight_x[2 * R * i], &weight_y[2 * R * j], boundary);
+				}
 			}
 		}
-	}
-	return value;
+	});
 }
 
-template <class T>
-const T
-ImgVector<T>::get_mirror_cubic(const double& x, const double& y, const double& B, const double& C) const
-{
-	double bicubic_x[4];
-	double bicubic_y[4];
-	T value = T();
 
-	assert(_width > 0 && _height > 0);
-	if (fabs(x - floor(x)) < DBL_EPSILON
-	    && fabs(y - floor(y)) < DBL_EPSILON) {
-		value = this->get_zeropad(int(x), int(y));
-	} else {
-		for (int n = 0; n < 4; n++) {
-			bicubic_x[n] = this->cubic(n - 1.0 - (x - floor(x)), B, C);
-			bicubic_y[n] = this->cubic(n - 1.0 - (y - floor(y)), B, C);
+/*
+ * Sum of the 2R x 2R window around (x, y) with the separable weights.
+ * The order of the accumulation is the same as get_*_cubic().
+ */
+template <class T>
+template <int R, class F>
+typename ImgPromote<T>::type
+ImgVector<T>::kernel_gather(const int x, const int y, const typename ImgScalar<T>::type* weight_x, const typename ImgScalar<T>::type* weight_y, F boundary) const
+{
+	typedef typename ImgPromote<T>::type promoted_type;
+	promoted_type value = promoted_type();
+
+	if (R - 1 <= x && x + R < _width && R - 1 <= y && y + R < _height) {
+		const T* row = _data + size_t(_width) * size_t(y - R + 1) + size_t(x - R + 1);
+		for (int m = 0; m < 2 * R; m++) {
+			for (int n = 0; n < 2 * R; n++) {
+				value += promoted_type(row[n]) * weight_x[n] * weight_y[m];
+			}
+			row += _width;
 		}
-		for (int m = 0; m < 4; m++) {
-			for (int n = 0; n < 4; n++) {
-				value += this->get_mirror(int(floor(x)) + n - 1, int(floor(y)) + m - 1)
-				    * bicubic_x[n] * bicubic_y[m];
+	} else {
+		for (int m = 0; m < 2 * R; m++) {
+			for (int n = 0; n < 2 * R; n++) {
+				value += promoted_type(boundary(x + n - R + 1, y + m - R + 1)) * weight_x[n] * weight_y[m];
 			}
 		}
 	}
@@ -763,6 +1789,46 @@ ImgVector<T>::get_mirror_cubic(const double& x, const double& y, const double& B
 
 
 
+/*
+ * Minimum and maximum of the non-empty image.
+ * The partial results of the chunks of ImgParallel are merged, so it requires only operator< of T.
+ */
+template <class T>
+void
+ImgVector<T>::minmax(T* min, T* max) const
+{
+	const size_t N = this->size();
+	const size_t grain = ImgParallel::grain_size();
+	const T* data = _data;
+	std::vector<T> min_chunk(ImgParallel::chunks(N, grain));
+	std::vector<T> max_chunk(ImgParallel::chunks(N, grain));
+
+	ImgParallel::for_each(N, grain, [data, grain, &min_chunk, &max_chunk](const size_t begin, const size_t end) {
+		T min_tmp = data[begin];
+		T max_tmp = data[begin];
+		for (size_t i = begin + 1; i < end; i++) {
+			if (data[i] < min_tmp) {
+				min_tmp = data[i];
+			} else if (max_tmp < data[i]) {
+				max_tmp = data[i];
+			}
+		}
+		min_chunk[begin / grain] = min_tmp;
+		max_chunk[begin / grain] = max_tmp;
+	});
+	*min = min_chunk[0];
+	*max = max_chunk[0];
+	for (size_t c = 1; c < min_chunk.size(); c++) {
+		if (min_chunk[c] < *min) {
+			*min = min_chunk[c];
+		}
+		if (*max < max_chunk[c]) {
+			*max = max_chunk[c];
+		}
+	}
+}
+
+
 template <class T>
 const T
 ImgVector<T>::min(void) const
@@ -770,12 +1836,9 @@ ImgVector<T>::min(void) const
 	if (_width <= 0 || _height <= 0) {
 		throw std::logic_error("T ImgVector<T>::min(void) : vector is empty");
 	}
-	T min = _data[0];
-	for (size_t i = 1; i < size_t(_width) * size_t(_height); i++) {
-		if (_data[i] < min) {
-			min = _data[i];
-		}
-	}
+	T min = T();
+	T max = T();
+	this->minmax(&min, &max);
 	return min;
 }
 
@@ -786,12 +1849,9 @@ ImgVector<T>::max(void) const
 	if (_width <= 0 || _height <= 0) {
 		throw std::logic_error("T ImgVector<T>::max(void) : vector is empty");
 	}
-	T max = _data[0];
-	for (size_t i = 1; i < size_t(_width) * size_t(_height); i++) {
-		if (_data[i] > max) {
-			max = _data[i];
-		}
-	}
+	T min = T();
+	T max = T();
+	this->minmax(&min, &max);
 	return max;
 }
 
@@ -852,39 +1912,108 @@ template <class T>
 const T
 ImgVector<T>::variance(void) const
 {
-	double N = double(_width) * double(_height);
-	T sum_squared = T();
-	T sum = T();
-
-	for (size_t y = 0; y < size_t(_height); y++) {
-		for (size_t x = 0; x < size_t(_width); x++) {
-			sum += _data[size_t(_width) * y + x];
-			sum_squared += _data[size_t(_width) * y + x] * _data[size_t(_width) * y + x];
-		}
-	}
-	return sum_squared / N - sum * sum / (N * N);
+	return T(this->reduce().variance());
 }
 
 template <class T>
 const T
 ImgVector<T>::variance(const int top_left_x, const int top_left_y, const int crop_width, const int crop_height) const
 {
-	double N = .0;
-	T sum_squared = T();
-	T sum = T();
-
-	for (int y = top_left_y; y < top_left_y + crop_height; y++) {
-		for (int x = top_left_x; x < top_left_x + crop_width; x++) {
-			if (0 <= x && x < _width
-			    && 0 <= y && y < _height) {
-				N += 1.0;
-				sum += _data[size_t(_width) * size_t(y) + size_t(x)];
-				sum_squared += _data[size_t(_width) * size_t(y) + size_t(x)]
-				    * _data[size_t(_width) * size_t(y) + size_t(x)];
-			}
+	return T(this->reduce(top_left_x, top_left_y, crop_width, crop_height).variance());
+}
+
+/*
+ * The variance of the window in O(1) by integral, the summed-area table of *this with the sums of squares
+ * (the same as variance(top_left_x, top_left_y, crop_width, crop_height) for the scalar pixels).
+ * integral should be rebuilt after *this is modified.
+ */
+template <class T>
+const T
+ImgVector<T>::variance(const int top_left_x, const int top_left_y, const int crop_width, const int crop_height, const IntegralImage<T>& integral) const
+{
+	if (crop_width <= 0) {
+		throw std::invalid_argument("const T ImgVector<T>::variance(int, int, int, int, const IntegralImage<T>&) const : crop_width <= 0");
+	} else if (crop_height <= 0) {
+		throw std::invalid_argument("const T ImgVector<T>::variance(int, int, int, int, const IntegralImage<T>&) const : crop_height <= 0");
+	} else if (integral.width() != _width || integral.height() != _height) {
+		throw std::invalid_argument("const T ImgVector<T>::variance(int, int, int, int, const IntegralImage<T>&) const : size of integral is not match");
+	} else if (integral.isSquared() == false) {
+		throw std::invalid_argument("const T ImgVector<T>::variance(int, int, int, int, const IntegralImage<T>&) const : integral does not have the sum of squares");
+	}
+	return T(integral.variance(top_left_x, top_left_y, crop_width, crop_height));
+}
+
+
+template <class T>
+ImgReduction<T>
+ImgVector<T>::reduce(void) const
+{
+	return this->reduce([](const T& value) { return value; });
+}
+
+/*
+ * Reduce the pixels in the window.
+ * The window is clipped by the image, so the count of the reduction may be smaller than crop_width * crop_height.
+ */
+template <class T>
+ImgReduction<T>
+ImgVector<T>::reduce(const int top_left_x, const int top_left_y, const int crop_width, const int crop_height) const
+{
+	if (crop_width <= 0) {
+		throw std::invalid_argument("ImgReduction<T> ImgVector<T>::reduce(int, int, int, int) : crop_width <= 0");
+	} else if (crop_height <= 0) {
+		throw std::invalid_argument("ImgReduction<T> ImgVector<T>::reduce(int, int, int, int) : crop_height <= 0");
+	}
+	ImgReduction<T> reduction;
+	const int x_begin = std::max(top_left_x, 0);
+	const int x_end = std::min(top_left_x + crop_width, _width);
+	const int y_begin = std::max(top_left_y, 0);
+	const int y_end = std::min(top_left_y + crop_height, _height);
+	for (int y = y_begin; y < y_end; y++) {
+		for (int x = x_begin; x < x_end; x++) {
+			reduction.add(_data[size_t(_width) * size_t(y) + size_t(x)]);
+		}
+	}
+	return reduction;
+}
+
+/*
+ * Reduce func(pixel) of all pixels in a single pass.
+ * Each chunk of ImgParallel is reduced independently and the partial results are merged in order,
+ * so the result does not depend on the number of the threads.
+ */
+template <class T>
+template <class F>
+ImgReduction<typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type>
+ImgVector<T>::reduce(F func) const
+{
+	typedef typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type R;
+	const size_t N = this->size();
+	const size_t grain = ImgParallel::grain_size();
+	const T* data = _data;
+	ImgReduction<R> reduction;
+	if (N == 0) {
+		return reduction;
+	}
+	std::vector<ImgReduction<R> > partial(ImgParallel::chunks(N, grain));
+
+	ImgParallel::for_each(N, grain, [data, grain, &func, &partial](const size_t begin, const size_t end) {
+		ImgReduction<R>& chunk = partial[begin / grain];
+		for (size_t i = begin; i < end; i++) {
+			chunk.add(func(data[i]));
 		}
+	});
+	for (size_t c = 0; c < partial.size(); c++) {
+		reduction.merge(partial[c]);
 	}
-	return sum_squared / N - sum * sum / (N * N);
+	return reduction;
+}
+
+template <class T>
+ImgReduction<double>
+ImgVector<T>::reduce_norm(void) const
+{
+	return this->reduce([](const T& value) { return double(norm(value)); });
 }
 
 
@@ -934,6 +2063,10 @@ ImgVector<T>::crop(const int top_left_x, const int top_left_y, const int crop_wi
 
 
 
+/*
+ * Linear stretching of the intensity.
+ * The minimum and maximum are reduced by minmax() and then the pixels are stretched in parallel.
+ */
 template <class T>
 void
 ImgVector<T>::contrast_stretching(const T& Min, const T& Max)
@@ -941,21 +2074,20 @@ ImgVector<T>::contrast_stretching(const T& Min, const T& Max)
 	if (Min > Max) {
 		throw std::invalid_argument("void ImgVector<T>::contrast_stretching(const T&, const T&) : min > max");
 	}
-	// Initialize
-	T min_tmp = _data[0];
-	T max_tmp = _data[0];
-
-	for (size_t i = 1; i < size_t(_width) * size_t(_height); i++) {
-		if (_data[i] < min_tmp) {
-			min_tmp = _data[i];
-		} else if (_data[i] > max_tmp) {
-			max_tmp = _data[i];
-		}
+	if (this->isNULL()) {
+		return;
 	}
+	this->unshare();
+	T* data = _data;
+	T min_tmp = T();
+	T max_tmp = T();
+	this->minmax(&min_tmp, &max_tmp);
 	// Stretching
-	for (size_t i = 0; i < size_t(_width) * size_t(_height); i++) {
-		_data[i] = Min + (_data[i] - min_tmp) * Max / (max_tmp - min_tmp);
-	}
+	ImgParallel::for_each(this->size(), [data, &Min, &Max, &min_tmp, &max_tmp](const size_t begin, const size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			data[i] = Min + (data[i] - min_tmp) * Max / (max_tmp - min_tmp);
+		}
+	});
 }
 
 
@@ -981,7 +2113,7 @@ ImgVector<T>::resample_zerohold(const int Width, const int Height)
 	scale_x = double(Width) / _width;
 	scale_y = double(Height) / _height;
 	try {
-		resized = new T[size_t(Width) * size_t(Height)];
+		resized = this->allocate(size_t(Width) * size_t(Height));
 	}
 	catch (const std::bad_alloc &bad) {
 		std::cerr << bad.what() << std::endl
@@ -1001,129 +2133,205 @@ ImgVector<T>::resample_zerohold(const int Width, const int Height)
 			resized[size_t(Width) * y + x] = sum / (area_x * area_y);
 		}
 	}
-	delete[] _data;
+	this->deallocate();
 	_data = resized;
+	_reserved_size = size_t(Width) * size_t(Height);
 	_width = Width;
 	_height = Height;
 }
 
 
 /*
-    bool ImgVector<T>::resize_bicubic(int Width, int Height, double min, double max, T (*Nearest_Integer_Method)(double &d), double A)
+    void ImgVector<T>::resample_bicubic(int Width, int Height, T (*Nearest_Integer_Method)(T&), T (*Saturater)(T&), double B, double C)
     int Width, int Height : width and height of resized image
-    double min : minimum value of saturated value
-    double max : maximum value of saturated value
-    T (*Nearest_Integer_Method)(double &d) : round method (e.g. floor(), round(), etc.)
-    A : cubic method's parameter (default A = -0.5 which correspond to Hermite)
+    T (*Nearest_Integer_Method)(T& intensity) : round method (e.g. floor(), round(), etc.)
+    T (*Saturater)(T& intensity) : saturation method applied before rounding
+    B, C : cubic method's parameter (default B = 0, C = 0.5 which correspond to Catmull-Rom)
 */
 template <class T>
 void
 ImgVector<T>::resample_bicubic(const int Width, const int Height, T (*Nearest_Integer_Method)(T& intensity), T (*Saturater)(T& intensity), const double B, const double C)
 {
+	this->resample(Width, Height, ImgKernel::bicubic(B, C), Nearest_Integer_Method, Saturater);
+}
+
+
+/*
+    void ImgVector<T>::resample(int Width, int Height, const ImgKernel& kernel, T (*Nearest_Integer_Method)(T&), T (*Saturater)(T&))
+    Resample by the separable kernel (ImgKernel::bilinear(), bicubic(B, C) or lanczos(N)).
+    The kernel is stretched by the scale on downsampling to avoid the aliasing.
+
+    The separable filter is computed row-major in two passes.
+    The taps (source index with mirroring and weight) are computed once per output column and row,
+    and the vertical pass streams the intermediate image through column strips which fit in L2 cache.
+*/
+template <class T>
+void
+ImgVector<T>::resample(const int Width, const int Height, const ImgKernel& kernel, T (*Nearest_Integer_Method)(T& intensity), T (*Saturater)(T& intensity))
+{
+	typedef typename ImgPromote<T>::type promoted_type;
+	const size_t Strip_Bytes = 256 * 1024; // Size of the working set of vertical convolution
 	T *resized = nullptr;
-	double *conv = nullptr;
-	ImgVector<T> Tmp;
+	promoted_type *tmp = nullptr;
+	int *index_x = nullptr;
+	int *index_y = nullptr;
+	typename ImgScalar<T>::type *conv_x = nullptr;
+	typename ImgScalar<T>::type *conv_y = nullptr;
+	int L_x, L_y;
 	double scale_x, scale_y;
-	double scale_conv;
-	int L, L_center;
-	double dx, dy;
-	T sum;
 
 	if (Width <= 0) {
-		throw std::out_of_range("ImgVector<T>::resample_bicubic(const int, const int, const double, const double, T (*)(double &d), const double, const double) :int Width");
+		throw std::out_of_range("ImgVector<T>::resample(const int, const int, const ImgKernel&, T (*)(T&), T (*)(T&)) : int Width");
 	} else if (Height <= 0) {
-		throw std::out_of_range("ImgVector<T>::resample_bicubic(const int, const int, const double, const double, T (*)(double &d), const double, const double) :int Height");
+		throw std::out_of_range("ImgVector<T>::resample(const int, const int, const ImgKernel&, T (*)(T&), T (*)(T&)) : int Height");
 	}
 	scale_x = double(Width) / _width;
 	scale_y = double(Height) / _height;
-	Tmp.reset(Width, _height);
-	// The length of cubic convolution coefficient
-	scale_conv = 1.0;
-	if (scale_x < 1.0 || scale_y < 1.0) {
-		scale_conv = ceil(1.0 / (scale_x < scale_y ? scale_x : scale_y));
-	}
+	// The length of convolution coefficient
+	L_x = scale_x >= 1.0 ? 2 * kernel.radius() : 2 * kernel.radius() * int(ceil(1.0 / scale_x));
+	L_y = scale_y >= 1.0 ? 2 * kernel.radius() : 2 * kernel.radius() * int(ceil(1.0 / scale_y));
 	try {
-		resized = new T[size_t(Width) * size_t(Height)];
-		conv = new double[int(scale_conv * 4)];
+		tmp = new promoted_type[size_t(Width) * size_t(_height)];
+		index_x = new int[size_t(Width) * size_t(L_x)];
+		index_y = new int[size_t(Height) * size_t(L_y)];
+		conv_x = new typename ImgScalar<T>::type[size_t(Width) * size_t(L_x)];
+		conv_y = new typename ImgScalar<T>::type[size_t(Height) * size_t(L_y)];
+		resized = this->allocate(size_t(Width) * size_t(Height)); // Allocate at last since it is not deleted by delete[]
 	}
 	catch (const std::bad_alloc& bad) {
 		std::cerr << bad.what() << std::endl
-		    << "ImgVector<double>::resample_bicubic(const int, const int, const double, const double, T (*)(double &d), const double, const double) error : Cannot allocate memory" << std::endl;
-		delete[] resized;
-		delete[] conv;
+		    << "ImgVector<T>::resample(const int, const int, const ImgKernel&, T (*)(T&), T (*)(T&)) error : Cannot allocate memory" << std::endl;
+		delete[] tmp;
+		delete[] index_x;
+		delete[] index_y;
+		delete[] conv_x;
+		delete[] conv_y;
 		throw;
 	}
+	this->kernel_taps(index_x, conv_x, L_x, _width, Width, kernel);
+	this->kernel_taps(index_y, conv_y, L_y, _height, Height, kernel);
 	// Horizontal convolution
-	if (scale_x >= 1.0) {
-		scale_conv = 1.0;
-		L = 4;
-		L_center = int(floor((L - 1.0) / 2.0));
-	} else {
-		scale_conv = 1.0 / scale_x;
-		L = 4 * int(ceil(scale_conv));
-		L_center = int(floor((L - 1.0) / 2.0));
-	}
-	for (int x = 0; x < Width; x++) {
-		if (scale_x >= 1.0) {
-			dx = (x - (scale_x - 1.0) / 2.0) / scale_x;
-			for (int n = 0; n < L; n++) {
-				conv[n] = ImgVector<T>::cubic(double(n - L_center) - (dx - floor(dx)), B, C);
-			}
-		} else {
-			dx = x / scale_x + (1.0 / scale_x - 1.0) / 2.0;
-			for (int n = 0; n < L; n++) {
-				conv[n] = ImgVector<T>::cubic((double(n - L_center) - (dx - floor(dx))) * scale_x, B, C) / scale_conv;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int y = 0; y < _height; y++) {
+		const T* row = _data + size_t(_width) * size_t(y);
+		promoted_type* row_tmp = tmp + size_t(Width) * size_t(y);
+		for (int x = 0; x < Width; x++) {
+			const int* index = index_x + size_t(L_x) * size_t(x);
+			const typename ImgScalar<T>::type* conv = conv_x + size_t(L_x) * size_t(x);
+			promoted_type sum = promoted_type();
+			for (int n = 0; n < L_x; n++) {
+				sum += conv[n] * promoted_type(row[index[n]]);
 			}
+			row_tmp[x] = sum;
 		}
-		for (int y = 0; y < _height; y++) {
-			sum = T();
-			for (int n = 0; n < L; n++) {
-				sum += conv[n] * this->get_mirror(int(floor(dx)) + n - L_center, y);
+	}
+	// Vertical convolution (accumulated in the strip buffer of promoted_type if the pixels are promoted)
+	const bool Promoted = std::is_same<T, promoted_type>::value == false;
+	int strip_width = int(Strip_Bytes / (sizeof(promoted_type) * size_t(L_y)));
+	if (strip_width < 64) {
+		strip_width = 64;
+	}
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		std::vector<promoted_type> strip(Promoted ? size_t(std::min(strip_width, Width)) : 0);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for (int y = 0; y < Height; y++) {
+			const int* index = index_y + size_t(L_y) * size_t(y);
+			const typename ImgScalar<T>::type* conv = conv_y + size_t(L_y) * size_t(y);
+			T* row_resized = resized + size_t(Width) * size_t(y);
+			for (int x_strip = 0; x_strip < Width; x_strip += strip_width) {
+				int x_end = std::min(x_strip + strip_width, Width);
+				promoted_type* sum = Promoted ? strip.data() : reinterpret_cast<promoted_type*>(row_resized + x_strip);
+				for (int x = x_strip; x < x_end; x++) {
+					sum[x - x_strip] = promoted_type();
+				}
+				for (int m = 0; m < L_y; m++) {
+					const promoted_type* row_tmp = tmp + size_t(Width) * size_t(index[m]);
+					for (int x = x_strip; x < x_end; x++) {
+						sum[x - x_strip] += conv[m] * row_tmp[x];
+					}
+				}
+				if (Promoted) {
+					for (int x = x_strip; x < x_end; x++) {
+						row_resized[x] = ImgPromote<T>::demote(sum[x - x_strip]);
+					}
+				}
+				if (Saturater != nullptr || Nearest_Integer_Method != nullptr) {
+					for (int x = x_strip; x < x_end; x++) {
+						if (Saturater != nullptr) {
+							row_resized[x] = Saturater(row_resized[x]);
+						}
+						if (Nearest_Integer_Method != nullptr) {
+							row_resized[x] = Nearest_Integer_Method(row_resized[x]);
+						}
+					}
+				}
 			}
-			Tmp.at(x, y) = sum;
 		}
 	}
-	// Vertical convolution
-	if (scale_y >= 1.0) {
-		scale_conv = 1.0;
-		L = 4;
-		L_center = int(floor((L - 1.0) / 2.0));
-	} else {
-		scale_conv = 1.0 / scale_y;
-		L = 4 * int(ceil(scale_conv));
-		L_center = int(floor((L - 1.0) / 2.0));
-	}
-	for (int y = 0; y < Height; y++) {
-		if (scale_y >= 1.0) {
-			dy = (y - (scale_y - 1.0) / 2.0) / scale_y;
-			for (int m = 0; m < L; m++) {
-				conv[m] = ImgVector<T>::cubic(double(m - L_center) - (dy - floor(dy)), B, C);
+	delete[] tmp;
+	delete[] index_x;
+	delete[] index_y;
+	delete[] conv_x;
+	delete[] conv_y;
+	this->deallocate();
+	_data = resized;
+	_reserved_size = size_t(Width) * size_t(Height);
+	_width = Width;
+	_height = Height;
+}
+
+
+/*
+    void ImgVector<T>::kernel_taps(int* index, typename ImgScalar<T>::type* weight, int L, int src_length, int dst_length, const ImgKernel& kernel)
+    Compute the source indices (mirrored on the boundary) and the weights of the convolution
+    for each output sample. index[L * i + n] and weight[L * i + n] are the n-th tap of i-th output.
+    The weights are computed in double and stored in the scalar type of T.
+*/
+template <class T>
+void
+ImgVector<T>::kernel_taps(int* index, typename ImgScalar<T>::type* weight, const int L, const int src_length, const int dst_length, const ImgKernel& kernel) const
+{
+	const double scale = double(dst_length) / src_length;
+	const int L_center = int(floor((L - 1.0) / 2.0));
+
+	for (int i = 0; i < dst_length; i++) {
+		double d;
+		typename ImgScalar<T>::type* weight_i = weight + size_t(L) * size_t(i);
+		if (scale >= 1.0) {
+			d = (i - (scale - 1.0) / 2.0) / scale;
+			for (int n = 0; n < L; n++) {
+				weight_i[n] = typename ImgScalar<T>::type(kernel(double(n - L_center) - (d - floor(d))));
 			}
 		} else {
-			dy = y / scale_y + (1.0 / scale_y - 1.0) / 2.0;
-			for (int m = 0; m < L; m++) {
-				conv[m] = ImgVector<T>::cubic((double(m - L_center) - (dy - floor(dy))) / scale_conv, B, C) / scale_conv;
+			d = i / scale + (1.0 / scale - 1.0) / 2.0;
+			for (int n = 0; n < L; n++) {
+				weight_i[n] = typename ImgScalar<T>::type(kernel((double(n - L_center) - (d - floor(d))) * scale) * scale);
 			}
 		}
-		for (int x = 0; x < Width; x++) {
-			sum = T();
-			for (int m = 0; m < L; m++) {
-				sum += conv[m] * Tmp.get_mirror(x, int(floor(dy)) + m - L_center);
+		if (kernel.normalized()) {
+			typename ImgScalar<T>::type sum = 0;
+			for (int n = 0; n < L; n++) {
+				sum += weight_i[n];
 			}
-			if (Saturater != nullptr) {
-				sum = Saturater(sum);
+			for (int n = 0; n < L; n++) {
+				weight_i[n] /= sum;
 			}
-			if (Nearest_Integer_Method != nullptr) {
-				sum = Nearest_Integer_Method(sum);
+		}
+		for (int n = 0; n < L; n++) {
+			int m = int(floor(d)) + n - L_center;
+			if (m < 0) {
+				m = -m - 1; // should be set the offset when Mirroring over negative
 			}
-			resized[size_t(Width) * size_t(y) + size_t(x)] = sum;
+			index[size_t(L) * size_t(i) + size_t(n)] = int(round(src_length - 0.5 - std::fabs(src_length - 0.5 - (m % (2 * src_length)))));
 		}
 	}
-	delete[] conv;
-	delete[] _data;
-	_data = resized;
-	_width = Width;
-	_height = Height;
 }
 
 
@@ -1131,87 +2339,153 @@ template <class T>
 double
 ImgVector<T>::cubic(const double x, const double B, const double C) const
 {
-	double x_abs = fabs(x);
+	return ImgKernel::cubic(x, B, C);
+}
 
-	if (x_abs <= 1.0) {
-		return ((2.0 - 1.5 * B - C) * x_abs + (-3.0 + 2.0 * B + C)) * x_abs * x_abs + 1.0 - B / 3.0;
-	} else if (x_abs < 2.0) {
-		return (((-B / 6.0 - C) * x_abs + B + 5.0 * C) * x_abs - 2.0 * B - 8.0 * C) * x_abs + 8.0 / 6.0 * B + 4.0 * C;
-	} else {
-		return 0.0;
+
+/*
+ * Weights of the 2 * radius taps at the offsets 1 - radius, ..., radius from floor(x) (fraction = x - floor(x)).
+ */
+template <class T>
+void
+ImgVector<T>::kernel_weights(typename ImgScalar<T>::type* weight, const double fraction, const ImgKernel& kernel) const
+{
+	const int R = kernel.radius();
+	double weight_kernel[2 * ImgKernel::MaxRadius];
+
+	kernel.weights(weight_kernel, fraction);
+	for (int n = 0; n < 2 * R; n++) {
+		weight[n] = typename ImgScalar<T>::type(weight_kernel[n]);
+	}
+	if (kernel.normalized()) {
+		typename ImgScalar<T>::type sum = 0;
+		for (int n = 0; n < 2 * R; n++) {
+			sum += weight[n];
+		}
+		for (int n = 0; n < 2 * R; n++) {
+			weight[n] /= sum;
+		}
 	}
 }
 
 
+/*
+ * The function pointer is called serially in raster order since it may not be reentrant.
+ */
 template <class T>
 template <class RT>
 void
 ImgVector<T>::saturate(T (*func)(const T& value, const RT& min, const RT& max), const RT& min, const RT& max)
 {
 	if (func != nullptr) {
+		this->unshare();
 		for (size_t i = 0 ; i < this->size(); i++) {
 			_data[i] = func(_data[i], min, max);
 		}
 	}
 }
 
+/*
+ * Saturate the pixels by the callable func(value, min, max).
+ * The callable (e.g. lambda) is inlined into the loop over the chunks of ImgParallel, so it is called from multiple threads.
+ */
+template <class T>
+template <class F, class RT, class>
+void
+ImgVector<T>::saturate(F func, const RT& min, const RT& max)
+{
+	this->unshare();
+	T* data = _data;
+	ImgParallel::for_each(this->size(), [data, &func, &min, &max](const size_t begin, const size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			data[i] = func(data[i], min, max);
+		}
+	});
+}
+
 
+/*
+ * The function pointer is called serially in raster order since it may not be reentrant.
+ */
 template <class T>
 void
 ImgVector<T>::map(T (*func)(T &value))
 {
 	if (func != nullptr) {
-		for (size_t i = 0 ; i < size_t(_width) * size_t(_height); i++) {
+		this->unshare();
+		for (size_t i = 0 ; i < this->size(); i++) {
 			_data[i] = func(_data[i]);
 		}
 	}
 }
 
+/*
+ * Map the pixels by the callable func(value).
+ * The callable (e.g. lambda) is inlined into the loop over the chunks of ImgParallel, so it is called from multiple threads.
+ */
+template <class T>
+template <class F, class>
+void
+ImgVector<T>::map(F func)
+{
+	this->unshare();
+	T* data = _data;
+	ImgParallel::for_each(this->size(), [data, &func](const size_t begin, const size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			data[i] = func(data[i]);
+		}
+	});
+}
+
 
 
 
 // ----- Arithmetic Operators -----
+/*
+ * The operand can be a scalar, ImgVector or an expression (e.g. image += 0.5 * (prev + next)).
+ * The whole right hand side is evaluated with *this in a single pass.
+ */
 template <class T>
 template <class RT>
 ImgVector<T> &
-ImgVector<T>::operator+=(const RT& val)
+ImgVector<T>::operator+=(const RT& rvalue)
 {
-	for (size_t i = 0; i < size_t(_width) * size_t(_height); i++) {
-		_data[i] += val;
-	}
+	typedef typename ImgExpressionOperand<RT>::type Expression;
+	this->evaluate(ImgExpressionOperand<RT>::wrap(rvalue),
+	    [](T& value, const typename Expression::value_type& rvalue) { value += rvalue; });
 	return *this;
 }
 
 template <class T>
 template <class RT>
 ImgVector<T> &
-ImgVector<T>::operator-=(const RT& val)
+ImgVector<T>::operator-=(const RT& rvalue)
 {
-	for (size_t i = 0; i < size_t(_width) * size_t(_height); i++) {
-		_data[i] -= val;
-	}
+	typedef typename ImgExpressionOperand<RT>::type Expression;
+	this->evaluate(ImgExpressionOperand<RT>::wrap(rvalue),
+	    [](T& value, const typename Expression::value_type& rvalue) { value -= rvalue; });
 	return *this;
 }
 
 template <class T>
 template <class RT>
 ImgVector<T> &
-ImgVector<T>::operator*=(const RT& val)
+ImgVector<T>::operator*=(const RT& rvalue)
 {
-	for (size_t i = 0; i < size_t(_width) * size_t(_height); i++) {
-		_data[i] *= val;
-	}
+	typedef typename ImgExpressionOperand<RT>::type Expression;
+	this->evaluate(ImgExpressionOperand<RT>::wrap(rvalue),
+	    [](T& value, const typename Expression::value_type& rvalue) { value *= rvalue; });
 	return *this;
 }
 
 template <class T>
 template <class RT>
 ImgVector<T> &
-ImgVector<T>::operator/=(const RT& val)
+ImgVector<T>::operator/=(const RT& rvalue)
 {
-	for (size_t i = 0; i < size_t(_width) * size_t(_height); i++) {
-		_data[i] /= val;
-	}
+	typedef typename ImgExpressionOperand<RT>::type Expression;
+	this->evaluate(ImgExpressionOperand<RT>::wrap(rvalue),
+	    [](T& value, const typename Expression::value_type& rvalue) { value /= rvalue; });
 	return *this;
 }
 
@@ -1223,14 +2497,13 @@ template <class RT>
 ImgVector<T> &
 ImgVector<T>::operator+=(const ImgVector<RT>& rvector)
 {
-	if (_width != rvector._width
-	    || _height != rvector._height) {
+	if (_width != rvector.width()
+	    || _height != rvector.height()) {
 		std::cerr << "ImgVector<T>& ImgVector<T>::operator+=(const ImgVector<T>&) : Size of const ImgVector<T>& rvalue is not match" << std::endl;
 		throw std::invalid_argument("Size of const ImgVector<T>& rvalue is not match");
 	}
-	for (size_t i = 0; i < size_t(_width) * size_t(_height); i++) {
-		_data[i] += rvector._data[i];
-	}
+	this->evaluate(ImgExpressionVector<RT>(rvector),
+	    [](T& value, const RT& rvalue) { value += rvalue; });
 	return *this;
 }
 
@@ -1239,14 +2512,13 @@ template <class RT>
 ImgVector<T> &
 ImgVector<T>::operator-=(const ImgVector<RT>& rvector)
 {
-	if (_width != rvector._width
-	    || _height != rvector._height) {
+	if (_width != rvector.width()
+	    || _height != rvector.height()) {
 		std::cerr << "ImgVector<T>& ImgVector<T>::operator-=(const ImgVector<T>&) : Size of const ImgVector<T>& rvalue is not match" << std::endl;
 		throw std::invalid_argument("Size of const ImgVector<T>& rvalue is not match");
 	}
-	for (size_t i = 0; i < size_t(_width) * size_t(_height); i++) {
-		_data[i] -= rvector._data[i];
-	}
+	this->evaluate(ImgExpressionVector<RT>(rvector),
+	    [](T& value, const RT& rvalue) { value -= rvalue; });
 	return *this;
 }
 
@@ -1255,14 +2527,13 @@ template <class RT>
 ImgVector<T> &
 ImgVector<T>::operator*=(const ImgVector<RT>& rvector)
 {
-	if (_width != rvector._width
-	    || _height != rvector._height) {
+	if (_width != rvector.width()
+	    || _height != rvector.height()) {
 		std::cerr << "ImgVector<T>& ImgVector<T>::operator*=(const ImgVector<T>&) : Size of const ImgVector<T>& rvalue is not match" << std::endl;
 		throw std::invalid_argument("Size of const ImgVector<T>& rvalue is not match");
 	}
-	for (size_t i = 0; i < size_t(_width) * size_t(_height); i++) {
-		_data[i] *= rvector._data[i];
-	}
+	this->evaluate(ImgExpressionVector<RT>(rvector),
+	    [](T& value, const RT& rvalue) { value *= rvalue; });
 	return *this;
 }
 
@@ -1271,14 +2542,13 @@ template <class RT>
 ImgVector<T> &
 ImgVector<T>::operator/=(const ImgVector<RT>& rvector)
 {
-	if (_width != rvector._width
-	    || _height != rvector._height) {
+	if (_width != rvector.width()
+	    || _height != rvector.height()) {
 		std::cerr << "ImgVector<T>& ImgVector<T>::operator/=(const ImgVector<T>&) : Size of const ImgVector<T>& rvalue is not match" << std::endl;
 		throw std::invalid_argument("Size of const ImgVector<T>& rvalue is not match");
 	}
-	for (size_t i = 0; i < size_t(_width) * size_t(_height); i++) {
-		_data[i] /= rvector._data[i];
-	}
+	this->evaluate(ImgExpressionVector<RT>(rvector),
+	    [](T& value, const RT& rvalue) { value /= rvalue; });
 	return *this;
 }
 
@@ -0,0 +1,36 @@
+#ifndef LIB_ImgClass_ImgDisjointSet
+#define LIB_ImgClass_ImgDisjointSet
+
+#include <cstddef>
+#include <vector>
+
+/* Disjoint set (union-find) of the indices 0, ..., size() - 1
+ *
+ * The root of each set is its smallest index, so the sets of the pixels or the regions numbered in raster order
+ * are represented by their first element in raster order.
+ * find() compresses the path by halving.
+ * find() and unite() on the indices in disjoint ranges can run on different threads if the sets do not cross the ranges.
+ */
+class ImgDisjointSet
+{
+	private:
+		std::vector<size_t> _parent;
+
+	public:
+		ImgDisjointSet(void);
+		explicit ImgDisjointSet(const size_t size);
+
+		void reset(const size_t size);
+		size_t add(void); // Add a new set and return its index
+
+		size_t size(void) const;
+		size_t find(size_t n);
+		size_t root(size_t n) const; // find() without the path compression (the threads can share it)
+		size_t unite(const size_t a, const size_t b); // Return the root of the united set
+		bool is_root(const size_t n) const;
+};
+
+#include "ImgDisjointSet_private.h"
+
+#endif
+
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <new>
+
+
+
+
+// ----- Constructor -----
+inline
+ImgDisjointSet::ImgDisjointSet(void)
+{
+}
+
+inline
+ImgDisjointSet::ImgDisjointSet(const size_t size)
+{
+	this->reset(size);
+}
+
+
+inline void
+ImgDisjointSet::reset(const size_t size)
+{
+	try {
+		_parent.resize(size);
+	}
+	catch (const std::bad_alloc& bad) {
+		std::cerr << bad.what() << std::endl
+		    << "void ImgDisjointSet::reset(const size_t) : Cannot Allocate Memory" << std::endl;
+		throw;
+	}
+	for (size_t n = 0; n < size; n++) {
+		_parent[n] = n;
+	}
+}
+
+inline size_t
+ImgDisjointSet::add(void)
+{
+	_parent.push_back(_parent.size());
+	return _parent.size() - 1;
+}
+
+
+
+
+// ----- Accessor -----
+inline size_t
+ImgDisjointSet::size(void) const
+{
+	return _parent.size();
+}
+
+inline size_t
+ImgDisjointSet::find(size_t n)
+{
+	while (_parent[n] != n) {
+		_parent[n] = _parent[_parent[n]];
+		n = _parent[n];
+	}
+	return n;
+}
+
+inline size_t
+ImgDisjointSet::root(size_t n) const
+{
+	while (_parent[n] != n) {
+		n = _parent[n];
+	}
+	return n;
+}
+
+inline size_t
+ImgDisjointSet::unite(const size_t a, const size_t b)
+{
+	size_t root_a = this->find(a);
+	size_t root_b = this->find(b);
+	if (root_a < root_b) {
+		_parent[root_b] = root_a;
+		return root_a;
+	} else {
+		_parent[root_a] = root_b;
+		return root_b;
+	}
+}
+
+inline bool
+ImgDisjointSet::is_root(const size_t n) const
+{
+	return _parent[n] == n;
+}
+
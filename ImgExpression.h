@@ -0,0 +1,218 @@
+#ifndef LIB_ImgClass_ImgExpression
+#define LIB_ImgClass_ImgExpression
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+template <class T> class ImgVector;
+
+/* Lazy arithmetic expression of ImgVector
+ *
+ * The operators +, -, * and / on ImgVector (and on the expressions) do not compute anything.
+ * They build the tree of the expression and the whole tree is evaluated pixel by pixel
+ * in a single pass when it is assigned to ImgVector, e.g.
+ *
+ *	ImgVector<double> normalized = (image - mean) / stddev * gain;
+ *	image = 0.5 * (image + image_next);
+ *
+ * The operands are ImgVector<T> of any T and the scalars (numbers or colors), which are broadcast to all pixels.
+ * The expression refers ImgVector operands, so it should not be stored beyond the statement.
+ */
+template <class E>
+class ImgExpression
+{
+	public:
+		const E& derived(void) const;
+};
+
+
+// Leaf of ImgVector
+template <class T>
+class ImgExpressionVector : public ImgExpression<ImgExpressionVector<T> >
+{
+	private:
+		const T* _data;
+		int _width;
+		int _height;
+
+	public:
+		typedef T value_type;
+		static const bool Broadcast = false;
+
+		explicit ImgExpressionVector(const ImgVector<T>& vector);
+
+		int width(void) const;
+		int height(void) const;
+		const T& operator[](const size_t n) const;
+};
+
+// Leaf of scalar broadcast to all pixels
+template <class S>
+class ImgExpressionScalar : public ImgExpression<ImgExpressionScalar<S> >
+{
+	private:
+		S _value;
+
+	public:
+		typedef S value_type;
+		static const bool Broadcast = true;
+
+		explicit ImgExpressionScalar(const S& value);
+
+		int width(void) const;
+		int height(void) const;
+		const S& operator[](const size_t n) const;
+};
+
+// Node of binary operator
+template <class Op, class L, class R>
+class ImgExpressionBinary : public ImgExpression<ImgExpressionBinary<Op, L, R> >
+{
+	private:
+		L _lvalue;
+		R _rvalue;
+		int _width;
+		int _height;
+
+	public:
+		typedef typename std::remove_cv<decltype(Op::apply(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()))>::type value_type;
+		static const bool Broadcast = L::Broadcast && R::Broadcast;
+
+		ImgExpressionBinary(const L& lvalue, const R& rvalue); // throw std::invalid_argument if the sizes are not match
+
+		int width(void) const;
+		int height(void) const;
+		value_type operator[](const size_t n) const;
+};
+
+// Node of unary operator
+template <class Op, class E>
+class ImgExpressionUnary : public ImgExpression<ImgExpressionUnary<Op, E> >
+{
+	private:
+		E _value;
+
+	public:
+		typedef typename std::remove_cv<decltype(Op::apply(std::declval<typename E::value_type>()))>::type value_type;
+		static const bool Broadcast = E::Broadcast;
+
+		explicit ImgExpressionUnary(const E& value);
+
+		int width(void) const;
+		int height(void) const;
+		value_type operator[](const size_t n) const;
+};
+
+
+// Operations on the pixel
+struct ImgOperatorPlus
+{
+	template <class LT, class RT>
+	static auto apply(const LT& lvalue, const RT& rvalue) -> decltype(lvalue + rvalue);
+};
+
+struct ImgOperatorMinus
+{
+	template <class LT, class RT>
+	static auto apply(const LT& lvalue, const RT& rvalue) -> decltype(lvalue - rvalue);
+};
+
+struct ImgOperatorMultiplies
+{
+	template <class LT, class RT>
+	static auto apply(const LT& lvalue, const RT& rvalue) -> decltype(lvalue * rvalue);
+};
+
+struct ImgOperatorDivides
+{
+	template <class LT, class RT>
+	static auto apply(const LT& lvalue, const RT& rvalue) -> decltype(lvalue / rvalue);
+};
+
+struct ImgOperatorNegate
+{
+	template <class VT>
+	static auto apply(const VT& value) -> decltype(-value);
+};
+
+
+/* Operand of the expression
+ *
+ * ImgVector and the expressions are the image operands, the others are broadcast as scalars.
+ */
+template <class X>
+struct ImgExpressionOperand
+{
+	typedef ImgExpressionScalar<X> type;
+	static const bool Image = false;
+	static type wrap(const X& value);
+};
+
+template <class T>
+struct ImgExpressionOperand<ImgVector<T> >
+{
+	typedef ImgExpressionVector<T> type;
+	static const bool Image = true;
+	static type wrap(const ImgVector<T>& vector);
+};
+
+template <class T>
+struct ImgExpressionOperand<ImgExpressionVector<T> >
+{
+	typedef ImgExpressionVector<T> type;
+	static const bool Image = true;
+	static const type& wrap(const type& expression);
+};
+
+template <class S>
+struct ImgExpressionOperand<ImgExpressionScalar<S> >
+{
+	typedef ImgExpressionScalar<S> type;
+	static const bool Image = false;
+	static const type& wrap(const type& expression);
+};
+
+template <class Op, class L, class R>
+struct ImgExpressionOperand<ImgExpressionBinary<Op, L, R> >
+{
+	typedef ImgExpressionBinary<Op, L, R> type;
+	static const bool Image = true;
+	static const type& wrap(const type& expression);
+};
+
+template <class Op, class E>
+struct ImgExpressionOperand<ImgExpressionUnary<Op, E> >
+{
+	typedef ImgExpressionUnary<Op, E> type;
+	static const bool Image = true;
+	static const type& wrap(const type& expression);
+};
+
+// Result type of the binary operator (SFINAE : at least one operand should be the image)
+template <class Op, class L, class R>
+struct ImgExpressionResult
+    : std::enable_if<ImgExpressionOperand<L>::Image || ImgExpressionOperand<R>::Image,
+    ImgExpressionBinary<Op, typename ImgExpressionOperand<L>::type, typename ImgExpressionOperand<R>::type> >
+{
+};
+
+
+template <class L, class R>
+typename ImgExpressionResult<ImgOperatorPlus, L, R>::type operator+(const L& lvalue, const R& rvalue);
+template <class L, class R>
+typename ImgExpressionResult<ImgOperatorMinus, L, R>::type operator-(const L& lvalue, const R& rvalue);
+template <class L, class R>
+typename ImgExpressionResult<ImgOperatorMultiplies, L, R>::type operator*(const L& lvalue, const R& rvalue);
+template <class L, class R>
+typename ImgExpressionResult<ImgOperatorDivides, L, R>::type operator/(const L& lvalue, const R& rvalue);
+
+template <class E>
+typename std::enable_if<ImgExpressionOperand<E>::Image,
+    ImgExpressionUnary<ImgOperatorNegate, typename ImgExpressionOperand<E>::type> >::type
+operator-(const E& value);
+
+#include "ImgExpression_private.h"
+
+#endif
+
@@ -0,0 +1,284 @@
+#include <stdexcept>
+
+
+
+
+template <class E>
+const E &
+ImgExpression<E>::derived(void) const
+{
+	return static_cast<const E&>(*this);
+}
+
+
+
+
+// ----- Leaf of ImgVector -----
+template <class T>
+ImgExpressionVector<T>::ImgExpressionVector(const ImgVector<T>& vector)
+{
+	_data = vector.data();
+	_width = vector.width();
+	_height = vector.height();
+}
+
+template <class T>
+int
+ImgExpressionVector<T>::width(void) const
+{
+	return _width;
+}
+
+template <class T>
+int
+ImgExpressionVector<T>::height(void) const
+{
+	return _height;
+}
+
+template <class T>
+const T &
+ImgExpressionVector<T>::operator[](const size_t n) const
+{
+	return _data[n];
+}
+
+
+
+
+// ----- Leaf of scalar -----
+template <class S>
+ImgExpressionScalar<S>::ImgExpressionScalar(const S& value)
+    : _value(value)
+{
+}
+
+template <class S>
+int
+ImgExpressionScalar<S>::width(void) const
+{
+	return 0;
+}
+
+template <class S>
+int
+ImgExpressionScalar<S>::height(void) const
+{
+	return 0;
+}
+
+template <class S>
+const S &
+ImgExpressionScalar<S>::operator[](const size_t) const
+{
+	return _value;
+}
+
+
+
+
+// ----- Node of binary operator -----
+template <class Op, class L, class R>
+ImgExpressionBinary<Op, L, R>::ImgExpressionBinary(const L& lvalue, const R& rvalue)
+    : _lvalue(lvalue), _rvalue(rvalue)
+{
+	if (L::Broadcast) {
+		_width = rvalue.width();
+		_height = rvalue.height();
+	} else {
+		if (R::Broadcast == false
+		    && (lvalue.width() != rvalue.width() || lvalue.height() != rvalue.height())) {
+			throw std::invalid_argument("ImgExpressionBinary<Op, L, R>::ImgExpressionBinary(const L&, const R&) : Size of the operands is not match");
+		}
+		_width = lvalue.width();
+		_height = lvalue.height();
+	}
+}
+
+template <class Op, class L, class R>
+int
+ImgExpressionBinary<Op, L, R>::width(void) const
+{
+	return _width;
+}
+
+template <class Op, class L, class R>
+int
+ImgExpressionBinary<Op, L, R>::height(void) const
+{
+	return _height;
+}
+
+template <class Op, class L, class R>
+typename ImgExpressionBinary<Op, L, R>::value_type
+ImgExpressionBinary<Op, L, R>::operator[](const size_t n) const
+{
+	return Op::apply(_lvalue[n], _rvalue[n]);
+}
+
+
+
+
+// ----- Node of unary operator -----
+template <class Op, class E>
+ImgExpressionUnary<Op, E>::ImgExpressionUnary(const E& value)
+    : _value(value)
+{
+}
+
+template <class Op, class E>
+int
+ImgExpressionUnary<Op, E>::width(void) const
+{
+	return _value.width();
+}
+
+template <class Op, class E>
+int
+ImgExpressionUnary<Op, E>::height(void) const
+{
+	return _value.height();
+}
+
+template <class Op, class E>
+typename ImgExpressionUnary<Op, E>::value_type
+ImgExpressionUnary<Op, E>::operator[](const size_t n) const
+{
+	return Op::apply(_value[n]);
+}
+
+
+
+
+// ----- Operations -----
+template <class LT, class RT>
+auto
+ImgOperatorPlus::apply(const LT& lvalue, const RT& rvalue) -> decltype(lvalue + rvalue)
+{
+	return lvalue + rvalue;
+}
+
+template <class LT, class RT>
+auto
+ImgOperatorMinus::apply(const LT& lvalue, const RT& rvalue) -> decltype(lvalue - rvalue)
+{
+	return lvalue - rvalue;
+}
+
+template <class LT, class RT>
+auto
+ImgOperatorMultiplies::apply(const LT& lvalue, const RT& rvalue) -> decltype(lvalue * rvalue)
+{
+	return lvalue * rvalue;
+}
+
+template <class LT, class RT>
+auto
+ImgOperatorDivides::apply(const LT& lvalue, const RT& rvalue) -> decltype(lvalue / rvalue)
+{
+	return lvalue / rvalue;
+}
+
+template <class VT>
+auto
+ImgOperatorNegate::apply(const VT& value) -> decltype(-value)
+{
+	return -value;
+}
+
+
+
+
+// ----- Operands -----
+template <class X>
+typename ImgExpressionOperand<X>::type
+ImgExpressionOperand<X>::wrap(const X& value)
+{
+	return type(value);
+}
+
+template <class T>
+typename ImgExpressionOperand<ImgVector<T> >::type
+ImgExpressionOperand<ImgVector<T> >::wrap(const ImgVector<T>& vector)
+{
+	return type(vector);
+}
+
+template <class T>
+const typename ImgExpressionOperand<ImgExpressionVector<T> >::type &
+ImgExpressionOperand<ImgExpressionVector<T> >::wrap(const type& expression)
+{
+	return expression;
+}
+
+template <class S>
+const typename ImgExpressionOperand<ImgExpressionScalar<S> >::type &
+ImgExpressionOperand<ImgExpressionScalar<S> >::wrap(const type& expression)
+{
+	return expression;
+}
+
+template <class Op, class L, class R>
+const typename ImgExpressionOperand<ImgExpressionBinary<Op, L, R> >::type &
+ImgExpressionOperand<ImgExpressionBinary<Op, L, R> >::wrap(const type& expression)
+{
+	return expression;
+}
+
+template <class Op, class E>
+const typename ImgExpressionOperand<ImgExpressionUnary<Op, E> >::type &
+ImgExpressionOperand<ImgExpressionUnary<Op, E> >::wrap(const type& expression)
+{
+	return expression;
+}
+
+
+
+
+// ----- Operators -----
+template <class L, class R>
+typename ImgExpressionResult<ImgOperatorPlus, L, R>::type
+operator+(const L& lvalue, const R& rvalue)
+{
+	return typename ImgExpressionResult<ImgOperatorPlus, L, R>::type(
+	    ImgExpressionOperand<L>::wrap(lvalue),
+	    ImgExpressionOperand<R>::wrap(rvalue));
+}
+
+template <class L, class R>
+typename ImgExpressionResult<ImgOperatorMinus, L, R>::type
+operator-(const L& lvalue, const R& rvalue)
+{
+	return typename ImgExpressionResult<ImgOperatorMinus, L, R>::type(
+	    ImgExpressionOperand<L>::wrap(lvalue),
+	    ImgExpressionOperand<R>::wrap(rvalue));
+}
+
+template <class L, class R>
+typename ImgExpressionResult<ImgOperatorMultiplies, L, R>::type
+operator*(const L& lvalue, const R& rvalue)
+{
+	return typename ImgExpressionResult<ImgOperatorMultiplies, L, R>::type(
+	    ImgExpressionOperand<L>::wrap(lvalue),
+	    ImgExpressionOperand<R>::wrap(rvalue));
+}
+
+template <class L, class R>
+typename ImgExpressionResult<ImgOperatorDivides, L, R>::type
+operator/(const L& lvalue, const R& rvalue)
+{
+	return typename ImgExpressionResult<ImgOperatorDivides, L, R>::type(
+	    ImgExpressionOperand<L>::wrap(lvalue),
+	    ImgExpressionOperand<R>::wrap(rvalue));
+}
+
+
+template <class E>
+typename std::enable_if<ImgExpressionOperand<E>::Image,
+    ImgExpressionUnary<ImgOperatorNegate, typename ImgExpressionOperand<E>::type> >::type
+operator-(const E& value)
+{
+	return ImgExpressionUnary<ImgOperatorNegate, typename ImgExpressionOperand<E>::type>(
+	    ImgExpressionOperand<E>::wrap(value));
+}
+
@@ -0,0 +1,53 @@
+#ifndef LIB_ImgClass_ImgHalf
+#define LIB_ImgClass_ImgHalf
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ImgClass.h"
+
+namespace ImgClass {
+	/* IEEE 754 half precision (binary16) storage of the intensity
+	 *
+	 * The value is stored in 2 bytes and it is promoted to float for the arithmetic (ImgPromote<half>).
+	 * The conversion from float is rounded to nearest even and the overflow becomes infinity.
+	 */
+	class half
+	{
+		private:
+			uint16_t _bits;
+
+		public:
+			half(void);
+			half(const float value);
+
+			operator float(void) const;
+
+			uint16_t bits(void) const;
+			static half from_bits(const uint16_t bits);
+
+			static uint16_t float_to_bits(const float value);
+			static float bits_to_float(const uint16_t bits);
+	};
+
+	// Bulk converters (F16C is used if available)
+	void half_to_float(const half* src, float* dst, const size_t n);
+	void float_to_half(const float* src, half* dst, const size_t n);
+}
+
+template <>
+struct ImgConvert<float, ImgClass::half>
+{
+	static void convert(const ImgClass::half* src, float* dst, const size_t n);
+};
+
+template <>
+struct ImgConvert<ImgClass::half, float>
+{
+	static void convert(const float* src, ImgClass::half* dst, const size_t n);
+};
+
+#include "ImgHalf_private.h"
+
+#endif
+
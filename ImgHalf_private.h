@@ -0,0 +1,167 @@
+#include <cstring>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+
+
+
+namespace ImgClass {
+	// ----- Constructor -----
+	inline
+	half::half(void)
+	{
+		_bits = 0;
+	}
+
+	inline
+	half::half(const float value)
+	{
+		_bits = half::float_to_bits(value);
+	}
+
+
+	inline
+	half::operator float(void) const
+	{
+		return half::bits_to_float(_bits);
+	}
+
+
+	inline uint16_t
+	half::bits(void) const
+	{
+		return _bits;
+	}
+
+	inline half
+	half::from_bits(const uint16_t bits)
+	{
+		half value;
+		value._bits = bits;
+		return value;
+	}
+
+
+
+
+	// ----- Conversion -----
+	/*
+	 * Round float to nearest even half.
+	 * The subnormal halves are rounded by the addition of float (the hardware rounding of float).
+	 */
+	inline uint16_t
+	half::float_to_bits(const float value)
+	{
+		const uint32_t Infinity = 255u << 23;
+		const uint32_t Half_Max = (127u + 16u) << 23; // 2^16 (the values larger than 65519.99 overflow)
+		const uint32_t Denormal_Magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+		uint32_t x;
+		uint16_t bits;
+
+		memcpy(&x, &value, sizeof(x));
+		const uint32_t sign = x & 0x80000000u;
+		x ^= sign;
+		if (x >= Half_Max) { // Overflow, infinity or NaN
+			bits = x > Infinity ? uint16_t(0x7E00u | ((x & 0x7FFFFFu) >> 13)) : 0x7C00; // Quiet NaN keeps the upper bits of the payload as F16C
+		} else if (x < (113u << 23)) { // Subnormal or zero
+			float magic;
+			float f;
+			memcpy(&magic, &Denormal_Magic, sizeof(magic));
+			memcpy(&f, &x, sizeof(f));
+			f += magic;
+			memcpy(&x, &f, sizeof(x));
+			bits = uint16_t(x - Denormal_Magic);
+		} else {
+			const uint32_t odd = (x >> 13) & 1u;
+			x -= (127u - 15u) << 23; // Rebias the exponent
+			x += 0xFFFu + odd; // Round to nearest even
+			bits = uint16_t(x >> 13);
+		}
+		return uint16_t(bits | (sign >> 16));
+	}
+
+	inline float
+	half::bits_to_float(const uint16_t bits)
+	{
+		const uint32_t Exponent = 0x7C00u << 13;
+		uint32_t x = uint32_t(bits & 0x7FFFu) << 13;
+		const uint32_t exponent = x & Exponent;
+		float value;
+
+		x += (127u - 15u) << 23; // Rebias the exponent
+		if (exponent == Exponent) { // Infinity or NaN
+			x += (128u - 16u) << 23;
+			if ((x & 0x7FFFFFu) != 0) { // NaN is quieted as F16C
+				x |= 1u << 22;
+			}
+		} else if (exponent == 0) { // Subnormal or zero
+			const uint32_t Magic = 113u << 23;
+			float magic;
+			x += 1u << 23;
+			memcpy(&value, &x, sizeof(value));
+			memcpy(&magic, &Magic, sizeof(magic));
+			value -= magic;
+			memcpy(&x, &value, sizeof(x));
+		}
+		x |= uint32_t(bits & 0x8000u) << 16;
+		memcpy(&value, &x, sizeof(value));
+		return value;
+	}
+
+
+	inline void
+	half_to_float(const half* src, float* dst, const size_t n)
+	{
+		static_assert(sizeof(half) == sizeof(uint16_t), "half should be 2 bytes");
+		size_t i = 0;
+#if defined(__F16C__)
+		for (; i + 8 <= n; i += 8) {
+			__m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(bits));
+		}
+#endif
+		for (; i < n; i++) {
+			dst[i] = half::bits_to_float(src[i].bits());
+		}
+	}
+
+	inline void
+	float_to_half(const float* src, half* dst, const size_t n)
+	{
+		size_t i = 0;
+#if defined(__F16C__)
+		for (; i + 8 <= n; i += 8) {
+			__m128i bits = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bits);
+		}
+#endif
+		for (; i < n; i++) {
+			dst[i] = half::from_bits(half::float_to_bits(src[i]));
+		}
+	}
+}
+
+
+
+
+inline ImgClass::half
+ImgPromote<ImgClass::half>::demote(const float value)
+{
+	return ImgClass::half(value);
+}
+
+
+inline void
+ImgConvert<float, ImgClass::half>::convert(const ImgClass::half* src, float* dst, const size_t n)
+{
+	ImgClass::half_to_float(src, dst, n);
+}
+
+inline void
+ImgConvert<ImgClass::half, float>::convert(const float* src, ImgClass::half* dst, const size_t n)
+{
+	ImgClass::float_to_half(src, dst, n);
+}
+
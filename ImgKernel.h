@@ -0,0 +1,54 @@
+#ifndef LIB_ImgClass_ImgKernel
+#define LIB_ImgClass_ImgKernel
+
+/* Separable interpolation kernel
+ *
+ * The kernel is zero for |x| >= radius(), so the interpolation reads 2 * radius() taps on each axis
+ * (bilinear : 2x2, bicubic : 4x4, Lanczos-N : 2N x 2N).
+ * The cheaper kernel can be selected for the stages which tolerate the blur (e.g. coarse levels and previews)
+ * and Lanczos for the final output.
+ * The weights of bilinear and Lanczos are normalized to sum to 1 on each axis
+ * (bicubic is not normalized to keep the results of resample_bicubic() and get_*_cubic()).
+ */
+class ImgKernel
+{
+	public:
+		enum Type {
+			Bilinear,
+			Bicubic,
+			Lanczos
+		};
+		static const int MaxRadius = 4;
+
+	private:
+		Type _type;
+		int _radius;
+		double _B;
+		double _C;
+		double _sin_step; // sin(pi / N) and cos(pi / N) of Lanczos
+		double _cos_step;
+
+	public:
+		ImgKernel(void); // Bicubic (B = 0, C = 0.5)
+
+		static ImgKernel bilinear(void);
+		static ImgKernel bicubic(const double B = 0.0, const double C = (1.0 / 2.0)); // Mitchell-Netravali family (B = 0, C = 0.5 : Catmull-Rom)
+		static ImgKernel lanczos(const int N = 3); // 1 <= N <= MaxRadius
+
+		Type type(void) const;
+		int radius(void) const;
+		double B(void) const;
+		double C(void) const;
+		bool normalized(void) const; // The weights should be divided by their sum
+
+		double operator()(const double x) const; // Weight at the distance x
+		void weights(double* weight, const double fraction) const; // 2 * radius() weights at the offsets 1 - radius(), ..., radius() from floor(x) (fraction = x - floor(x))
+
+		static double cubic(const double x, const double B, const double C);
+		static double lanczos_weight(const double x, const int N);
+};
+
+#include "ImgKernel_private.h"
+
+#endif
+
@@ -0,0 +1,182 @@
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+
+
+
+// ----- Constructor -----
+inline
+ImgKernel::ImgKernel(void)
+{
+	_type = Bicubic;
+	_radius = 2;
+	_B = 0.0;
+	_C = 1.0 / 2.0;
+	_sin_step = 0.0;
+	_cos_step = 1.0;
+}
+
+
+inline ImgKernel
+ImgKernel::bilinear(void)
+{
+	ImgKernel kernel;
+	kernel._type = Bilinear;
+	kernel._radius = 1;
+	return kernel;
+}
+
+inline ImgKernel
+ImgKernel::bicubic(const double B, const double C)
+{
+	ImgKernel kernel;
+	kernel._B = B;
+	kernel._C = C;
+	return kernel;
+}
+
+inline ImgKernel
+ImgKernel::lanczos(const int N)
+{
+	if (N < 1 || N > MaxRadius) {
+		throw std::out_of_range("ImgKernel ImgKernel::lanczos(const int) : int N");
+	}
+	const double Pi = 3.14159265358979323846;
+	ImgKernel kernel;
+	kernel._type = Lanczos;
+	kernel._radius = N;
+	kernel._sin_step = sin(Pi / N);
+	kernel._cos_step = cos(Pi / N);
+	return kernel;
+}
+
+
+
+
+// ----- Accessors -----
+inline ImgKernel::Type
+ImgKernel::type(void) const
+{
+	return _type;
+}
+
+inline int
+ImgKernel::radius(void) const
+{
+	return _radius;
+}
+
+inline double
+ImgKernel::B(void) const
+{
+	return _B;
+}
+
+inline double
+ImgKernel::C(void) const
+{
+	return _C;
+}
+
+inline bool
+ImgKernel::normalized(void) const
+{
+	return _type != Bicubic;
+}
+
+
+
+
+// ----- Weight -----
+inline double
+ImgKernel::operator()(const double x) const
+{
+	switch (_type) {
+		case Bilinear:
+			return std::fabs(x) < 1.0 ? 1.0 - std::fabs(x) : 0.0;
+		case Lanczos:
+			return ImgKernel::lanczos_weight(x, _radius);
+		default:
+			return ImgKernel::cubic(x, _B, _C);
+	}
+}
+
+
+/*
+ * The weights of Lanczos are computed by sin(pi * (k - f)) = -(-1)^k sin(pi * f)
+ * and the rotation of sin(pi * (k - f) / N) by pi / N, so only 3 trigonometric functions are evaluated for all taps.
+ */
+inline void
+ImgKernel::weights(double* weight, const double fraction) const
+{
+	const double Pi = 3.14159265358979323846;
+
+	switch (_type) {
+		case Bilinear:
+			weight[0] = 1.0 - fraction;
+			weight[1] = fraction;
+			break;
+		case Lanczos:
+			{
+				const double sin_pi = sin(Pi * fraction);
+				const double sin_fraction = sin(Pi * fraction / _radius);
+				const double cos_fraction = cos(Pi * fraction / _radius);
+				// sin(pi * x / N) at the first tap x = 1 - N - f (pi * (1 - N) / N = pi / N - pi)
+				double sin_window = _cos_step * sin_fraction - _sin_step * cos_fraction;
+				double cos_window = -_cos_step * cos_fraction - _sin_step * sin_fraction;
+				for (int n = 0; n < 2 * _radius; n++) {
+					const int k = n + 1 - _radius;
+					const double x = k - fraction;
+					if (std::fabs(x) < DBL_EPSILON) {
+						weight[n] = 1.0;
+					} else {
+						const double sin_x = (k % 2 == 0 ? -sin_pi : sin_pi);
+						weight[n] = _radius * sin_x * sin_window / (Pi * Pi * x * x);
+					}
+					const double sin_next = sin_window * _cos_step + cos_window * _sin_step;
+					cos_window = cos_window * _cos_step - sin_window * _sin_step;
+					sin_window = sin_next;
+				}
+			}
+			break;
+		default:
+			for (int n = 0; n < 4; n++) {
+				weight[n] = ImgKernel::cubic(double(n - 1) - fraction, _B, _C);
+			}
+	}
+}
+
+
+inline double
+ImgKernel::cubic(const double x, const double B, const double C)
+{
+	double x_abs = std::fabs(x);
+
+	if (x_abs <= 1.0) {
+		return ((2.0 - 1.5 * B - C) * x_abs + (-3.0 + 2.0 * B + C)) * x_abs * x_abs + 1.0 - B / 3.0;
+	} else if (x_abs < 2.0) {
+		return (((-B / 6.0 - C) * x_abs + B + 5.0 * C) * x_abs - 2.0 * B - 8.0 * C) * x_abs + 8.0 / 6.0 * B + 4.0 * C;
+	} else {
+		return 0.0;
+	}
+}
+
+/*
+ * sinc(x) * sinc(x / N) for |x| < N.
+ */
+inline double
+ImgKernel::lanczos_weight(const double x, const int N)
+{
+	const double Pi = 3.14159265358979323846;
+	double x_abs = std::fabs(x);
+
+	if (x_abs < DBL_EPSILON) {
+		return 1.0;
+	} else if (x_abs < N) {
+		return N * sin(Pi * x_abs) * sin(Pi * x_abs / N) / (Pi * Pi * x_abs * x_abs);
+	} else {
+		return 0.0;
+	}
+}
+
@@ -0,0 +1,94 @@
+#ifndef LIB_ImgClass_ImgMapped
+#define LIB_ImgClass_ImgMapped
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ImgClass.h"
+
+/* Header of the raw image file for ImgMapped
+ *
+ * The file is the header of 64 bytes followed by width x height pixels of T in row-major order.
+ * The integers are stored in the native byte order.
+ */
+struct ImgMappedHeader
+{
+	char magic[8]; // "ImgClass"
+	uint32_t version;
+	uint32_t pixel_size; // sizeof(T)
+	int32_t width;
+	int32_t height;
+	uint64_t data_offset; // Offset of the pixels from the beginning of the file
+	char reserved[32];
+};
+
+
+/* Memory-mapped image
+ *
+ * The pixels in the raw image file are mapped by mmap() and exposed as ImgVector<T> which refers the mapping
+ * (see ImgVector<T>::attach()), so the images larger than the physical memory are paged in on demand.
+ * The pixel type T should be a plain data type (e.g. double, size_t, ImgClass::RGB).
+ *
+ * ReadOnly : the pixels can not be modified (writable_image() throws std::logic_error)
+ * CopyOnWrite : the modified pages are private to the process and the file is not changed
+ * ReadWrite : the modification is written back to the file
+ */
+template <class T>
+class ImgMapped
+{
+	public:
+		enum Mode {
+			ReadOnly,
+			CopyOnWrite,
+			ReadWrite
+		};
+		enum Access {
+			Normal,
+			Sequential, // The pixels will be read in order (aggressive read ahead)
+			Random, // The pixels will be read randomly (no read ahead)
+			WillNeed // The pixels will be read soon
+		};
+
+		static const uint32_t Version = 1;
+		static const size_t HeaderSize = 64;
+
+	private:
+		void* _address; // Beginning of the mapping (the header)
+		size_t _length;
+		Mode _mode;
+		ImgVector<T> _image; // Refers the pixels in the mapping
+
+	public:
+		ImgMapped(void);
+		explicit ImgMapped(const std::string& path, const Mode mode = ReadOnly);
+		ImgMapped(const ImgMapped<T>& copy) = delete;
+		ImgMapped<T>& operator=(const ImgMapped<T>& copy) = delete;
+
+		virtual ~ImgMapped(void);
+
+		void open(const std::string& path, const Mode mode = ReadOnly);
+		void close(void);
+		void advise(const Access access) const; // madvise() hint for the pixels
+		void sync(void) const; // Write back the modification in ReadWrite mode
+
+		// Create the raw image file
+		static void create(const std::string& path, const int Width, const int Height, const T& value = T());
+		static void create(const std::string& path, const ImgVector<T>& image);
+
+		// Get Properties
+		int width(void) const;
+		int height(void) const;
+		size_t size(void) const;
+		bool isNULL(void) const;
+		Mode mode(void) const;
+
+		// The image on the mapping
+		const ImgVector<T>& image(void) const;
+		ImgVector<T>& writable_image(void);
+};
+
+#include "ImgMapped_private.h"
+
+#endif
+
@@ -0,0 +1,254 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+
+
+template <class T>
+const uint32_t ImgMapped<T>::Version;
+template <class T>
+const size_t ImgMapped<T>::HeaderSize;
+
+
+// ----- Constructor -----
+template <class T>
+ImgMapped<T>::ImgMapped(void)
+{
+	static_assert(std::is_standard_layout<T>::value, "ImgMapped<T> : T should be a plain data type");
+	static_assert(sizeof(ImgMappedHeader) == HeaderSize, "ImgMapped<T> : size of ImgMappedHeader");
+	_address = nullptr;
+	_length = 0;
+	_mode = ReadOnly;
+}
+
+template <class T>
+ImgMapped<T>::ImgMapped(const std::string& path, const Mode mode)
+{
+	static_assert(std::is_standard_layout<T>::value, "ImgMapped<T> : T should be a plain data type");
+	static_assert(sizeof(ImgMappedHeader) == HeaderSize, "ImgMapped<T> : size of ImgMappedHeader");
+	_address = nullptr;
+	_length = 0;
+	_mode = ReadOnly;
+	this->open(path, mode);
+}
+
+
+template <class T>
+ImgMapped<T>::~ImgMapped(void)
+{
+	this->close();
+}
+
+
+
+
+template <class T>
+void
+ImgMapped<T>::open(const std::string& path, const Mode mode)
+{
+	this->close();
+	int fd = ::open(path.c_str(), mode == ReadWrite ? O_RDWR : O_RDONLY);
+	if (fd < 0) {
+		std::cerr << "void ImgMapped<T>::open(const std::string&, const Mode) : " << path << " : " << strerror(errno) << std::endl;
+		throw std::runtime_error("void ImgMapped<T>::open(const std::string&, const Mode) : cannot open the file");
+	}
+	struct stat status;
+	if (fstat(fd, &status) != 0 || size_t(status.st_size) < HeaderSize) {
+		::close(fd);
+		throw std::invalid_argument("void ImgMapped<T>::open(const std::string&, const Mode) : the file is too small");
+	}
+	size_t length = size_t(status.st_size);
+	void* address = mmap(nullptr, length,
+	    mode == ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE,
+	    mode == ReadWrite ? MAP_SHARED : MAP_PRIVATE,
+	    fd, 0);
+	::close(fd); // The mapping is kept after close()
+	if (address == MAP_FAILED) {
+		std::cerr << "void ImgMapped<T>::open(const std::string&, const Mode) : " << path << " : " << strerror(errno) << std::endl;
+		throw std::runtime_error("void ImgMapped<T>::open(const std::string&, const Mode) : cannot map the file");
+	}
+	// Check the header
+	const ImgMappedHeader* header = static_cast<const ImgMappedHeader*>(address);
+	const char* error = nullptr;
+	if (memcmp(header->magic, "ImgClass", sizeof(header->magic)) != 0) {
+		error = "void ImgMapped<T>::open(const std::string&, const Mode) : the file is not the raw image of ImgClass";
+	} else if (header->version != Version) {
+		error = "void ImgMapped<T>::open(const std::string&, const Mode) : version of the file is not supported";
+	} else if (header->pixel_size != sizeof(T)) {
+		error = "void ImgMapped<T>::open(const std::string&, const Mode) : size of the pixel is not match";
+	} else if (header->width < 0 || header->height < 0
+	    || header->data_offset % alignof(T) != 0
+	    || header->data_offset + sizeof(T) * size_t(header->width) * size_t(header->height) > length) {
+		error = "void ImgMapped<T>::open(const std::string&, const Mode) : the file is broken";
+	}
+	if (error != nullptr) {
+		munmap(address, length);
+		throw std::invalid_argument(error);
+	}
+	_address = address;
+	_length = length;
+	_mode = mode;
+	_image.attach(header->width, header->height,
+	    reinterpret_cast<T*>(static_cast<char*>(address) + header->data_offset));
+}
+
+template <class T>
+void
+ImgMapped<T>::close(void)
+{
+	_image.attach(0, 0, nullptr);
+	if (_address != nullptr) {
+		munmap(_address, _length);
+	}
+	_address = nullptr;
+	_length = 0;
+	_mode = ReadOnly;
+}
+
+
+template <class T>
+void
+ImgMapped<T>::advise(const Access access) const
+{
+	if (_address == nullptr) {
+		return;
+	}
+	int advice = MADV_NORMAL;
+	switch (access) {
+		case Sequential:
+			advice = MADV_SEQUENTIAL;
+			break;
+		case Random:
+			advice = MADV_RANDOM;
+			break;
+		case WillNeed:
+			advice = MADV_WILLNEED;
+			break;
+		default:
+			advice = MADV_NORMAL;
+	}
+	madvise(_address, _length, advice); // Only the hint, so the failure is ignored
+}
+
+template <class T>
+void
+ImgMapped<T>::sync(void) const
+{
+	if (_address != nullptr && _mode == ReadWrite) {
+		if (msync(_address, _length, MS_SYNC) != 0) {
+			throw std::runtime_error("void ImgMapped<T>::sync(void) const : msync() failed");
+		}
+	}
+}
+
+
+
+
+template <class T>
+void
+ImgMapped<T>::create(const std::string& path, const int Width, const int Height, const T& value)
+{
+	ImgVector<T> row(Width > 0 ? Width : 0, 1, value);
+	ImgMappedHeader header;
+
+	if (Width < 0 || Height < 0) {
+		throw std::invalid_argument("void ImgMapped<T>::create(const std::string&, const int, const int, const T&) : negative size");
+	}
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "ImgClass", sizeof(header.magic));
+	header.version = Version;
+	header.pixel_size = sizeof(T);
+	header.width = Width;
+	header.height = Height;
+	header.data_offset = HeaderSize;
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		std::cerr << "void ImgMapped<T>::create(const std::string&, const int, const int, const T&) : " << path << " : " << strerror(errno) << std::endl;
+		throw std::runtime_error("void ImgMapped<T>::create(const std::string&, const int, const int, const T&) : cannot create the file");
+	}
+	bool failed = write(fd, &header, sizeof(header)) != ssize_t(sizeof(header));
+	for (int y = 0; y < Height && failed == false; y++) {
+		failed = write(fd, row.data(), sizeof(T) * size_t(Width)) != ssize_t(sizeof(T) * size_t(Width));
+	}
+	if (::close(fd) != 0 || failed) {
+		throw std::runtime_error("void ImgMapped<T>::create(const std::string&, const int, const int, const T&) : cannot write the file");
+	}
+}
+
+template <class T>
+void
+ImgMapped<T>::create(const std::string& path, const ImgVector<T>& image)
+{
+	ImgMapped<T>::create(path, image.width(), image.height());
+	ImgMapped<T> mapped(path, ReadWrite);
+	for (size_t n = 0; n < image.size(); n++) {
+		mapped.writable_image()[n] = image[n];
+	}
+	mapped.sync();
+}
+
+
+
+
+// ----- Accessors -----
+template <class T>
+int
+ImgMapped<T>::width(void) const
+{
+	return _image.width();
+}
+
+template <class T>
+int
+ImgMapped<T>::height(void) const
+{
+	return _image.height();
+}
+
+template <class T>
+size_t
+ImgMapped<T>::size(void) const
+{
+	return _image.size();
+}
+
+template <class T>
+bool
+ImgMapped<T>::isNULL(void) const
+{
+	return _image.isNULL();
+}
+
+template <class T>
+typename ImgMapped<T>::Mode
+ImgMapped<T>::mode(void) const
+{
+	return _mode;
+}
+
+
+template <class T>
+const ImgVector<T> &
+ImgMapped<T>::image(void) const
+{
+	return _image;
+}
+
+template <class T>
+ImgVector<T> &
+ImgMapped<T>::writable_image(void)
+{
+	if (_address != nullptr && _mode == ReadOnly) {
+		throw std::logic_error("ImgVector<T>& ImgMapped<T>::writable_image(void) : the image is mapped read-only");
+	}
+	return _image;
+}
+
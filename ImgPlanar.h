@@ -0,0 +1,128 @@
+#ifndef LIB_ImgClass_ImgPlanar
+#define LIB_ImgClass_ImgPlanar
+
+#include <cstddef>
+
+#include "Color.h"
+#include "ImgClass.h"
+
+/* Channel layout of the pixel types for the planar image
+ *
+ * Channels : the number of channels
+ * get(), set() : access to the c-th channel of the pixel in the scalar type of the plane (ImgScalar<T>::type)
+ */
+template <class T>
+struct ImgPlanarChannels
+{
+	typedef typename ImgScalar<T>::type scalar_type;
+	static const int Channels = 1;
+	static scalar_type get(const T& pixel, const int) { return scalar_type(pixel); }
+	static void set(T& pixel, const int, const scalar_type& value) { pixel = T(value); }
+};
+
+template <class S>
+struct ImgPlanarChannels<ImgClass::basic_RGB<S> >
+{
+	typedef typename ImgScalar<ImgClass::basic_RGB<S> >::type scalar_type;
+	static const int Channels = 3;
+	static scalar_type get(const ImgClass::basic_RGB<S>& pixel, const int c) { return scalar_type(c == 0 ? pixel.R : c == 1 ? pixel.G : pixel.B); }
+	static void set(ImgClass::basic_RGB<S>& pixel, const int c, const scalar_type& value) { (c == 0 ? pixel.R : c == 1 ? pixel.G : pixel.B) = S(value); }
+};
+
+template <class S>
+struct ImgPlanarChannels<ImgClass::basic_Lab<S> >
+{
+	typedef typename ImgScalar<ImgClass::basic_Lab<S> >::type scalar_type;
+	static const int Channels = 3;
+	static scalar_type get(const ImgClass::basic_Lab<S>& pixel, const int c) { return scalar_type(c == 0 ? pixel.L : c == 1 ? pixel.a : pixel.b); }
+	static void set(ImgClass::basic_Lab<S>& pixel, const int c, const scalar_type& value) { (c == 0 ? pixel.L : c == 1 ? pixel.a : pixel.b) = S(value); }
+};
+
+
+/* Planar (structure-of-arrays) image
+ *
+ * Each channel is stored in the separate plane of ImgPlanar<T>::scalar_type (float for float, RGBf, Labf and the compact pixels, double otherwise)
+ * and each plane is aligned to ImgPlanar<T>::Alignment bytes.
+ * Kernels which need only one channel (e.g. L* of L*a*b*) can read plane(c) contiguously.
+ * The pixel is accessible as T through the proxy returned by at() and operator[].
+ */
+template <class T>
+class ImgPlanar
+{
+	public:
+		typedef typename ImgPlanarChannels<T>::scalar_type scalar_type;
+		static const int Channels = ImgPlanarChannels<T>::Channels;
+		static const size_t Alignment = 64;
+
+		// Proxy of the pixel which loads from and stores to the planes
+		class Pixel
+		{
+			private:
+				ImgPlanar<T>* _image;
+				size_t _n;
+			public:
+				Pixel(ImgPlanar<T>* image, const size_t n);
+				operator T() const;
+				Pixel& operator=(const T& value);
+				Pixel& operator=(const Pixel& pixel);
+				template<class RT> Pixel& operator+=(const RT& rvalue);
+				template<class RT> Pixel& operator-=(const RT& rvalue);
+				template<class RT> Pixel& operator*=(const RT& rvalue);
+				template<class RT> Pixel& operator/=(const RT& rvalue);
+		};
+
+	private:
+		scalar_type *_memory; // Allocated memory including the padding for the alignment
+		scalar_type *_planes[Channels > 0 ? Channels : 1];
+		size_t _reserved_size;
+		int _width;
+		int _height;
+
+	public:
+		ImgPlanar(void);
+		ImgPlanar(const int Width, const int Height, const T& value = T());
+		explicit ImgPlanar(const ImgVector<T>& image);
+		ImgPlanar(const ImgPlanar<T>& copy); // Copy constructor
+
+		virtual ~ImgPlanar(void);
+
+		void clear(void);
+		void reset(const int Width, const int Height, const T& value = T());
+		ImgPlanar<T>& set(const ImgVector<T>& image); // Convert from interleaved image
+		void copy_to(ImgVector<T>* image) const; // Convert to interleaved image
+
+		ImgPlanar<T>& copy(const ImgPlanar<T>& image);
+		ImgPlanar<T>& operator=(const ImgPlanar<T>& image);
+
+		// Get Properties
+		int width(void) const;
+		int height(void) const;
+		size_t size(void) const;
+		bool isNULL(void) const;
+
+		// Channel planes
+		scalar_type* plane(const int c);
+		const scalar_type* plane(const int c) const;
+
+		// Proxy to the pixel
+		Pixel operator[](const size_t n);
+		Pixel at(const size_t n);
+		Pixel at(const int x, const int y);
+		// Get pixel
+		const T operator[](const size_t n) const;
+		const T get(const size_t n) const;
+		const T get(const int x, const int y) const;
+		const T get_zeropad(const int x, const int y) const;
+		const T get_mirror(const int x, const int y) const;
+		// Set pixel
+		void set(const size_t n, const T& value);
+		void set(const int x, const int y, const T& value);
+
+	protected:
+		void allocate(const size_t new_size);
+};
+
+#include "ImgPlanar_private.h"
+
+#endif
+
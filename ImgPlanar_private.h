@@ -0,0 +1,445 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+
+
+
+// ----- Pixel proxy -----
+template <class T>
+ImgPlanar<T>::Pixel::Pixel(ImgPlanar<T>* image, const size_t n)
+{
+	_image = image;
+	_n = n;
+}
+
+template <class T>
+ImgPlanar<T>::Pixel::operator T() const
+{
+	return _image->get(_n);
+}
+
+template <class T>
+typename ImgPlanar<T>::Pixel &
+ImgPlanar<T>::Pixel::operator=(const T& value)
+{
+	_image->set(_n, value);
+	return *this;
+}
+
+template <class T>
+typename ImgPlanar<T>::Pixel &
+ImgPlanar<T>::Pixel::operator=(const Pixel& pixel)
+{
+	_image->set(_n, pixel._image->get(pixel._n));
+	return *this;
+}
+
+template <class T>
+template <class RT>
+typename ImgPlanar<T>::Pixel &
+ImgPlanar<T>::Pixel::operator+=(const RT& rvalue)
+{
+	T value = _image->get(_n);
+	value += rvalue;
+	_image->set(_n, value);
+	return *this;
+}
+
+template <class T>
+template <class RT>
+typename ImgPlanar<T>::Pixel &
+ImgPlanar<T>::Pixel::operator-=(const RT& rvalue)
+{
+	T value = _image->get(_n);
+	value -= rvalue;
+	_image->set(_n, value);
+	return *this;
+}
+
+template <class T>
+template <class RT>
+typename ImgPlanar<T>::Pixel &
+ImgPlanar<T>::Pixel::operator*=(const RT& rvalue)
+{
+	T value = _image->get(_n);
+	value *= rvalue;
+	_image->set(_n, value);
+	return *this;
+}
+
+template <class T>
+template <class RT>
+typename ImgPlanar<T>::Pixel &
+ImgPlanar<T>::Pixel::operator/=(const RT& rvalue)
+{
+	T value = _image->get(_n);
+	value /= rvalue;
+	_image->set(_n, value);
+	return *this;
+}
+
+
+
+
+// ----- Constructor -----
+template <class T>
+ImgPlanar<T>::ImgPlanar(void)
+{
+	_memory = nullptr;
+	for (int c = 0; c < Channels; c++) {
+		_planes[c] = nullptr;
+	}
+	_reserved_size = 0;
+	_width = 0;
+	_height = 0;
+}
+
+template <class T>
+ImgPlanar<T>::ImgPlanar(const int Width, const int Height, const T& value)
+{
+	_memory = nullptr;
+	for (int c = 0; c < Channels; c++) {
+		_planes[c] = nullptr;
+	}
+	_reserved_size = 0;
+	_width = 0;
+	_height = 0;
+	this->reset(Width, Height, value);
+}
+
+template <class T>
+ImgPlanar<T>::ImgPlanar(const ImgVector<T>& image)
+{
+	_memory = nullptr;
+	for (int c = 0; c < Channels; c++) {
+		_planes[c] = nullptr;
+	}
+	_reserved_size = 0;
+	_width = 0;
+	_height = 0;
+	this->set(image);
+}
+
+template <class T>
+ImgPlanar<T>::ImgPlanar(const ImgPlanar<T>& copy)
+{
+	_memory = nullptr;
+	for (int c = 0; c < Channels; c++) {
+		_planes[c] = nullptr;
+	}
+	_reserved_size = 0;
+	_width = 0;
+	_height = 0;
+	this->copy(copy);
+}
+
+
+template <class T>
+ImgPlanar<T>::~ImgPlanar(void)
+{
+	delete[] _memory;
+}
+
+
+
+
+/*
+ * Allocate the planes of new_size elements.
+ * Every plane starts at the address aligned to Alignment bytes.
+ * The data is not preserved when the memory is reallocated.
+ */
+template <class T>
+void
+ImgPlanar<T>::allocate(const size_t new_size)
+{
+	const size_t align = Alignment / sizeof(scalar_type);
+	if (_reserved_size < new_size) {
+		size_t stride = (new_size + align - 1) / align * align;
+		scalar_type* new_memory = nullptr;
+		try {
+			new_memory = new scalar_type[stride * size_t(Channels) + align];
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "void ImgPlanar<T>::allocate(const size_t) : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		delete[] _memory;
+		_memory = new_memory;
+		_reserved_size = new_size;
+		uintptr_t address = reinterpret_cast<uintptr_t>(_memory);
+		scalar_type* aligned = _memory + ((Alignment - address % Alignment) % Alignment) / sizeof(scalar_type);
+		for (int c = 0; c < Channels; c++) {
+			_planes[c] = aligned + stride * size_t(c);
+		}
+	}
+}
+
+
+template <class T>
+void
+ImgPlanar<T>::clear(void)
+{
+	// delete allocated memory only when destructor is called
+	_width = 0;
+	_height = 0;
+}
+
+template <class T>
+void
+ImgPlanar<T>::reset(const int Width, const int Height, const T& value)
+{
+	if (Width > 0 && Height > 0) {
+		size_t new_size = size_t(Width) * size_t(Height);
+		this->allocate(new_size);
+		_width = Width;
+		_height = Height;
+		for (int c = 0; c < Channels; c++) {
+			scalar_type channel_value = ImgPlanarChannels<T>::get(value, c);
+			scalar_type* p = _planes[c];
+			for (size_t n = 0; n < new_size; n++) {
+				p[n] = channel_value;
+			}
+		}
+	}
+}
+
+
+template <class T>
+ImgPlanar<T> &
+ImgPlanar<T>::set(const ImgVector<T>& image)
+{
+	if (image.isNULL()) {
+		this->clear();
+		return *this;
+	}
+	size_t new_size = image.size();
+	this->allocate(new_size);
+	_width = image.width();
+	_height = image.height();
+	const T* src = image.data();
+	for (int c = 0; c < Channels; c++) {
+		scalar_type* p = _planes[c];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (long long n = 0; n < static_cast<long long>(new_size); n++) {
+			p[n] = ImgPlanarChannels<T>::get(src[n], c);
+		}
+	}
+	return *this;
+}
+
+template <class T>
+void
+ImgPlanar<T>::copy_to(ImgVector<T>* image) const
+{
+	if (image == nullptr) {
+		throw std::invalid_argument("void ImgPlanar<T>::copy_to(ImgVector<T>*) const : image is nullptr");
+	}
+	if (this->isNULL()) {
+		image->clear();
+		return;
+	}
+	image->reset(_width, _height);
+	T* dst = image->data();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (long long n = 0; n < static_cast<long long>(this->size()); n++) {
+		for (int c = 0; c < Channels; c++) {
+			ImgPlanarChannels<T>::set(dst[n], c, _planes[c][n]);
+		}
+	}
+}
+
+
+template <class T>
+ImgPlanar<T> &
+ImgPlanar<T>::copy(const ImgPlanar<T>& image)
+{
+	if (this != &image
+	    && image._width > 0 && image._height > 0) {
+		size_t new_size = image.size();
+		this->allocate(new_size);
+		_width = image._width;
+		_height = image._height;
+		for (int c = 0; c < Channels; c++) {
+			for (size_t n = 0; n < new_size; n++) {
+				_planes[c][n] = image._planes[c][n];
+			}
+		}
+	}
+	return *this;
+}
+
+template <class T>
+ImgPlanar<T> &
+ImgPlanar<T>::operator=(const ImgPlanar<T>& image)
+{
+	return this->copy(image);
+}
+
+
+
+
+// ----- Accessors -----
+template <class T>
+int
+ImgPlanar<T>::width(void) const
+{
+	return _width;
+}
+
+template <class T>
+int
+ImgPlanar<T>::height(void) const
+{
+	return _height;
+}
+
+template <class T>
+size_t
+ImgPlanar<T>::size(void) const
+{
+	return size_t(_width) * size_t(_height);
+}
+
+template <class T>
+bool
+ImgPlanar<T>::isNULL(void) const
+{
+	if (_width == 0 || _height == 0) {
+		return true;
+	} else {
+		return false;
+	}
+}
+
+
+template <class T>
+typename ImgPlanar<T>::scalar_type *
+ImgPlanar<T>::plane(const int c)
+{
+	assert(0 <= c && c < Channels);
+	return _planes[c];
+}
+
+template <class T>
+const typename ImgPlanar<T>::scalar_type *
+ImgPlanar<T>::plane(const int c) const
+{
+	assert(0 <= c && c < Channels);
+	return _planes[c];
+}
+
+
+template <class T>
+typename ImgPlanar<T>::Pixel
+ImgPlanar<T>::operator[](const size_t n)
+{
+	return Pixel(this, n);
+}
+
+template <class T>
+typename ImgPlanar<T>::Pixel
+ImgPlanar<T>::at(const size_t n)
+{
+	assert(n < this->size());
+	return Pixel(this, n);
+}
+
+template <class T>
+typename ImgPlanar<T>::Pixel
+ImgPlanar<T>::at(const int x, const int y)
+{
+	assert(0 <= x && x < _width && 0 <= y && y < _height);
+	return Pixel(this, size_t(_width) * size_t(y) + size_t(x));
+}
+
+
+template <class T>
+const T
+ImgPlanar<T>::operator[](const size_t n) const
+{
+	T value = T();
+	for (int c = 0; c < Channels; c++) {
+		ImgPlanarChannels<T>::set(value, c, _planes[c][n]);
+	}
+	return value;
+}
+
+template <class T>
+const T
+ImgPlanar<T>::get(const size_t n) const
+{
+	assert(n < this->size());
+	T value = T();
+	for (int c = 0; c < Channels; c++) {
+		ImgPlanarChannels<T>::set(value, c, _planes[c][n]);
+	}
+	return value;
+}
+
+template <class T>
+const T
+ImgPlanar<T>::get(const int x, const int y) const
+{
+	assert(0 <= x && x < _width && 0 <= y && y < _height);
+	return this->get(size_t(_width) * size_t(y) + size_t(x));
+}
+
+template <class T>
+const T
+ImgPlanar<T>::get_zeropad(const int x, const int y) const
+{
+	assert(_width > 0 && _height > 0);
+	if (x < 0 || _width <= x || y < 0 || _height <= y) {
+		return T();
+	} else {
+		return this->get(size_t(_width) * size_t(y) + size_t(x));
+	}
+}
+
+template <class T>
+const T
+ImgPlanar<T>::get_mirror(const int x, const int y) const
+{
+	int x_mirror = x;
+	int y_mirror = y;
+
+	assert(_width > 0 && _height > 0);
+	if (x_mirror < 0) {
+		x_mirror = -x_mirror - 1; // should be set the offset when Mirroring over negative
+	}
+	if (y_mirror < 0) {
+		y_mirror = -y_mirror - 1;
+	}
+	x_mirror = int(round(_width - 0.5 - std::fabs(_width - 0.5 - (x_mirror % (2 * _width)))));
+	y_mirror = int(round(_height - 0.5 - std::fabs(_height - 0.5 - (y_mirror % (2 * _height)))));
+	return this->get(size_t(_width) * size_t(y_mirror) + size_t(x_mirror));
+}
+
+
+template <class T>
+void
+ImgPlanar<T>::set(const size_t n, const T& value)
+{
+	assert(n < this->size());
+	for (int c = 0; c < Channels; c++) {
+		_planes[c][n] = ImgPlanarChannels<T>::get(value, c);
+	}
+}
+
+template <class T>
+void
+ImgPlanar<T>::set(const int x, const int y, const T& value)
+{
+	assert(0 <= x && x < _width && 0 <= y && y < _height);
+	this->set(size_t(_width) * size_t(y) + size_t(x), value);
+}
+
@@ -0,0 +1,65 @@
+#ifndef LIB_ImgClass_ImgPyramid
+#define LIB_ImgClass_ImgPyramid
+
+#include <cstddef>
+#include <vector>
+
+#include "ImgClass.h"
+
+/* Image pyramid
+ *
+ * All levels are stored in a single contiguous allocation and level 0 is the original image.
+ * Level n + 1 is decimated from level n by 2:1 with the anti-aliasing binomial kernel [1 4 6 4 1] / 16
+ * and its size is ceil(width / 2) x ceil(height / 2).
+ * Each level is exposed as ImgVector<T> which refers the shared storage.
+ */
+template <class T>
+class ImgPyramid
+{
+	private:
+		int _levels;
+		T *_data;
+		size_t _reserved_size;
+		std::vector<size_t> _offsets;
+		std::vector<ImgVector<T> > _level_images; // Views of _data
+
+	public:
+		ImgPyramid(void);
+		ImgPyramid(const ImgVector<T>& image, const int Levels = 0);
+		ImgPyramid(const ImgPyramid<T>& copy); // Copy constructor
+
+		virtual ~ImgPyramid(void);
+
+		// Levels <= 0 : build until the smaller side of the top level becomes 1
+		void reset(const ImgVector<T>& image, const int Levels = 0);
+		// Rebuild all levels from the new frame in place if the size is not changed
+		void rebuild(const ImgVector<T>& image);
+		void clear(void);
+
+		ImgPyramid<T>& copy(const ImgPyramid<T>& pyramid);
+		ImgPyramid<T>& operator=(const ImgPyramid<T>& pyramid);
+
+		// Get Properties
+		int levels(void) const;
+		int width(const int level = 0) const;
+		int height(const int level = 0) const;
+		size_t size(void) const; // Total number of pixels on all levels
+		bool isNULL(void) const;
+
+		// Data access
+		T* data(void) const;
+		ImgVector<T>& operator[](const int level);
+		const ImgVector<T>& operator[](const int level) const;
+		ImgVector<T>& at(const int level);
+		const ImgVector<T>& at(const int level) const;
+
+	protected:
+		void allocate(const int Width, const int Height, const int Levels);
+		void build(void);
+		void decimate(const ImgVector<T>& source, ImgVector<T>* decimated);
+};
+
+#include "ImgPyramid_private.h"
+
+#endif
+
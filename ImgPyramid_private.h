@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+
+
+
+template <class T>
+ImgPyramid<T>::ImgPyramid(void)
+{
+	_levels = 0;
+	_data = nullptr;
+	_reserved_size = 0;
+}
+
+template <class T>
+ImgPyramid<T>::ImgPyramid(const ImgVector<T>& image, const int Levels)
+{
+	_levels = 0;
+	_data = nullptr;
+	_reserved_size = 0;
+	this->reset(image, Levels);
+}
+
+template <class T>
+ImgPyramid<T>::ImgPyramid(const ImgPyramid<T>& copy)
+{
+	_levels = 0;
+	_data = nullptr;
+	_reserved_size = 0;
+	this->copy(copy);
+}
+
+
+template <class T>
+ImgPyramid<T>::~ImgPyramid(void)
+{
+	_level_images.clear(); // Views should be released before the storage
+	delete[] _data;
+}
+
+
+
+
+template <class T>
+void
+ImgPyramid<T>::reset(const ImgVector<T>& image, const int Levels)
+{
+	if (image.isNULL()) {
+		throw std::invalid_argument("void ImgPyramid<T>::reset(const ImgVector<T>&, const int) : image is empty");
+	}
+	this->allocate(image.width(), image.height(), Levels);
+	for (size_t n = 0; n < image.size(); n++) {
+		_data[n] = image[n];
+	}
+	this->build();
+}
+
+
+template <class T>
+void
+ImgPyramid<T>::rebuild(const ImgVector<T>& image)
+{
+	if (image.isNULL()) {
+		throw std::invalid_argument("void ImgPyramid<T>::rebuild(const ImgVector<T>&) : image is empty");
+	}
+	if (_levels <= 0
+	    || image.width() != _level_images[0].width()
+	    || image.height() != _level_images[0].height()) {
+		this->reset(image, _levels);
+		return;
+	}
+	for (size_t n = 0; n < image.size(); n++) {
+		_data[n] = image[n];
+	}
+	this->build();
+}
+
+
+template <class T>
+void
+ImgPyramid<T>::clear(void)
+{
+	// delete allocated memory only when destructor is called
+	_levels = 0;
+	_offsets.clear();
+	_level_images.clear();
+}
+
+
+template <class T>
+ImgPyramid<T> &
+ImgPyramid<T>::copy(const ImgPyramid<T>& pyramid)
+{
+	if (this != &pyramid) {
+		if (pyramid.isNULL()) {
+			this->clear();
+		} else {
+			this->allocate(pyramid.width(0), pyramid.height(0), pyramid.levels());
+			for (size_t n = 0; n < pyramid.size(); n++) {
+				_data[n] = pyramid._data[n];
+			}
+		}
+	}
+	return *this;
+}
+
+template <class T>
+ImgPyramid<T> &
+ImgPyramid<T>::operator=(const ImgPyramid<T>& pyramid)
+{
+	return this->copy(pyramid);
+}
+
+
+
+
+// ----- Accessors -----
+template <class T>
+int
+ImgPyramid<T>::levels(void) const
+{
+	return _levels;
+}
+
+template <class T>
+int
+ImgPyramid<T>::width(const int level) const
+{
+	assert(0 <= level && level < _levels);
+	return _level_images[level].width();
+}
+
+template <class T>
+int
+ImgPyramid<T>::height(const int level) const
+{
+	assert(0 <= level && level < _levels);
+	return _level_images[level].height();
+}
+
+template <class T>
+size_t
+ImgPyramid<T>::size(void) const
+{
+	if (_levels <= 0) {
+		return 0;
+	}
+	return _offsets[_levels - 1] + _level_images[_levels - 1].size();
+}
+
+template <class T>
+bool
+ImgPyramid<T>::isNULL(void) const
+{
+	if (_levels <= 0) {
+		return true;
+	} else {
+		return false;
+	}
+}
+
+
+template <class T>
+T *
+ImgPyramid<T>::data(void) const
+{
+	if (this->isNULL()) {
+		return nullptr;
+	} else {
+		return _data;
+	}
+}
+
+template <class T>
+ImgVector<T> &
+ImgPyramid<T>::operator[](const int level)
+{
+	return _level_images[level];
+}
+
+template <class T>
+const ImgVector<T> &
+ImgPyramid<T>::operator[](const int level) const
+{
+	return _level_images[level];
+}
+
+template <class T>
+ImgVector<T> &
+ImgPyramid<T>::at(const int level)
+{
+	assert(0 <= level && level < _levels);
+	return _level_images[level];
+}
+
+template <class T>
+const ImgVector<T> &
+ImgPyramid<T>::at(const int level) const
+{
+	assert(0 <= level && level < _levels);
+	return _level_images[level];
+}
+
+
+
+
+// ----- Build -----
+/*
+ * Compute the geometry of all levels and (re)allocate the shared storage.
+ * The storage is reused when it is large enough.
+ */
+template <class T>
+void
+ImgPyramid<T>::allocate(const int Width, const int Height, const int Levels)
+{
+	std::vector<int> widths;
+	std::vector<int> heights;
+	size_t total = 0;
+
+	if (Width <= 0 || Height <= 0) {
+		throw std::invalid_argument("void ImgPyramid<T>::allocate(const int, const int, const int) : size is empty");
+	}
+	{
+		int w = Width;
+		int h = Height;
+		for (int level = 0; Levels <= 0 || level < Levels; level++) {
+			widths.push_back(w);
+			heights.push_back(h);
+			if ((Levels <= 0 && std::min(w, h) <= 1)
+			    || (w <= 1 && h <= 1)) {
+				break;
+			}
+			w = (w + 1) / 2;
+			h = (h + 1) / 2;
+		}
+	}
+	_levels = int(widths.size());
+	_offsets.resize(_levels);
+	for (int level = 0; level < _levels; level++) {
+		_offsets[level] = total;
+		total += size_t(widths[level]) * size_t(heights[level]);
+	}
+	if (_reserved_size < total) {
+		T* new_data = nullptr;
+		try {
+			new_data = new T[total];
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "void ImgPyramid<T>::allocate(const int, const int, const int) : Cannot Allocate Memory" << std::endl;
+			_levels = 0;
+			_offsets.clear();
+			_level_images.clear();
+			throw;
+		}
+		_level_images.clear();
+		delete[] _data;
+		_data = new_data;
+		_reserved_size = total;
+	}
+	_level_images.resize(_levels);
+	for (int level = 0; level < _levels; level++) {
+		_level_images[level].attach(widths[level], heights[level], _data + _offsets[level]);
+	}
+}
+
+
+template <class T>
+void
+ImgPyramid<T>::build(void)
+{
+	for (int level = 1; level < _levels; level++) {
+		this->decimate(_level_images[level - 1], &_level_images[level]);
+	}
+}
+
+
+/*
+ * 2:1 decimation with the binomial kernel [1 4 6 4 1] / 16 and mirrored boundary.
+ * Each output row is filtered vertically into a row buffer and then horizontally,
+ * so the source image is read row-major and no intermediate image is needed.
+ * The sums and the row buffer are ImgAccumulator<T>::type and the output is rounded once by ImgPromote<T>::demote(),
+ * so the compact pixels do not drift over the levels.
+ */
+template <class T>
+void
+ImgPyramid<T>::decimate(const ImgVector<T>& source, ImgVector<T>* decimated)
+{
+	const double kernel[5] = {1.0 / 16.0, 4.0 / 16.0, 6.0 / 16.0, 4.0 / 16.0, 1.0 / 16.0};
+	const int src_width = source.width();
+	const int src_height = source.height();
+	const int dst_width = decimated->width();
+	const int dst_height = decimated->height();
+	typedef typename ImgAccumulator<T>::type accumulator_type;
+	typedef typename ImgPromote<T>::type promoted_type;
+	const T* src = source.data();
+	T* dst = decimated->data();
+	auto mirror = [](int n, int length) -> int {
+		if (n < 0) {
+			n = -n - 1;
+		}
+		n %= 2 * length;
+		return n < length ? n : 2 * length - n - 1;
+	};
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		std::vector<accumulator_type> row(src_width);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for (int y = 0; y < dst_height; y++) {
+			// Vertical
+			int index_y[5];
+			for (int m = 0; m < 5; m++) {
+				index_y[m] = mirror(2 * y + m - 2, src_height);
+			}
+			for (int x = 0; x < src_width; x++) {
+				accumulator_type sum = accumulator_type();
+				for (int m = 0; m < 5; m++) {
+					sum += kernel[m] * accumulator_type(src[size_t(src_width) * size_t(index_y[m]) + size_t(x)]);
+				}
+				row[x] = sum;
+			}
+			// Horizontal
+			T* row_dst = dst + size_t(dst_width) * size_t(y);
+			for (int x = 0; x < dst_width; x++) {
+				accumulator_type sum = accumulator_type();
+				if (2 * x - 2 >= 0 && 2 * x + 2 < src_width) {
+					for (int n = 0; n < 5; n++) {
+						sum += kernel[n] * row[2 * x + n - 2];
+					}
+				} else {
+					for (int n = 0; n < 5; n++) {
+						sum += kernel[n] * row[mirror(2 * x + n - 2, src_width)];
+					}
+				}
+				row_dst[x] = ImgPromote<T>::demote(promoted_type(sum));
+			}
+		}
+	}
+}
+
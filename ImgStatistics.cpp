@@ -1,29 +1,33 @@
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <new>
+#include <stdexcept>
 
 #include "ImgStatistics.h"
 
 
 
-ImgStatistics::ImgStatistics(void)
+template <class S>
+basic_ImgStatistics<S>::basic_ImgStatistics(void)
 {
 	_width = 0;
 	_height = 0;
 	_data = nullptr;
 }
 
-ImgStatistics::ImgStatistics(const ImgStatistics &copy)
+template <class S>
+basic_ImgStatistics<S>::basic_ImgStatistics(const basic_ImgStatistics<S> &copy)
 {
 	_width = 0;
 	_height = 0;
 	_data = nullptr;
 	try {
-		_data = new double[copy._width * copy._height];
+		_data = new S[copy._width * copy._height];
 	}
 	catch (const std::bad_alloc &bad) {
 		std::cerr << bad.what() << std::endl
-		    << "ImgStatistics::ImgStatistics(const ImgStatistics &) error : memory allocation" << std::endl;
+		    << "basic_ImgStatistics<S>::basic_ImgStatistics(const basic_ImgStatistics<S> &) error : memory allocation" << std::endl;
 		_data = nullptr;
 		return;
 	}
@@ -32,20 +36,22 @@ ImgStatistics::ImgStatistics(const ImgStatistics &copy)
 	for (int i = 0; i < _width * _height; i++) {
 		_data[i] = copy._data[i];
 	}
+	_integral = copy._integral;
 }
 
-ImgStatistics::ImgStatistics(int W, int H, double *Img)
+template <class S>
+basic_ImgStatistics<S>::basic_ImgStatistics(int W, int H, const S *Img)
 {
 	_width = 0;
 	_height = 0;
 	_data = nullptr;
 	if (W > 0 && H > 0) {
 		try {
-			_data = new double[W * H]();
+			_data = new S[W * H]();
 		}
 		catch (const std::bad_alloc &bad) {
 			std::cerr << bad.what() << std::endl
-			    << "ImgStatistics::ImgStatistics(int, int, double *) error : memory allocation" << std::endl;
+			    << "basic_ImgStatistics<S>::basic_ImgStatistics(int, int, const S *) error : memory allocation" << std::endl;
 			return;
 		}
 		_width = W;
@@ -58,25 +64,28 @@ ImgStatistics::ImgStatistics(int W, int H, double *Img)
 	}
 }
 
-ImgStatistics::~ImgStatistics(void)
+template <class S>
+basic_ImgStatistics<S>::~basic_ImgStatistics(void)
 {
-	delete _data;
+	delete[] _data;
 }
 
+template <class S>
 void
-ImgStatistics::set(int W, int H, double *Img)
+basic_ImgStatistics<S>::set(int W, int H, const S *Img)
 {
 	_width = 0;
 	_height = 0;
 	delete[] _data;
 	_data = nullptr;
+	_integral.clear();
 	if (W > 0 && H > 0) {
 		try {
-			_data = new double[W * H]();
+			_data = new S[W * H]();
 		}
 		catch (const std::bad_alloc &bad) {
 			std::cerr << bad.what() << std::endl
-			    << "ImgStatistics::set(int, int, double *) error : memory allocation" << std::endl;
+			    << "basic_ImgStatistics<S>::set(int, int, const S *) error : memory allocation" << std::endl;
 			return;
 		}
 		_width = W;
@@ -89,17 +98,18 @@ ImgStatistics::set(int W, int H, double *Img)
 	}
 }
 
-ImgStatistics &
-ImgStatistics::copy(const ImgStatistics &copy)
+template <class S>
+basic_ImgStatistics<S> &
+basic_ImgStatistics<S>::copy(const basic_ImgStatistics<S> &copy)
 {
 	if (this != &copy) {
-		double *tmp_data = nullptr;
+		S *tmp_data = nullptr;
 		try {
-			tmp_data = new double[copy._width * copy._height];
+			tmp_data = new S[copy._width * copy._height];
 		}
 		catch (const std::bad_alloc &bad) {
 			std::cerr << bad.what() << std::endl
-			    << "ImgStatistics::ImgStatistics(const ImgStatistics &) error : memory allocation" << std::endl;
+			    << "basic_ImgStatistics<S>::basic_ImgStatistics(const basic_ImgStatistics<S> &) error : memory allocation" << std::endl;
 			return *this;
 		}
 		_width = copy._width;
@@ -109,21 +119,23 @@ ImgStatistics::copy(const ImgStatistics &copy)
 		for (int i = 0; i < _width * _height; i++) {
 			_data[i] = copy._data[i];
 		}
+		_integral = copy._integral;
 	}
 	return *this;
 }
 
-ImgStatistics &
-ImgStatistics::operator=(const ImgStatistics &copy)
+template <class S>
+basic_ImgStatistics<S> &
+basic_ImgStatistics<S>::operator=(const basic_ImgStatistics<S> &copy)
 {
 	if (this != &copy) {
-		double *tmp_data = nullptr;
+		S *tmp_data = nullptr;
 		try {
-			tmp_data = new double[copy._width * copy._height];
+			tmp_data = new S[copy._width * copy._height];
 		}
 		catch (const std::bad_alloc &bad) {
 			std::cerr << bad.what() << std::endl
-			    << "ImgStatistics::ImgStatistics(const ImgStatistics &) error : memory allocation" << std::endl;
+			    << "basic_ImgStatistics<S>::basic_ImgStatistics(const basic_ImgStatistics<S> &) error : memory allocation" << std::endl;
 			return *this;
 		}
 		_width = copy._width;
@@ -133,30 +145,55 @@ ImgStatistics::operator=(const ImgStatistics &copy)
 		for (int i = 0; i < _width * _height; i++) {
 			_data[i] = copy._data[i];
 		}
+		_integral = copy._integral;
 	}
 	return *this;
 }
 
-double &
-ImgStatistics::image(int x, int y) const
+template <class S>
+void
+basic_ImgStatistics<S>::integrate(void)
+{
+	_integral.reset(_width, _height, _data, true);
+}
+
+template <class S>
+void
+basic_ImgStatistics<S>::set_integral(const IntegralImage<S>& integral)
+{
+	if (integral.width() != _width || integral.height() != _height) {
+		throw std::invalid_argument("void basic_ImgStatistics<S>::set_integral(const IntegralImage<S>&) : size of integral is not match");
+	} else if (integral.isSquared() == false) {
+		throw std::invalid_argument("void basic_ImgStatistics<S>::set_integral(const IntegralImage<S>&) : integral does not have the sum of squares");
+	}
+	_integral = integral;
+}
+
+
+template <class S>
+S &
+basic_ImgStatistics<S>::image(int x, int y) const
 {
 	return _data[_width * y + x];
 }
 
+template <class S>
 int
-ImgStatistics::width(void) const
+basic_ImgStatistics<S>::width(void) const
 {
 	return _width;
 }
 
+template <class S>
 int
-ImgStatistics::height(void) const
+basic_ImgStatistics<S>::height(void) const
 {
 	return _height;
 }
 
+template <class S>
 double
-ImgStatistics::mean(void) const
+basic_ImgStatistics<S>::mean(void) const
 {
 	double sum = 0.0;
 
@@ -168,11 +205,17 @@ ImgStatistics::mean(void) const
 	return sum / (_width * _height);
 }
 
+template <class S>
 double
-ImgStatistics::mean(int center_x, int center_y, int window_width, int window_height) const
+basic_ImgStatistics<S>::mean(int center_x, int center_y, int window_width, int window_height) const
 {
 	double sum = 0.0;
 
+	if (_integral.isNULL() == false) {
+		sum = _integral.sum(center_x - (window_width - 1) / 2, center_y - (window_height - 1) / 2, window_width, window_height);
+		return sum / (window_width * window_height);
+	}
+
 	for (int y = 0; y < window_height; y++) {
 		int y_tmp = center_y + y - (window_height - 1) / 2;
 		if (y_tmp < 0 || _height <= y_tmp) {
@@ -189,8 +232,9 @@ ImgStatistics::mean(int center_x, int center_y, int window_width, int window_hei
 	return sum / (window_width * window_height);
 }
 
+template <class S>
 double
-ImgStatistics::variance(void) const
+basic_ImgStatistics<S>::variance(void) const
 {
 	double sum = 0.0;
 	double mu;
@@ -202,8 +246,9 @@ ImgStatistics::variance(void) const
 	return sum;
 }
 
+template <class S>
 double
-ImgStatistics::std_deviation(void) const
+basic_ImgStatistics<S>::std_deviation(void) const
 {
 	double sum = 0.0;
 	double mu;
@@ -215,13 +260,25 @@ ImgStatistics::std_deviation(void) const
 	return sqrt(sum);
 }
 
+template <class S>
 double
-ImgStatistics::variance(int center_x, int center_y, int window_width, int window_height) const
+basic_ImgStatistics<S>::variance(int center_x, int center_y, int window_width, int window_height) const
 {
 	double sum = 0.0;
 	double mu;
 
 	mu = this->mean(center_x, center_y, window_width, window_height);
+	if (_integral.isNULL() == false) {
+		// sum of (I - mu)^2 = sum of I^2 - 2 mu sum of I + N mu^2 in the window
+		int x = center_x - (window_width - 1) / 2;
+		int y = center_y - (window_height - 1) / 2;
+		double N = double(_integral.count(x, y, window_width, window_height));
+		sum = _integral.sum_squared(x, y, window_width, window_height)
+		    - 2.0 * mu * _integral.sum(x, y, window_width, window_height)
+		    + N * mu * mu;
+		sum = std::max(sum, 0.0); // Rounding error
+		return sum;
+	}
 	for (int y = 0; y < window_height; y++) {
 		int y_tmp = center_y + y - (window_height - 1) / 2;
 		if (y_tmp < 0 || _height <= y_tmp) {
@@ -238,14 +295,26 @@ ImgStatistics::variance(int center_x, int center_y, int window_width, int window
 	return sum;
 }
 
+template <class S>
 double
-ImgStatistics::std_deviation(int center_x, int center_y, int window_width, int window_height) const
+basic_ImgStatistics<S>::std_deviation(int center_x, int center_y, int window_width, int window_height) const
 {
 	double sum = 0.0;
 	double mu;
 	int x_tmp, y_tmp;
 
 	mu = this->mean(center_x, center_y, window_width, window_height);
+	if (_integral.isNULL() == false) {
+		// sum of (I - mu)^2 = sum of I^2 - 2 mu sum of I + N mu^2 in the window
+		int x = center_x - (window_width - 1) / 2;
+		int y = center_y - (window_height - 1) / 2;
+		double N = double(_integral.count(x, y, window_width, window_height));
+		sum = _integral.sum_squared(x, y, window_width, window_height)
+		    - 2.0 * mu * _integral.sum(x, y, window_width, window_height)
+		    + N * mu * mu;
+		sum = std::max(sum, 0.0); // Rounding error
+		return sqrt(sum);
+	}
 	for (int y = 0; y < window_height; y++) {
 		y_tmp = center_y + y - (window_height - 1) / 2;
 		if (y_tmp < 0 || _height <= y_tmp) {
@@ -265,6 +334,13 @@ ImgStatistics::std_deviation(int center_x, int center_y, int window_width, int w
 
 
 
+// ----- Explicit instantiation -----
+template class basic_ImgStatistics<double>;
+template class basic_ImgStatistics<float>;
+
+
+
+
 Histogram::Histogram(void)
 {
 	_bins = 0;
@@ -7,25 +7,37 @@
 #endif
 */
 
+#include "IntegralImage.h"
 
-class ImgStatistics
+
+/* Statistics of the image of the scalar S
+ *
+ * The image is stored in S and the sums are accumulated in double.
+ * The windowed statistics are computed in O(1) by the integral image
+ * when it is built by integrate() or supplied by set_integral().
+ */
+template <class S>
+class basic_ImgStatistics
 {
 	private:
 		int _width;
 		int _height;
-		double *_data;
+		S *_data;
+		IntegralImage<S> _integral;
 	public:
-		ImgStatistics(void);
-		ImgStatistics(const ImgStatistics &copy);
-		ImgStatistics(int W, int H, double *Img);
+		basic_ImgStatistics(void);
+		basic_ImgStatistics(const basic_ImgStatistics<S> &copy);
+		basic_ImgStatistics(int W, int H, const S *Img);
 
-		virtual ~ImgStatistics(void);
+		virtual ~basic_ImgStatistics(void);
 
-		void set(int W, int H, double *Img);
-		ImgStatistics& copy(const ImgStatistics &copy);
-		ImgStatistics& operator=(const ImgStatistics &copy);
+		void set(int W, int H, const S *Img);
+		basic_ImgStatistics<S>& copy(const basic_ImgStatistics<S> &copy);
+		basic_ImgStatistics<S>& operator=(const basic_ImgStatistics<S> &copy);
+		void integrate(void); // Build the integral image of the data
+		void set_integral(const IntegralImage<S>& integral);
 
-		double& image(int x, int y) const;
+		S& image(int x, int y) const;
 
 		int width(void) const;
 		int height(void) const;
@@ -38,6 +50,9 @@ class ImgStatistics
 		double std_deviation(int x, int y, int window_width, int window_height) const;
 };
 
+typedef basic_ImgStatistics<double> ImgStatistics;
+typedef basic_ImgStatistics<float> ImgStatisticsf;
+
 
 class Histogram
 {
@@ -0,0 +1,62 @@
+#ifndef LIB_ImgClass_IntegralImage
+#define LIB_ImgClass_IntegralImage
+
+#include <type_traits>
+
+#include "ImgClass.h"
+
+/* Summed-area table (integral image)
+ *
+ * The sums of the pixels over any rectangular window are computed in O(1) by 4 lookups of the table.
+ * The sums are accumulated in ImgAccumulator<T>::type (double for the scalars), and the sums of squares
+ * (norm_squared() for the colors) are accumulated in double if squared is true.
+ * The window is given by its top-left corner and its size and it is clipped by the image,
+ * so the pixels out of the image are regarded as zero (same as ImgVector<T>::get_zeropad()).
+ */
+template <class T>
+class IntegralImage
+{
+	public:
+		typedef typename ImgAccumulator<T>::type accumulator_type;
+
+	private:
+		int _width;
+		int _height;
+		ImgVector<accumulator_type> _sum; // (_width + 1) x (_height + 1)
+		ImgVector<double> _sum_squared; // (_width + 1) x (_height + 1), empty if squared is false
+
+	public:
+		IntegralImage(void);
+		explicit IntegralImage(const ImgVector<T>& image, const bool squared = true);
+		IntegralImage(const int Width, const int Height, const T* array, const bool squared = true);
+		IntegralImage(const IntegralImage<T>& copy);
+
+		virtual ~IntegralImage(void);
+
+		IntegralImage<T>& operator=(const IntegralImage<T>& copy);
+		void reset(const ImgVector<T>& image, const bool squared = true);
+		void reset(const int Width, const int Height, const T* array, const bool squared = true);
+		void clear(void);
+
+		int width(void) const;
+		int height(void) const;
+		bool isNULL(void) const;
+		bool isSquared(void) const;
+
+		// Statistics of the window (clipped by the image)
+		size_t count(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const;
+		accumulator_type sum(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const;
+		double sum_squared(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const;
+		accumulator_type mean(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const;
+		double variance(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const;
+
+	protected:
+		void clip(int* x_begin, int* y_begin, int* x_end, int* y_end, const int top_left_x, const int top_left_y, const int window_width, const int window_height) const;
+		template <class U> static double squared_norm(const U& value, std::true_type);
+		template <class U> static double squared_norm(const U& value, std::false_type);
+};
+
+#include "IntegralImage_private.h"
+
+#endif
+
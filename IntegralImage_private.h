@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <stdexcept>
+
+
+
+
+// ----- Constructor -----
+template <class T>
+IntegralImage<T>::IntegralImage(void)
+{
+	_width = 0;
+	_height = 0;
+}
+
+template <class T>
+IntegralImage<T>::IntegralImage(const ImgVector<T>& image, const bool squared)
+{
+	_width = 0;
+	_height = 0;
+	this->reset(image, squared);
+}
+
+template <class T>
+IntegralImage<T>::IntegralImage(const int Width, const int Height, const T* array, const bool squared)
+{
+	_width = 0;
+	_height = 0;
+	this->reset(Width, Height, array, squared);
+}
+
+template <class T>
+IntegralImage<T>::IntegralImage(const IntegralImage<T>& copy)
+    : _sum(copy._sum), _sum_squared(copy._sum_squared)
+{
+	_width = copy._width;
+	_height = copy._height;
+}
+
+
+template <class T>
+IntegralImage<T>::~IntegralImage(void)
+{
+}
+
+
+template <class T>
+IntegralImage<T> &
+IntegralImage<T>::operator=(const IntegralImage<T>& copy)
+{
+	if (this != &copy) {
+		if (copy.isNULL()) {
+			this->clear();
+		} else {
+			_sum.copy(copy._sum);
+			if (copy.isSquared()) {
+				_sum_squared.copy(copy._sum_squared);
+			} else {
+				_sum_squared.clear();
+			}
+			_width = copy._width;
+			_height = copy._height;
+		}
+	}
+	return *this;
+}
+
+
+template <class T>
+void
+IntegralImage<T>::reset(const ImgVector<T>& image, const bool squared)
+{
+	this->reset(image.width(), image.height(), image.data(), squared);
+}
+
+/*
+ * Build the tables by the parallel prefix sums along the rows
+ * and the parallel accumulation of the rows over the strips of the columns.
+ */
+template <class T>
+void
+IntegralImage<T>::reset(const int Width, const int Height, const T* array, const bool squared)
+{
+	const int Strip = 64;
+
+	if (Width <= 0 || Height <= 0 || array == nullptr) {
+		this->clear();
+		return;
+	}
+	const int W = Width + 1;
+	_sum.reset(W, Height + 1);
+	if (squared) {
+		_sum_squared.reset(W, Height + 1);
+	} else {
+		_sum_squared.clear();
+	}
+	_width = Width;
+	_height = Height;
+	accumulator_type* sum = _sum.data();
+	double* sum_squared = squared ? _sum_squared.data() : nullptr;
+	// Prefix sums of the rows
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int y = 0; y < Height; y++) {
+		const T* src = array + size_t(Width) * size_t(y);
+		accumulator_type* row = sum + size_t(W) * size_t(y + 1);
+		accumulator_type row_sum = accumulator_type();
+		for (int x = 0; x < Width; x++) {
+			row_sum += accumulator_type(src[x]);
+			row[x + 1] = row_sum;
+		}
+		if (sum_squared != nullptr) {
+			double* row_squared = sum_squared + size_t(W) * size_t(y + 1);
+			double row_sum_squared = 0.0;
+			for (int x = 0; x < Width; x++) {
+				row_sum_squared += squared_norm(src[x], std::is_arithmetic<T>());
+				row_squared[x + 1] = row_sum_squared;
+			}
+		}
+	}
+	// Accumulate the rows
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int x_strip = 0; x_strip < W; x_strip += Strip) {
+		const int x_end = std::min(x_strip + Strip, W);
+		for (int y = 1; y <= Height; y++) {
+			accumulator_type* row = sum + size_t(W) * size_t(y);
+			const accumulator_type* row_above = row - W;
+			for (int x = x_strip; x < x_end; x++) {
+				row[x] += row_above[x];
+			}
+			if (sum_squared != nullptr) {
+				double* row_squared = sum_squared + size_t(W) * size_t(y);
+				const double* row_squared_above = row_squared - W;
+				for (int x = x_strip; x < x_end; x++) {
+					row_squared[x] += row_squared_above[x];
+				}
+			}
+		}
+	}
+}
+
+
+template <class T>
+void
+IntegralImage<T>::clear(void)
+{
+	_width = 0;
+	_height = 0;
+	_sum.clear();
+	_sum_squared.clear();
+}
+
+
+
+
+// ----- Accessors -----
+template <class T>
+int
+IntegralImage<T>::width(void) const
+{
+	return _width;
+}
+
+template <class T>
+int
+IntegralImage<T>::height(void) const
+{
+	return _height;
+}
+
+template <class T>
+bool
+IntegralImage<T>::isNULL(void) const
+{
+	if (_width == 0 || _height == 0) {
+		return true;
+	} else {
+		return false;
+	}
+}
+
+template <class T>
+bool
+IntegralImage<T>::isSquared(void) const
+{
+	return _sum_squared.isNULL() == false;
+}
+
+
+
+
+// ----- Statistics of the window -----
+template <class T>
+void
+IntegralImage<T>::clip(int* x_begin, int* y_begin, int* x_end, int* y_end, const int top_left_x, const int top_left_y, const int window_width, const int window_height) const
+{
+	*x_begin = std::min(std::max(top_left_x, 0), _width);
+	*y_begin = std::min(std::max(top_left_y, 0), _height);
+	*x_end = std::max(std::min(top_left_x + window_width, _width), *x_begin);
+	*y_end = std::max(std::min(top_left_y + window_height, _height), *y_begin);
+}
+
+
+template <class T>
+size_t
+IntegralImage<T>::count(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const
+{
+	int x_begin, y_begin, x_end, y_end;
+
+	this->clip(&x_begin, &y_begin, &x_end, &y_end, top_left_x, top_left_y, window_width, window_height);
+	return size_t(x_end - x_begin) * size_t(y_end - y_begin);
+}
+
+template <class T>
+typename IntegralImage<T>::accumulator_type
+IntegralImage<T>::sum(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const
+{
+	int x_begin, y_begin, x_end, y_end;
+
+	this->clip(&x_begin, &y_begin, &x_end, &y_end, top_left_x, top_left_y, window_width, window_height);
+	if (x_begin == x_end || y_begin == y_end) {
+		return accumulator_type();
+	}
+	return _sum.get(x_end, y_end) - _sum.get(x_begin, y_end)
+	    - _sum.get(x_end, y_begin) + _sum.get(x_begin, y_begin);
+}
+
+template <class T>
+double
+IntegralImage<T>::sum_squared(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const
+{
+	int x_begin, y_begin, x_end, y_end;
+
+	if (this->isSquared() == false) {
+		throw std::logic_error("double IntegralImage<T>::sum_squared(const int, const int, const int, const int) const : the sum of squares is not computed");
+	}
+	this->clip(&x_begin, &y_begin, &x_end, &y_end, top_left_x, top_left_y, window_width, window_height);
+	if (x_begin == x_end || y_begin == y_end) {
+		return 0.0;
+	}
+	return _sum_squared.get(x_end, y_end) - _sum_squared.get(x_begin, y_end)
+	    - _sum_squared.get(x_end, y_begin) + _sum_squared.get(x_begin, y_begin);
+}
+
+
+template <class T>
+typename IntegralImage<T>::accumulator_type
+IntegralImage<T>::mean(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const
+{
+	size_t N = this->count(top_left_x, top_left_y, window_width, window_height);
+	if (N == 0) {
+		return accumulator_type();
+	}
+	return this->sum(top_left_x, top_left_y, window_width, window_height) / double(N);
+}
+
+/*
+ * Variance of the pixels in the window.
+ * For the colors it is the sum of the variances of the channels.
+ */
+template <class T>
+double
+IntegralImage<T>::variance(const int top_left_x, const int top_left_y, const int window_width, const int window_height) const
+{
+	size_t N = this->count(top_left_x, top_left_y, window_width, window_height);
+	if (N == 0) {
+		return 0.0;
+	}
+	accumulator_type mean = this->sum(top_left_x, top_left_y, window_width, window_height) / double(N);
+	double variance = this->sum_squared(top_left_x, top_left_y, window_width, window_height) / double(N)
+	    - squared_norm(mean, std::is_arithmetic<accumulator_type>());
+	return std::max(variance, 0.0);
+}
+
+
+
+
+template <class T>
+template <class U>
+double
+IntegralImage<T>::squared_norm(const U& value, std::true_type)
+{
+	return double(value) * double(value);
+}
+
+template <class T>
+template <class U>
+double
+IntegralImage<T>::squared_norm(const U& value, std::false_type)
+{
+	return norm_squared(value);
+}
+
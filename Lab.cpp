@@ -4,6 +4,7 @@
 #include <cfloat>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 
 #include "Color.h"
@@ -40,28 +41,41 @@ namespace ImgClass {
 
 
 namespace ImgClass {
-	Lab::Lab(void)
+	template <class S>
+	basic_Lab<S>::basic_Lab(void)
 	{
 		L = 0;
 		a = 0;
 		b = 0;
 	}
 
-	Lab::Lab(const double& _L, const double& _a, const double& _b)
+	template <class S>
+	basic_Lab<S>::basic_Lab(const double& _L, const double& _a, const double& _b)
 	{
 		L = _L;
 		a = _a;
 		b = _b;
 	}
 
-	Lab::Lab(const Lab& color)
+	template <class S>
+	basic_Lab<S>::basic_Lab(const basic_Lab<S>& color)
 	{
 		L = color.L;
 		a = color.a;
 		b = color.b;
 	}
 
-	Lab::Lab(const RGB& rgb)
+	template <class S>
+	template <class S2>
+	basic_Lab<S>::basic_Lab(const basic_Lab<S2>& color)
+	{
+		L = S(color.L);
+		a = S(color.a);
+		b = S(color.b);
+	}
+
+	template <class S>
+	basic_Lab<S>::basic_Lab(const basic_RGB<S>& rgb)
 	{
 		auto f = [](double t) -> double {
 			if (t > 216.0 / 24389.0) {
@@ -70,7 +84,7 @@ namespace ImgClass {
 				return (24389.0 / 27.0 * t + 16.0) / 116.0;
 			}
 		};
-		RGB linear_sRGB(rgb);
+		basic_RGB<double> linear_sRGB(rgb);
 		linear_sRGB.gamma(2.2); // Convert sRGB to linear sRGB
 		double X = 0.4124564 * linear_sRGB.R + 0.3575761 * linear_sRGB.G + 0.1804375 * linear_sRGB.B;
 		double Y = 0.2126729 * linear_sRGB.R + 0.7151522 * linear_sRGB.G + 0.0721750 * linear_sRGB.B;
@@ -81,10 +95,11 @@ namespace ImgClass {
 	}
 
 
-	Lab &
-	Lab::set(const RGB& color)
+	template <class S>
+	basic_Lab<S> &
+	basic_Lab<S>::set(const basic_RGB<S>& color)
 	{
-		Lab tmp(color); // Convert with constructor
+		basic_Lab<S> tmp(color); // Convert with constructor
 		L = tmp.L;
 		a = tmp.a;
 		b = tmp.b;
@@ -92,14 +107,16 @@ namespace ImgClass {
 	}
 
 	// Operators
-	Lab::operator double() const
+	template <class S>
+	basic_Lab<S>::operator double() const
 	{
 		return L;
 	}
 
 
-	Lab &
-	Lab::operator=(const Lab& color)
+	template <class S>
+	basic_Lab<S> &
+	basic_Lab<S>::operator=(const basic_Lab<S>& color)
 	{
 		L = color.L;
 		a = color.a;
@@ -107,8 +124,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	Lab &
-	Lab::operator=(const double& value)
+	template <class S>
+	basic_Lab<S> &
+	basic_Lab<S>::operator=(const double& value)
 	{
 		L = value;
 		a = value;
@@ -116,8 +134,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	Lab &
-	Lab::operator+=(const Lab& color)
+	template <class S>
+	basic_Lab<S> &
+	basic_Lab<S>::operator+=(const basic_Lab<S>& color)
 	{
 		L += color.L;
 		a += color.a;
@@ -125,8 +144,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	Lab &
-	Lab::operator-=(const Lab& color)
+	template <class S>
+	basic_Lab<S> &
+	basic_Lab<S>::operator-=(const basic_Lab<S>& color)
 	{
 		L -= color.L;
 		a -= color.a;
@@ -134,8 +154,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	Lab &
-	Lab::operator*=(const Lab& color)
+	template <class S>
+	basic_Lab<S> &
+	basic_Lab<S>::operator*=(const basic_Lab<S>& color)
 	{
 		L *= color.L;
 		a *= color.a;
@@ -143,8 +164,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	Lab &
-	Lab::operator*=(const double& value)
+	template <class S>
+	basic_Lab<S> &
+	basic_Lab<S>::operator*=(const double& value)
 	{
 		L *= value;
 		a *= value;
@@ -152,8 +174,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	Lab &
-	Lab::operator/=(const Lab& color)
+	template <class S>
+	basic_Lab<S> &
+	basic_Lab<S>::operator/=(const basic_Lab<S>& color)
 	{
 		L /= color.L;
 		a /= color.a;
@@ -161,8 +184,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	Lab &
-	Lab::operator/=(const double& value)
+	template <class S>
+	basic_Lab<S> &
+	basic_Lab<S>::operator/=(const double& value)
 	{
 		L /= value;
 		a /= value;
@@ -176,14 +200,16 @@ namespace ImgClass {
 
 // Arithmetic
 
-const ImgClass::Lab
-operator+(ImgClass::Lab color)
+template <class S>
+const ImgClass::basic_Lab<S>
+operator+(ImgClass::basic_Lab<S> color)
 {
 	return color;
 }
 
-const ImgClass::Lab
-operator-(ImgClass::Lab color)
+template <class S>
+const ImgClass::basic_Lab<S>
+operator-(ImgClass::basic_Lab<S> color)
 {
 	color.L = -color.L;
 	color.a = -color.a;
@@ -195,24 +221,26 @@ operator-(ImgClass::Lab color)
 
 
 // Comparator
+template <class S>
 bool
-operator==(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor)
+operator==(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor)
 {
-	if (fabs(lcolor.L - rcolor.L) <= DBL_EPSILON
-	    && fabs(lcolor.a - rcolor.a) <= DBL_EPSILON
-	    && fabs(lcolor.b - rcolor.b) <= DBL_EPSILON) {
+	if (fabs(lcolor.L - rcolor.L) <= std::numeric_limits<S>::epsilon()
+	    && fabs(lcolor.a - rcolor.a) <= std::numeric_limits<S>::epsilon()
+	    && fabs(lcolor.b - rcolor.b) <= std::numeric_limits<S>::epsilon()) {
 		return true;
 	} else {
 		return false;
 	}
 }
 
+template <class S>
 bool
-operator!=(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor)
+operator!=(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor)
 {
-	if (fabs(lcolor.L - rcolor.L) > DBL_EPSILON
-	    || fabs(lcolor.a - rcolor.a) > DBL_EPSILON
-	    || fabs(lcolor.b - rcolor.b) > DBL_EPSILON) {
+	if (fabs(lcolor.L - rcolor.L) > std::numeric_limits<S>::epsilon()
+	    || fabs(lcolor.a - rcolor.a) > std::numeric_limits<S>::epsilon()
+	    || fabs(lcolor.b - rcolor.b) > std::numeric_limits<S>::epsilon()) {
 		return true;
 	} else {
 		return false;
@@ -220,8 +248,9 @@ operator!=(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor)
 }
 
 
+template <class S>
 bool
-operator<(const ImgClass::Lab& lcolor, const double& rvalue)
+operator<(const ImgClass::basic_Lab<S>& lcolor, const double& rvalue)
 {
 	if (lcolor.L * lcolor.L + lcolor.a * lcolor.a + lcolor.b * lcolor.b
 	    < rvalue * rvalue) {
@@ -231,8 +260,9 @@ operator<(const ImgClass::Lab& lcolor, const double& rvalue)
 	}
 }
 
+template <class S>
 bool
-operator<(const double& lvalue, const ImgClass::Lab& rcolor)
+operator<(const double& lvalue, const ImgClass::basic_Lab<S>& rcolor)
 {
 	if (lvalue * lvalue
 	    <rcolor.L * rcolor.L + rcolor.a * rcolor.a + rcolor.b * rcolor.b) {
@@ -242,8 +272,9 @@ operator<(const double& lvalue, const ImgClass::Lab& rcolor)
 	}
 }
 
+template <class S>
 bool
-operator>(const ImgClass::Lab& lcolor, const double& rvalue)
+operator>(const ImgClass::basic_Lab<S>& lcolor, const double& rvalue)
 {
 	if (lcolor.L * lcolor.L + lcolor.a * lcolor.a + lcolor.b * lcolor.b
 	    > rvalue * rvalue) {
@@ -253,8 +284,9 @@ operator>(const ImgClass::Lab& lcolor, const double& rvalue)
 	}
 }
 
+template <class S>
 bool
-operator>(const double& lvalue, const ImgClass::Lab& rcolor)
+operator>(const double& lvalue, const ImgClass::basic_Lab<S>& rcolor)
 {
 	if (lvalue * lvalue
 	    > rcolor.L * rcolor.L + rcolor.a * rcolor.a + rcolor.b * rcolor.b) {
@@ -267,9 +299,11 @@ operator>(const double& lvalue, const ImgClass::Lab& rcolor)
 
 
 // Arithmetic operators
-ImgClass::Lab operator+(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor)
+template <class S>
+ImgClass::basic_Lab<S>
+operator+(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor)
 {
-	ImgClass::Lab color;
+	ImgClass::basic_Lab<S> color;
 
 	color.L = lcolor.L + rcolor.L;
 	color.a = lcolor.a + rcolor.a;
@@ -278,9 +312,11 @@ ImgClass::Lab operator+(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor
 }
 
 
-ImgClass::Lab operator-(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor)
+template <class S>
+ImgClass::basic_Lab<S>
+operator-(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor)
 {
-	ImgClass::Lab color;
+	ImgClass::basic_Lab<S> color;
 
 	color.L = lcolor.L - rcolor.L;
 	color.a = lcolor.a - rcolor.a;
@@ -289,9 +325,11 @@ ImgClass::Lab operator-(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor
 }
 
 
-ImgClass::Lab operator*(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor)
+template <class S>
+ImgClass::basic_Lab<S>
+operator*(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor)
 {
-	ImgClass::Lab color;
+	ImgClass::basic_Lab<S> color;
 
 	color.L = lcolor.L * rcolor.L;
 	color.a = lcolor.a * rcolor.a;
@@ -299,9 +337,11 @@ ImgClass::Lab operator*(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor
 	return color;
 }
 
-ImgClass::Lab operator*(const ImgClass::Lab& lcolor, const double& rvalue)
+template <class S>
+ImgClass::basic_Lab<S>
+operator*(const ImgClass::basic_Lab<S>& lcolor, const double& rvalue)
 {
-	ImgClass::Lab color;
+	ImgClass::basic_Lab<S> color;
 
 	color.L = lcolor.L * rvalue;
 	color.a = lcolor.a * rvalue;
@@ -309,9 +349,11 @@ ImgClass::Lab operator*(const ImgClass::Lab& lcolor, const double& rvalue)
 	return color;
 }
 
-ImgClass::Lab operator*(const double& lvalue, const ImgClass::Lab& rcolor)
+template <class S>
+ImgClass::basic_Lab<S>
+operator*(const double& lvalue, const ImgClass::basic_Lab<S>& rcolor)
 {
-	ImgClass::Lab color;
+	ImgClass::basic_Lab<S> color;
 
 	color.L = lvalue * rcolor.L;
 	color.a = lvalue * rcolor.a;
@@ -320,9 +362,11 @@ ImgClass::Lab operator*(const double& lvalue, const ImgClass::Lab& rcolor)
 }
 
 
-ImgClass::Lab operator/(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor)
+template <class S>
+ImgClass::basic_Lab<S>
+operator/(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor)
 {
-	ImgClass::Lab color;
+	ImgClass::basic_Lab<S> color;
 
 	color.L = lcolor.L / rcolor.L;
 	color.a = lcolor.a / rcolor.a;
@@ -330,9 +374,11 @@ ImgClass::Lab operator/(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor
 	return color;
 }
 
-ImgClass::Lab operator/(const ImgClass::Lab& lcolor, const double& rvalue)
+template <class S>
+ImgClass::basic_Lab<S>
+operator/(const ImgClass::basic_Lab<S>& lcolor, const double& rvalue)
 {
-	ImgClass::Lab color;
+	ImgClass::basic_Lab<S> color;
 
 	color.L = lcolor.L / rvalue;
 	color.a = lcolor.a / rvalue;
@@ -343,10 +389,11 @@ ImgClass::Lab operator/(const ImgClass::Lab& lcolor, const double& rvalue)
 
 
 
-const ImgClass::Lab
-abs(const ImgClass::Lab& color)
+template <class S>
+const ImgClass::basic_Lab<S>
+abs(const ImgClass::basic_Lab<S>& color)
 {
-	ImgClass::Lab ret;
+	ImgClass::basic_Lab<S> ret;
 
 	ret.L = fabs(color.L);
 	ret.a = fabs(color.a);
@@ -356,8 +403,9 @@ abs(const ImgClass::Lab& color)
 
 
 // Product
+template <class S>
 double
-inner_prod(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor)
+inner_prod(const ImgClass::basic_Lab<S>& lcolor, const ImgClass::basic_Lab<S>& rcolor)
 {
 	return lcolor.L * rcolor.L
 	    + lcolor.a * rcolor.a
@@ -366,16 +414,18 @@ inner_prod(const ImgClass::Lab& lcolor, const ImgClass::Lab& rcolor)
 
 
 // Norm
+template <class S>
 double
-norm_squared(const ImgClass::Lab& color)
+norm_squared(const ImgClass::basic_Lab<S>& color)
 {
 	return color.L * color.L
 	    + color.a * color.a
 	    + color.b * color.b;
 }
 
+template <class S>
 double
-norm(const ImgClass::Lab& color)
+norm(const ImgClass::basic_Lab<S>& color)
 {
 	return sqrt(color.L * color.L
 	    + color.a * color.a
@@ -384,10 +434,11 @@ norm(const ImgClass::Lab& color)
 
 
 // Saturation
-ImgClass::Lab
-saturate(const ImgClass::Lab& value, const double& min, const double& max)
+template <class S>
+ImgClass::basic_Lab<S>
+saturate(const ImgClass::basic_Lab<S>& value, const double& min, const double& max)
 {
-	ImgClass::Lab ret(value);
+	ImgClass::basic_Lab<S> ret(value);
 	auto lambda = [&min, &max](const double& val) -> double {
 		if (val < min) {
 			return min;
@@ -405,10 +456,11 @@ saturate(const ImgClass::Lab& value, const double& min, const double& max)
 
 
 // Quantization
-ImgClass::Lab
-color_quantize(const ImgClass::Lab& value)
+template <class S>
+ImgClass::basic_Lab<S>
+color_quantize(const ImgClass::basic_Lab<S>& value)
 {
-	ImgClass::Lab ret;
+	ImgClass::basic_Lab<S> ret;
 	ret.L = round(value.L);
 	ret.a = round(value.a);
 	ret.b = round(value.b);
@@ -417,10 +469,64 @@ color_quantize(const ImgClass::Lab& value)
 
 
 // Stream
+template <class S>
 std::ostream &
-operator<<(std::ostream& os, const ImgClass::Lab& rcolor)
+operator<<(std::ostream& os, const ImgClass::basic_Lab<S>& rcolor)
 {
 	os << "[L*:" << rcolor.L << " a*:" << rcolor.a << " b*:" << rcolor.b << "]";
 	return os;
 }
 
+
+
+// ----- Explicit instantiation -----
+template class ImgClass::basic_Lab<double>;
+template class ImgClass::basic_Lab<float>;
+template ImgClass::basic_Lab<double>::basic_Lab(const ImgClass::basic_Lab<float>& color);
+template ImgClass::basic_Lab<float>::basic_Lab(const ImgClass::basic_Lab<double>& color);
+
+template const ImgClass::basic_Lab<double> operator+(ImgClass::basic_Lab<double> color);
+template const ImgClass::basic_Lab<double> operator-(ImgClass::basic_Lab<double> color);
+template bool operator==(const ImgClass::basic_Lab<double>& lcolor, const ImgClass::basic_Lab<double>& rcolor);
+template bool operator!=(const ImgClass::basic_Lab<double>& lcolor, const ImgClass::basic_Lab<double>& rcolor);
+template bool operator<(const ImgClass::basic_Lab<double>& lcolor, const double& rvalue);
+template bool operator<(const double& lvalue, const ImgClass::basic_Lab<double>& rcolor);
+template bool operator>(const ImgClass::basic_Lab<double>& lcolor, const double& rvalue);
+template bool operator>(const double& lvalue, const ImgClass::basic_Lab<double>& rcolor);
+template ImgClass::basic_Lab<double> operator+(const ImgClass::basic_Lab<double>& lcolor, const ImgClass::basic_Lab<double>& rcolor);
+template ImgClass::basic_Lab<double> operator-(const ImgClass::basic_Lab<double>& lcolor, const ImgClass::basic_Lab<double>& rcolor);
+template ImgClass::basic_Lab<double> operator*(const ImgClass::basic_Lab<double>& lcolor, const ImgClass::basic_Lab<double>& rcolor);
+template ImgClass::basic_Lab<double> operator*(const ImgClass::basic_Lab<double>& lcolor, const double& rvalue);
+template ImgClass::basic_Lab<double> operator*(const double& lvalue, const ImgClass::basic_Lab<double>& rcolor);
+template ImgClass::basic_Lab<double> operator/(const ImgClass::basic_Lab<double>& lcolor, const ImgClass::basic_Lab<double>& rcolor);
+template ImgClass::basic_Lab<double> operator/(const ImgClass::basic_Lab<double>& lcolor, const double& rvalue);
+template const ImgClass::basic_Lab<double> abs(const ImgClass::basic_Lab<double>& color);
+template double inner_prod(const ImgClass::basic_Lab<double>& lcolor, const ImgClass::basic_Lab<double>& rcolor);
+template double norm_squared(const ImgClass::basic_Lab<double>& color);
+template double norm(const ImgClass::basic_Lab<double>& color);
+template ImgClass::basic_Lab<double> saturate(const ImgClass::basic_Lab<double>& value, const double& min, const double& max);
+template ImgClass::basic_Lab<double> color_quantize(const ImgClass::basic_Lab<double>& value);
+template std::ostream& operator<<(std::ostream& os, const ImgClass::basic_Lab<double>& rcolor);
+
+template const ImgClass::basic_Lab<float> operator+(ImgClass::basic_Lab<float> color);
+template const ImgClass::basic_Lab<float> operator-(ImgClass::basic_Lab<float> color);
+template bool operator==(const ImgClass::basic_Lab<float>& lcolor, const ImgClass::basic_Lab<float>& rcolor);
+template bool operator!=(const ImgClass::basic_Lab<float>& lcolor, const ImgClass::basic_Lab<float>& rcolor);
+template bool operator<(const ImgClass::basic_Lab<float>& lcolor, const double& rvalue);
+template bool operator<(const double& lvalue, const ImgClass::basic_Lab<float>& rcolor);
+template bool operator>(const ImgClass::basic_Lab<float>& lcolor, const double& rvalue);
+template bool operator>(const double& lvalue, const ImgClass::basic_Lab<float>& rcolor);
+template ImgClass::basic_Lab<float> operator+(const ImgClass::basic_Lab<float>& lcolor, const ImgClass::basic_Lab<float>& rcolor);
+template ImgClass::basic_Lab<float> operator-(const ImgClass::basic_Lab<float>& lcolor, const ImgClass::basic_Lab<float>& rcolor);
+template ImgClass::basic_Lab<float> operator*(const ImgClass::basic_Lab<float>& lcolor, const ImgClass::basic_Lab<float>& rcolor);
+template ImgClass::basic_Lab<float> operator*(const ImgClass::basic_Lab<float>& lcolor, const double& rvalue);
+template ImgClass::basic_Lab<float> operator*(const double& lvalue, const ImgClass::basic_Lab<float>& rcolor);
+template ImgClass::basic_Lab<float> operator/(const ImgClass::basic_Lab<float>& lcolor, const ImgClass::basic_Lab<float>& rcolor);
+template ImgClass::basic_Lab<float> operator/(const ImgClass::basic_Lab<float>& lcolor, const double& rvalue);
+template const ImgClass::basic_Lab<float> abs(const ImgClass::basic_Lab<float>& color);
+template double inner_prod(const ImgClass::basic_Lab<float>& lcolor, const ImgClass::basic_Lab<float>& rcolor);
+template double norm_squared(const ImgClass::basic_Lab<float>& color);
+template double norm(const ImgClass::basic_Lab<float>& color);
+template ImgClass::basic_Lab<float> saturate(const ImgClass::basic_Lab<float>& value, const double& min, const double& max);
+template ImgClass::basic_Lab<float> color_quantize(const ImgClass::basic_Lab<float>& value);
+template std::ostream& operator<<(std::ostream& os, const ImgClass::basic_Lab<float>& rcolor);
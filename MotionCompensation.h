@@ -19,6 +19,7 @@ class MotionCompensation
 		ImgVector<VECTOR_2D<double> > _vector_next;
 		ImgVector<Vector_ST<double> > _vector_time;
 		ImgVector<T> _image_compensated;
+		ImgKernel _kernel; // Interpolation of the reference frames (bicubic by default)
 
 	public:
 		MotionCompensation(void);
@@ -35,10 +36,14 @@ class MotionCompensation
 		MotionCompensation& set(const ImgVector<T>& image_prev, const ImgVector<T>& image_current, const ImgVector<T>& image_next, const std::vector<ImgVector<Vector_ST<double> > >& vectors);
 		MotionCompensation& set(const ImgVector<T>& image_prev, const ImgVector<T>& image_current, const ImgVector<T>& image_next, const ImgVector<Vector_ST<double> >& vector_time);
 
+		// Select the interpolation (e.g. ImgKernel::bilinear() for the preview, ImgKernel::lanczos(3) for the output)
+		MotionCompensation& set_kernel(const ImgKernel& kernel); // The compensated image is created again
+
 		// Accessor
 		// * parameter
 		int width(void) const;
 		int height(void) const;
+		const ImgKernel& kernel(void) const;
 
 		// * reference
 		const ImgVector<VECTOR_2D<double> >& ref_vector_prev(void) const;
@@ -26,6 +26,7 @@ MotionCompensation<T>::MotionCompensation(const MotionCompensation &copy) // cop
 	_vector_time.copy(copy._vector_time);
 
 	_image_compensated.copy(copy._image_compensated);
+	_kernel = copy._kernel;
 }
 
 
@@ -212,6 +213,7 @@ MotionCompensation<T>::copy(const MotionCompensation &copy)
 	_vector_next.copy(copy._vector_next);
 
 	_image_compensated.copy(copy._image_compensated);
+	_kernel = copy._kernel;
 	return *this;
 }
 
@@ -398,6 +400,20 @@ MotionCompensation<T>::set(const ImgVector<T>& image_prev, const ImgVector<T>& i
 
 
 
+template <class T>
+MotionCompensation<T> &
+MotionCompensation<T>::set_kernel(const ImgKernel& kernel)
+{
+	_kernel = kernel;
+	if (_image_prev.isNULL() == false) {
+		this->create_image_compensated();
+	}
+	return *this;
+}
+
+
+
+
 template <class T>
 int
 MotionCompensation<T>::width(void) const
@@ -412,6 +428,13 @@ MotionCompensation<T>::height(void) const
 	return _height;
 }
 
+template <class T>
+const ImgKernel &
+MotionCompensation<T>::kernel(void) const
+{
+	return _kernel;
+}
+
 // Reference
 template <class T>
 const ImgVector<VECTOR_2D<double> > &
@@ -570,37 +593,68 @@ template <class T>
 void
 MotionCompensation<T>::create_image_compensated(void)
 {
-	VECTOR_2D<double> r;
-	VECTOR_2D<double> r_next;
+	typedef typename ImgPromote<T>::type promoted_type;
+
 	_image_compensated.reset(_width, _height);
-	for (int y = 0; y < _height; y++) {
-		for (int x = 0; x < _width; x++) {
-			if (_vector_time.isNULL()) {
-				if (_vector_next.isNULL()) { // Forward motion compensation
-					r.x = x + _vector_prev.get(x, y).x;
-					r.y = y + _vector_prev.get(x, y).y;
-					_image_compensated.at(x, y) = _image_prev.get_zeropad_cubic(r.x, r.y);
-				} else { // Mean bi-directional motion compensation
-					r.x = x + _vector_prev.get(x, y).x;
-					r.y = y + _vector_prev.get(x, y).y;
-					r_next.x = x + _vector_next.get(x, y).x;
-					r_next.y = y + _vector_next.get(x, y).y;
-					_image_compensated.at(x, y) =
-					    (_image_prev.get_zeropad_cubic(r.x, r.y) + _image_prev.get_zeropad_cubic(r.x, r.y)) * 0.5;
-				}
-			} else {
-				r.x = x + _vector_time.get(x, y).x;
-				r.y = y + _vector_time.get(x, y).y;
-				if (_vector_time.get(x, y).t < 0) {
-					_image_compensated.at(x, y) = _image_prev.get_zeropad_cubic(r.x, r.y);
+	T* compensated = _image_compensated.data();
+	// The pixels of each row are sampled by a batch of the coordinates of each reference frame
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		std::vector<int> column_prev(static_cast<size_t>(_width));
+		std::vector<double> x_prev(static_cast<size_t>(_width));
+		std::vector<double> y_prev(static_cast<size_t>(_width));
+		std::vector<promoted_type> values_prev(static_cast<size_t>(_width));
+		std::vector<int> column_next(static_cast<size_t>(_width));
+		std::vector<double> x_next(static_cast<size_t>(_width));
+		std::vector<double> y_next(static_cast<size_t>(_width));
+		std::vector<promoted_type> values_next(static_cast<size_t>(_width));
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for (int y = 0; y < _height; y++) {
+			T* row = compensated + size_t(_width) * size_t(y);
+			size_t n_prev = 0;
+			size_t n_next = 0;
+			for (int x = 0; x < _width; x++) {
+				if (_vector_time.isNULL()) { // Forward or mean bi-directional motion compensation
+					column_prev[n_prev] = x;
+					x_prev[n_prev] = x + _vector_prev.get(x, y).x;
+					y_prev[n_prev] = y + _vector_prev.get(x, y).y;
+					n_prev++;
+				} else if (_vector_time.get(x, y).t < 0) {
+					column_prev[n_prev] = x;
+					x_prev[n_prev] = x + _vector_time.get(x, y).x;
+					y_prev[n_prev] = y + _vector_time.get(x, y).y;
+					n_prev++;
 				} else {
 #ifdef IMG_CLASS_BLOCKMATCHING_OCCLUSION_ZEROPAD
-					_image_compensated.at(x, y) = 0;
+					row[x] = 0;
 #else
-					_image_compensated.at(x, y) = _image_next.get_zeropad_cubic(r.x, r.y);
+					column_next[n_next] = x;
+					x_next[n_next] = x + _vector_time.get(x, y).x;
+					y_next[n_next] = y + _vector_time.get(x, y).y;
+					n_next++;
 #endif
 				}
 			}
+			_image_prev.sample_zeropad(values_prev.data(), x_prev.data(), y_prev.data(), n_prev, _kernel);
+			if (_vector_time.isNULL() && _vector_next.isNULL() == false) { // Mean bi-directional motion compensation
+				for (size_t n = 0; n < n_prev; n++) {
+					row[column_prev[n]] = ImgPromote<T>::demote(promoted_type((values_prev[n] + values_prev[n]) * 0.5));
+				}
+			} else {
+				for (size_t n = 0; n < n_prev; n++) {
+					row[column_prev[n]] = ImgPromote<T>::demote(values_prev[n]);
+				}
+			}
+			if (n_next > 0) {
+				_image_next.sample_zeropad(values_next.data(), x_next.data(), y_next.data(), n_next, _kernel);
+				for (size_t n = 0; n < n_next; n++) {
+					row[column_next[n]] = ImgPromote<T>::demote(values_next[n]);
+				}
+			}
 		}
 	}
 }
@@ -2,33 +2,47 @@
 #include <cmath>
 #include <stdexcept>
 #include <iostream>
+#include <limits>
 
 #include "Color.h"
 
 
 namespace ImgClass {
-	RGB::RGB(void)
+	template <class S>
+	basic_RGB<S>::basic_RGB(void)
 	{
 		R = 0;
 		G = 0;
 		B = 0;
 	}
 
-	RGB::RGB(const double& red, const double& green, const double& blue)
+	template <class S>
+	basic_RGB<S>::basic_RGB(const double& red, const double& green, const double& blue)
 	{
 		R = red;
 		G = green;
 		B = blue;
 	}
 
-	RGB::RGB(const RGB& rgb)
+	template <class S>
+	basic_RGB<S>::basic_RGB(const basic_RGB<S>& rgb)
 	{
 		R = rgb.R;
 		G = rgb.G;
 		B = rgb.B;
 	}
 
-	RGB::RGB(const HSV& hsv)
+	template <class S>
+	template <class S2>
+	basic_RGB<S>::basic_RGB(const basic_RGB<S2>& rgb)
+	{
+		R = S(rgb.R);
+		G = S(rgb.G);
+		B = S(rgb.B);
+	}
+
+	template <class S>
+	basic_RGB<S>::basic_RGB(const HSV& hsv)
 	{
 		double C = hsv.V * hsv.S;
 		double X = C * (1.0 - fabs(fmod(hsv.H * 6.0, 2.0) - 1.0));
@@ -37,16 +51,17 @@ namespace ImgClass {
 		G = hsv.V - C;
 		B = hsv.V - C;
 		switch (int(floor(hsv.H * 6.0))) {
-			case 0: *this += RGB(C, X, 0); break;
-			case 1: *this += RGB(X, C, 0); break;
-			case 2: *this += RGB(0, C, X); break;
-			case 3: *this += RGB(0, X, C); break;
-			case 4: *this += RGB(X, 0, C); break;
-			case 5: *this += RGB(C, 0, X);
+			case 0: *this += basic_RGB<S>(C, X, 0); break;
+			case 1: *this += basic_RGB<S>(X, C, 0); break;
+			case 2: *this += basic_RGB<S>(0, C, X); break;
+			case 3: *this += basic_RGB<S>(0, X, C); break;
+			case 4: *this += basic_RGB<S>(X, 0, C); break;
+			case 5: *this += basic_RGB<S>(C, 0, X);
 		}
 	}
 
-	RGB::RGB(const Lab& lab)
+	template <class S>
+	basic_RGB<S>::basic_RGB(const basic_Lab<S>& lab)
 	{
 		auto f_inv = [](double t_inv) -> double {
 			if (t_inv > 6.0 / 29.0) {
@@ -73,8 +88,9 @@ namespace ImgClass {
 	}
 
 
-	RGB &
-	RGB::set(const double& red, const double& green, const double& blue)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::set(const double& red, const double& green, const double& blue)
 	{
 		R = red;
 		G = green;
@@ -83,8 +99,9 @@ namespace ImgClass {
 	}
 
 
-	RGB &
-	RGB::gamma(const double& gamma_val)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::gamma(const double& gamma_val)
 	{
 		R = pow(R, gamma_val);
 		G = pow(G, gamma_val);
@@ -96,7 +113,8 @@ namespace ImgClass {
 
 
 	// Operators
-	RGB::operator double() const // return intensity
+	template <class S>
+	basic_RGB<S>::operator double() const // return intensity
 	{
 		const double yum_y_red = 0.299;
 		const double yum_y_green = 0.587;
@@ -106,8 +124,9 @@ namespace ImgClass {
 	}
 
 
-	RGB &
-	RGB::operator=(const RGB& rcolor)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator=(const basic_RGB<S>& rcolor)
 	{
 		R = rcolor.R;
 		G = rcolor.G;
@@ -115,8 +134,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	RGB &
-	RGB::operator=(const double& rvalue)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator=(const double& rvalue)
 	{
 		R = rvalue;
 		G = rvalue;
@@ -125,8 +145,9 @@ namespace ImgClass {
 	}
 
 
-	RGB &
-	RGB::operator+=(const RGB& rcolor)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator+=(const basic_RGB<S>& rcolor)
 	{
 		R += rcolor.R;
 		G += rcolor.G;
@@ -134,8 +155,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	RGB &
-	RGB::operator+=(const double& rvalue)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator+=(const double& rvalue)
 	{
 		R += rvalue;
 		G += rvalue;
@@ -143,8 +165,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	RGB &
-	RGB::operator-=(const RGB& rcolor)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator-=(const basic_RGB<S>& rcolor)
 	{
 		R -= rcolor.R;
 		G -= rcolor.G;
@@ -152,8 +175,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	RGB &
-	RGB::operator-=(const double& rvalue)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator-=(const double& rvalue)
 	{
 		R -= rvalue;
 		G -= rvalue;
@@ -161,8 +185,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	RGB &
-	RGB::operator*=(const RGB& rcolor)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator*=(const basic_RGB<S>& rcolor)
 	{
 		R *= rcolor.R;
 		G *= rcolor.G;
@@ -170,8 +195,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	RGB &
-	RGB::operator*=(const double& rvalue)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator*=(const double& rvalue)
 	{
 		R *= rvalue;
 		G *= rvalue;
@@ -179,8 +205,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	RGB &
-	RGB::operator/=(const RGB& rcolor)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator/=(const basic_RGB<S>& rcolor)
 	{
 		R /= rcolor.R;
 		G /= rcolor.G;
@@ -188,8 +215,9 @@ namespace ImgClass {
 		return *this;
 	}
 
-	RGB &
-	RGB::operator/=(const double& rvalue)
+	template <class S>
+	basic_RGB<S> &
+	basic_RGB<S>::operator/=(const double& rvalue)
 	{
 		R /= rvalue;
 		G /= rvalue;
@@ -205,14 +233,16 @@ namespace ImgClass {
 
 // Arithmetic
 
-const ImgClass::RGB
-operator+(ImgClass::RGB rcolor)
+template <class S>
+const ImgClass::basic_RGB<S>
+operator+(ImgClass::basic_RGB<S> rcolor)
 {
 	return rcolor;
 }
 
-const ImgClass::RGB
-operator-(ImgClass::RGB rcolor)
+template <class S>
+const ImgClass::basic_RGB<S>
+operator-(ImgClass::basic_RGB<S> rcolor)
 {
 	rcolor.R = -rcolor.R;
 	rcolor.G = -rcolor.G;
@@ -221,20 +251,22 @@ operator-(ImgClass::RGB rcolor)
 }
 
 
-const ImgClass::RGB
-operator+(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
+template <class S>
+const ImgClass::basic_RGB<S>
+operator+(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor)
 {
-	ImgClass::RGB color;
+	ImgClass::basic_RGB<S> color;
 	color.R = lcolor.R + rcolor.R;
 	color.G = lcolor.G + rcolor.G;
 	color.B = lcolor.B + rcolor.B;
 	return color;
 }
 
-const ImgClass::RGB
-operator-(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
+template <class S>
+const ImgClass::basic_RGB<S>
+operator-(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor)
 {
-	ImgClass::RGB color;
+	ImgClass::basic_RGB<S> color;
 	color.R = lcolor.R - rcolor.R;
 	color.G = lcolor.G - rcolor.G;
 	color.B = lcolor.B - rcolor.B;
@@ -242,50 +274,55 @@ operator-(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
 }
 
 
-const ImgClass::RGB
-operator*(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
+template <class S>
+const ImgClass::basic_RGB<S>
+operator*(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor)
 {
-	ImgClass::RGB color;
+	ImgClass::basic_RGB<S> color;
 	color.R = lcolor.R * rcolor.R;
 	color.G = lcolor.G * rcolor.G;
 	color.B = lcolor.B * rcolor.B;
 	return color;
 }
 
-const ImgClass::RGB
-operator*(const ImgClass::RGB& lcolor, const double& rvalue)
+template <class S>
+const ImgClass::basic_RGB<S>
+operator*(const ImgClass::basic_RGB<S>& lcolor, const double& rvalue)
 {
-	ImgClass::RGB color;
+	ImgClass::basic_RGB<S> color;
 	color.R = lcolor.R * rvalue;
 	color.G = lcolor.G * rvalue;
 	color.B = lcolor.B * rvalue;
 	return color;
 }
 
-const ImgClass::RGB
-operator*(const double& lvalue, const ImgClass::RGB& rcolor)
+template <class S>
+const ImgClass::basic_RGB<S>
+operator*(const double& lvalue, const ImgClass::basic_RGB<S>& rcolor)
 {
-	ImgClass::RGB color;
+	ImgClass::basic_RGB<S> color;
 	color.R = lvalue * rcolor.R;
 	color.G = lvalue * rcolor.G;
 	color.B = lvalue * rcolor.B;
 	return color;
 }
 
-const ImgClass::RGB
-operator/(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
+template <class S>
+const ImgClass::basic_RGB<S>
+operator/(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor)
 {
-	ImgClass::RGB color;
+	ImgClass::basic_RGB<S> color;
 	color.R = lcolor.R / rcolor.R;
 	color.G = lcolor.G / rcolor.G;
 	color.B = lcolor.B / rcolor.B;
 	return color;
 }
 
-const ImgClass::RGB
-operator/(const ImgClass::RGB& lcolor, const double& rvalue)
+template <class S>
+const ImgClass::basic_RGB<S>
+operator/(const ImgClass::basic_RGB<S>& lcolor, const double& rvalue)
 {
-	ImgClass::RGB color;
+	ImgClass::basic_RGB<S> color;
 	color.R = lcolor.R / rvalue;
 	color.G = lcolor.G / rvalue;
 	color.B = lcolor.B / rvalue;
@@ -294,24 +331,26 @@ operator/(const ImgClass::RGB& lcolor, const double& rvalue)
 
 
 // Comparator
+template <class S>
 bool
-operator==(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
+operator==(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor)
 {
-	if (fabs(lcolor.R - rcolor.R) <= DBL_EPSILON
-	    && fabs(lcolor.G - rcolor.G) <= DBL_EPSILON
-	    && fabs(lcolor.B - rcolor.B) <= DBL_EPSILON) {
+	if (fabs(lcolor.R - rcolor.R) <= std::numeric_limits<S>::epsilon()
+	    && fabs(lcolor.G - rcolor.G) <= std::numeric_limits<S>::epsilon()
+	    && fabs(lcolor.B - rcolor.B) <= std::numeric_limits<S>::epsilon()) {
 		return true;
 	} else {
 		return false;
 	}
 }
 
+template <class S>
 bool
-operator!=(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
+operator!=(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor)
 {
-	if (fabs(lcolor.R - rcolor.R) > DBL_EPSILON
-	    || fabs(lcolor.G - rcolor.G) > DBL_EPSILON
-	    || fabs(lcolor.B - rcolor.B) > DBL_EPSILON) {
+	if (fabs(lcolor.R - rcolor.R) > std::numeric_limits<S>::epsilon()
+	    || fabs(lcolor.G - rcolor.G) > std::numeric_limits<S>::epsilon()
+	    || fabs(lcolor.B - rcolor.B) > std::numeric_limits<S>::epsilon()) {
 		return true;
 	} else {
 		return false;
@@ -320,8 +359,9 @@ operator!=(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
 
 
 // Product
+template <class S>
 double
-inner_prod(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
+inner_prod(const ImgClass::basic_RGB<S>& lcolor, const ImgClass::basic_RGB<S>& rcolor)
 {
 	return lcolor.R * rcolor.R
 	    + lcolor.G * rcolor.G
@@ -330,16 +370,18 @@ inner_prod(const ImgClass::RGB& lcolor, const ImgClass::RGB& rcolor)
 
 
 // Norm
+template <class S>
 double
-norm_squared(const ImgClass::RGB& color)
+norm_squared(const ImgClass::basic_RGB<S>& color)
 {
 	return color.R * color.R
 	    + color.G * color.G
 	    + color.B * color.B;
 }
 
+template <class S>
 double
-norm(const ImgClass::RGB& color)
+norm(const ImgClass::basic_RGB<S>& color)
 {
 	return sqrt(color.R * color.R
 	    + color.G * color.G
@@ -350,10 +392,11 @@ norm(const ImgClass::RGB& color)
 
 
 // Saturation
-ImgClass::RGB
-saturate(const ImgClass::RGB& value, const double& min, const double& max)
+template <class S>
+ImgClass::basic_RGB<S>
+saturate(const ImgClass::basic_RGB<S>& value, const double& min, const double& max)
 {
-	ImgClass::RGB ret(value);
+	ImgClass::basic_RGB<S> ret(value);
 	auto lambda = [&min, &max](const double& val) -> double {
 		if (val < min) {
 			return min;
@@ -371,10 +414,11 @@ saturate(const ImgClass::RGB& value, const double& min, const double& max)
 
 
 // Quantization
-ImgClass::RGB
-color_quantize(const ImgClass::RGB &value, const double &max)
+template <class S>
+ImgClass::basic_RGB<S>
+color_quantize(const ImgClass::basic_RGB<S>& value, const double &max)
 {
-	ImgClass::RGB ret;
+	ImgClass::basic_RGB<S> ret;
 	ret.R = round(max * value.R);
 	ret.G = round(max * value.G);
 	ret.B = round(max * value.B);
@@ -383,10 +427,54 @@ color_quantize(const ImgClass::RGB &value, const double &max)
 
 
 // Stream
+template <class S>
 std::ostream &
-operator<<(std::ostream& os, const ImgClass::RGB& rcolor)
+operator<<(std::ostream& os, const ImgClass::basic_RGB<S>& rcolor)
 {
 	os << "[R:" << rcolor.R << " G:" << rcolor.G << " B:" << rcolor.B << "]";
 	return os;
 }
 
+
+
+// ----- Explicit instantiation -----
+template class ImgClass::basic_RGB<double>;
+template class ImgClass::basic_RGB<float>;
+template ImgClass::basic_RGB<double>::basic_RGB(const ImgClass::basic_RGB<float>& rgb);
+template ImgClass::basic_RGB<float>::basic_RGB(const ImgClass::basic_RGB<double>& rgb);
+
+template const ImgClass::basic_RGB<double> operator+(ImgClass::basic_RGB<double> rcolor);
+template const ImgClass::basic_RGB<double> operator-(ImgClass::basic_RGB<double> rcolor);
+template const ImgClass::basic_RGB<double> operator+(const ImgClass::basic_RGB<double>& lcolor, const ImgClass::basic_RGB<double>& rcolor);
+template const ImgClass::basic_RGB<double> operator-(const ImgClass::basic_RGB<double>& lcolor, const ImgClass::basic_RGB<double>& rcolor);
+template const ImgClass::basic_RGB<double> operator*(const ImgClass::basic_RGB<double>& lcolor, const ImgClass::basic_RGB<double>& rcolor);
+template const ImgClass::basic_RGB<double> operator*(const ImgClass::basic_RGB<double>& lcolor, const double& rvalue);
+template const ImgClass::basic_RGB<double> operator*(const double& lvalue, const ImgClass::basic_RGB<double>& rcolor);
+template const ImgClass::basic_RGB<double> operator/(const ImgClass::basic_RGB<double>& lcolor, const ImgClass::basic_RGB<double>& rcolor);
+template const ImgClass::basic_RGB<double> operator/(const ImgClass::basic_RGB<double>& lcolor, const double& rvalue);
+template bool operator==(const ImgClass::basic_RGB<double>& lcolor, const ImgClass::basic_RGB<double>& rcolor);
+template bool operator!=(const ImgClass::basic_RGB<double>& lcolor, const ImgClass::basic_RGB<double>& rcolor);
+template double inner_prod(const ImgClass::basic_RGB<double>& lcolor, const ImgClass::basic_RGB<double>& rcolor);
+template double norm_squared(const ImgClass::basic_RGB<double>& color);
+template double norm(const ImgClass::basic_RGB<double>& color);
+template ImgClass::basic_RGB<double> saturate(const ImgClass::basic_RGB<double>& value, const double& min, const double& max);
+template ImgClass::basic_RGB<double> color_quantize(const ImgClass::basic_RGB<double>& value, const double& max);
+template std::ostream& operator<<(std::ostream& os, const ImgClass::basic_RGB<double>& rcolor);
+
+template const ImgClass::basic_RGB<float> operator+(ImgClass::basic_RGB<float> rcolor);
+template const ImgClass::basic_RGB<float> operator-(ImgClass::basic_RGB<float> rcolor);
+template const ImgClass::basic_RGB<float> operator+(const ImgClass::basic_RGB<float>& lcolor, const ImgClass::basic_RGB<float>& rcolor);
+template const ImgClass::basic_RGB<float> operator-(const ImgClass::basic_RGB<float>& lcolor, const ImgClass::basic_RGB<float>& rcolor);
+template const ImgClass::basic_RGB<float> operator*(const ImgClass::basic_RGB<float>& lcolor, const ImgClass::basic_RGB<float>& rcolor);
+template const ImgClass::basic_RGB<float> operator*(const ImgClass::basic_RGB<float>& lcolor, const double& rvalue);
+template const ImgClass::basic_RGB<float> operator*(const double& lvalue, const ImgClass::basic_RGB<float>& rcolor);
+template const ImgClass::basic_RGB<float> operator/(const ImgClass::basic_RGB<float>& lcolor, const ImgClass::basic_RGB<float>& rcolor);
+template const ImgClass::basic_RGB<float> operator/(const ImgClass::basic_RGB<float>& lcolor, const double& rvalue);
+template bool operator==(const ImgClass::basic_RGB<float>& lcolor, const ImgClass::basic_RGB<float>& rcolor);
+template bool operator!=(const ImgClass::basic_RGB<float>& lcolor, const ImgClass::basic_RGB<float>& rcolor);
+template double inner_prod(const ImgClass::basic_RGB<float>& lcolor, const ImgClass::basic_RGB<float>& rcolor);
+template double norm_squared(const ImgClass::basic_RGB<float>& color);
+template double norm(const ImgClass::basic_RGB<float>& color);
+template ImgClass::basic_RGB<float> saturate(const ImgClass::basic_RGB<float>& value, const double& min, const double& max);
+template ImgClass::basic_RGB<float> color_quantize(const ImgClass::basic_RGB<float>& value, const double& max);
+template std::ostream& operator<<(std::ostream& os, const ImgClass::basic_RGB<float>& rcolor);
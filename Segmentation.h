@@ -1,23 +1,33 @@
 #ifndef LIB_ImgClass_Segmentation
 #define LIB_ImgClass_Segmentation
 
-#include <list>
 #include <vector>
 
+#include "Color.h"
 #include "Vector.h"
 #include "ImgClass.h"
+#include "ImgDisjointSet.h"
+#include "ImgPyramid.h"
 
 #if defined(_OPENMP)
 #include <omp.h>
 #endif
 
 namespace ImgClass {
-	class RGB;
-	class Lab;
-
 	template <class T>
 	class Segmentation
 	{
+		public:
+
+		struct RegionGraph // Region adjacency graph of the regions (the regions 8-adjacent to the region n are adjacent[offsets[n], offsets[n + 1]))
+		{
+			std::vector<size_t> offsets;
+			std::vector<size_t> adjacent; // Ascending order for each region
+			std::vector<size_t> pixels; // The number of the pixels of each region
+			std::vector<T> colors; // The mean color of each region
+		};
+
+
 		private:
 
 		struct tuple
@@ -25,10 +35,35 @@ namespace ImgClass {
 			VECTOR_2D<double> spatial;
 			T color;
 		};
-		struct Region
+		struct Span // Row of the kernel disc from (x_begin, y) to (x_end, y)
 		{
-			std::list<VECTOR_2D<int> > points;
-			T color;
+			int y;
+			int x_begin;
+			int x_end;
+		};
+		struct BasinCell // Cell attributed to a mode by the basin-of-attraction shortcut
+		{
+			size_t source; // The start pixel whose trajectory visited the cell (size_t(-1) if not attributed)
+			T color; // The color of the trajectory at the cell
+			int claimed;
+		};
+		struct Trajectory
+		{
+			BasinCell* basin;
+			std::vector<size_t> cells; // The cells visited and their colors
+			std::vector<T> colors;
+			size_t mode; // The start pixel whose mode the trajectory reached (size_t(-1) if it converged by itself)
+		};
+		struct RegionList // Regions in CSR form (the points of the region n are points[offsets[n], offsets[n + 1]))
+		{
+			std::vector<size_t> offsets;
+			std::vector<VECTOR_2D<int> > points;
+		};
+		struct RegionEdge // Pair of the adjacent regions (a < b) and the distance of their mean colors
+		{
+			double distance;
+			size_t a;
+			size_t b;
 		};
 
 		int _width;
@@ -37,13 +72,22 @@ namespace ImgClass {
 		size_t _min_pixels;
 		double _kernel_spatial;
 		double _kernel_intensity;
+		bool _basin_shortcut;
+		bool _superpixel;
+		int _pyramid_levels;
+		int _pyramid_refine_iterations;
 		ImgVector<T> _image;
 		ImgVector<T> _color_quantized_image;
-		ImgVector<std::list<VECTOR_2D<int> > > _vector_converge_list_map;
+		ImgVector<size_t> _converge_map; // Index of the pixel where each pixel converges by Mean Shift
+		std::vector<size_t> _converge_offsets; // The pixels converging to the pixel n are _converge_pixels[_converge_offsets[n], _converge_offsets[n + 1])
+		std::vector<size_t> _converge_pixels; // Indices of the start pixels in raster order for each convergence point
 		ImgVector<VECTOR_2D<double> > _shift_vector_spatial;
 		ImgVector<T> _shift_vector_color;
 		ImgVector<size_t> _segmentation_map;
 		std::vector<std::vector<VECTOR_2D<int> > > _regions;
+		RegionGraph _region_graph;
+		std::vector<size_t> _region_labels; // Labels of _regions kept over the frames by next_frame()
+		size_t _next_label;
 
 
 		public:
@@ -63,6 +107,9 @@ namespace ImgClass {
 		// Setter
 		void set_kernel(const double &kernel_spatial_radius, const double &kernel_intensity_radius);
 		void set_min_pixels(const size_t &min_number_of_pixels);
+		void set_basin_shortcut(const bool enable); // Stop the trajectories at the cells attributed to a mode on the next reset() (the result depends on the number of the threads)
+		void set_pyramid(const int levels, const int refine_iterations = 4); // Run Mean Shift on the image downsampled by 2^levels on the next reset()
+		void set_superpixel(const bool enable); // Segment by SLIC superpixels instead of Mean Shift on the next reset()
 
 		Segmentation<T>& operator=(const Segmentation<T>& rvalue);
 
@@ -70,13 +117,20 @@ namespace ImgClass {
 		int width(void) const;
 		int height(void) const;
 		size_t size(void) const;
+		bool basin_shortcut(void) const;
+		int pyramid_levels(void) const;
+		bool superpixel(void) const;
 
 		const ImgVector<T>& ref_color_quantized_image(void) const;
 		const ImgVector<size_t>& ref_segmentation_map(void) const;
-		const ImgVector<std::list<VECTOR_2D<int> > >& ref_vector_converge_list_map(void) const;
+		const ImgVector<size_t>& ref_converge_map(void) const;
+		const std::vector<size_t>& ref_converge_offsets(void) const;
+		const std::vector<size_t>& ref_converge_pixels(void) const;
 		const ImgVector<VECTOR_2D<double> >& ref_shift_vector_spatial(void) const;
 		const ImgVector<T>& ref_shift_vector_color(void) const;
 		const std::vector<std::vector<VECTOR_2D<int> > >& ref_regions(void) const;
+		const std::vector<size_t>& ref_region_labels(void) const;
+		const RegionGraph& ref_region_graph(void) const; // The region n of the graph is _regions[n] (n + 1 on the segmentation map)
 
 		size_t& operator[](size_t n);
 		size_t& at(size_t n);
@@ -92,14 +146,33 @@ namespace ImgClass {
 
 		// Mean Shift segmentation
 		void Segmentation_MeanShift(const int Iter_Max = 32);
+		// SLIC superpixel segmentation on the grid of the spatial radius
+		void Segmentation_SLIC(const int Iter_Max = 10);
+		// Segmentation of a large image by the tiles with the current settings (image and the outputs can be the views of ImgMapped)
+		size_t Segmentation_Tiled(const ImgVector<T>& image, ImgVector<size_t>* segmentation_map, const int tile_size = 1024, const int IterMax = 32, ImgVector<T>* color_quantized_image = nullptr) const;
+		// Video segmentation warm-started from the modes of the current frame
+		Segmentation<T>& next_frame(const ImgVector<T>& image, const ImgVector<VECTOR_2D<double> >* motion = nullptr, const int IterMax = 32);
 
 
 		protected:
 
-		const ImgClass::Segmentation<T>::tuple MeanShift(const int x, const int y, std::vector<VECTOR_2D<int> >& pel_list, int Iter_Max);
-		size_t collect_regions_in_segmentation_map(std::list<std::list<VECTOR_2D<int> > >* regions_list);
-		size_t small_region_concatenator(std::list<std::list<VECTOR_2D<int> > >* regions_list);
-		void small_region_eliminator(std::list<std::list<VECTOR_2D<int> > >* regions_list);
+		const ImgClass::Segmentation<T>::tuple MeanShift(const tuple& start, const std::vector<Span>& disc, int Iter_Max, Trajectory* trajectory);
+		const ImgClass::Segmentation<T>::tuple MeanShift_color(const tuple& start, const std::vector<Span>& disc, int Iter_Max, const double radius_intensity, Trajectory* trajectory); // Mean Shift for the color types
+		bool attributed_mode(tuple* tuple, Trajectory* trajectory);
+		int pyramid_level(void) const;
+		void kernel_disc(std::vector<Span>* disc) const;
+		void compute_shift_vectors(const int Iter_Max, const Segmentation<T>* coarse, const Segmentation<T>* previous, const ImgVector<VECTOR_2D<double> >* motion);
+		void compute_shift_vectors_pyramid(const int Iter_Max);
+		void compute_superpixels(const int Iter_Max);
+		void segment_convergence(const int Radius);
+		VECTOR_2D<int> motion_source(const int x, const int y, const VECTOR_2D<double>& motion) const;
+		void bucket_convergence(void);
+		void regions_from_segmentation_map(const size_t min_pixels);
+		void regions_from_labels(const std::vector<size_t>& labels, const size_t num_region, RegionList* regions);
+		size_t collect_regions_in_segmentation_map(std::vector<size_t>* labels);
+		void region_graph(const std::vector<size_t>& labels, const size_t num_region, RegionGraph* graph) const;
+		void pack_region_graph(const size_t num_region, RegionGraph* graph) const;
+		size_t merge_small_regions(std::vector<size_t>* labels, const size_t num_region, const size_t min_pixels, RegionGraph* graph);
 
 		double distance(const T& lcolor, const T& rcolor); // Calculate distance depends on each color space
 		double normalized_distance(const T& lcolor, const T& rcolor); // Calculate distance depends on each color space
@@ -112,6 +185,8 @@ double inner_prod(const double& lvalue, const double& rvalue);
 double norm(const double& value);
 double norm_squared(const double& value);
 
+double color_quantize(const double& value, const double& max = 255.0);
+
 
 #include "Segmentation_private.h"
 
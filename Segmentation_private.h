@@ -2,7 +2,8 @@
 #include <cassert>
 #include <cfloat>
 #include <cmath>
-#include <list>
+#include <stdexcept>
+#include <utility>
 
 #include <cstdio>
 #include <fstream>
@@ -21,20 +22,31 @@ namespace ImgClass {
 		_size = 0;
 		_width = 0;
 		_height = 0;
+		_min_pixels = 4;
 		_kernel_spatial = 10.0;
 		_kernel_intensity = 0.1;
+		_basin_shortcut = false;
+		_superpixel = false;
+		_pyramid_levels = 0;
+		_pyramid_refine_iterations = 4;
+		_next_label = 1;
 	}
 
 	template <class T>
 	Segmentation<T>::Segmentation(const ImgVector<T>& image, const double &kernel_spatial_radius, const double &kernel_intensity_radius, const size_t &min_number_of_pixels)
 	{
-		_image.copy(image);
+		_image.view(image);
 		_size = _image.size();
 		_width = _image.width();
 		_height = _image.height();
 		_min_pixels = min_number_of_pixels;
 		_kernel_spatial = kernel_spatial_radius;
 		_kernel_intensity = kernel_intensity_radius;
+		_basin_shortcut = false;
+		_superpixel = false;
+		_pyramid_levels = 0;
+		_pyramid_refine_iterations = 4;
+		_next_label = 1;
 		if (_kernel_spatial <= 0.0) {
 			_kernel_spatial = 1.0;
 		}
@@ -42,7 +54,7 @@ namespace ImgClass {
 			_kernel_intensity = 1.0;
 		}
 
-		_vector_converge_list_map.reset(_width, _height);
+		_converge_map.reset(_width, _height);
 		_color_quantized_image.reset(_width, _height);
 		_shift_vector_spatial.reset(_width, _height);
 		_shift_vector_color.reset(_width, _height);
@@ -61,14 +73,23 @@ namespace ImgClass {
 		_min_pixels = segmentation._min_pixels;
 		_kernel_spatial = segmentation._kernel_spatial;
 		_kernel_intensity = segmentation._kernel_intensity;
+		_basin_shortcut = segmentation._basin_shortcut;
+		_superpixel = segmentation._superpixel;
+		_pyramid_levels = segmentation._pyramid_levels;
+		_pyramid_refine_iterations = segmentation._pyramid_refine_iterations;
+		_next_label = segmentation._next_label;
 
-		_image.copy(segmentation._image);
+		_image.view(segmentation._image);
 		_color_quantized_image.copy(segmentation._color_quantized_image);
-		_vector_converge_list_map.copy(segmentation._vector_converge_list_map);
+		_converge_map.copy(segmentation._converge_map);
+		_converge_offsets = segmentation._converge_offsets;
+		_converge_pixels = segmentation._converge_pixels;
 		_shift_vector_spatial.copy(segmentation._shift_vector_spatial);
 		_shift_vector_color.copy(segmentation._shift_vector_color);
 		_segmentation_map.copy(segmentation._segmentation_map);
 		_regions.assign(segmentation._regions.begin(), segmentation._regions.end());
+		_region_graph = segmentation._region_graph;
+		_region_labels = segmentation._region_labels;
 	}
 
 
@@ -76,7 +97,7 @@ namespace ImgClass {
 	Segmentation<T> &
 	Segmentation<T>::reset(const ImgVector<T>& image, const int IterMax, const double &kernel_spatial_radius, const double &kernel_intensity_radius, const size_t &min_number_of_pixels)
 	{
-		_image.copy(image);
+		_image.view(image);
 		_size = _image.size();
 		_width = _image.width();
 		_height = _image.height();
@@ -93,7 +114,9 @@ namespace ImgClass {
 		_color_quantized_image.reset(_width, _height);
 		_segmentation_map.reset(_width, _height);
 		_regions.clear();
-		_vector_converge_list_map.reset(_width, _height);
+		_region_graph = Segmentation<T>::RegionGraph();
+		_region_labels.clear();
+		_converge_map.reset(_width, _height);
 		_shift_vector_spatial.reset(_width, _height);
 		_shift_vector_color.reset(_width, _height);
 
@@ -101,7 +124,13 @@ namespace ImgClass {
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
 		printf("IterMax = %d\n", IterMax);
 #endif
-		if (IterMax > 0) {
+		if (_superpixel) {
+			if (IterMax > 0) {
+				Segmentation_SLIC(IterMax);
+			} else {
+				Segmentation_SLIC();
+			}
+		} else if (IterMax > 0) {
 			Segmentation_MeanShift(IterMax);
 		} else {
 			Segmentation_MeanShift();
@@ -120,14 +149,23 @@ namespace ImgClass {
 		_min_pixels = segmentation._min_pixels;
 		_kernel_spatial = segmentation._kernel_spatial;
 		_kernel_intensity = segmentation._kernel_intensity;
+		_basin_shortcut = segmentation._basin_shortcut;
+		_superpixel = segmentation._superpixel;
+		_pyramid_levels = segmentation._pyramid_levels;
+		_pyramid_refine_iterations = segmentation._pyramid_refine_iterations;
+		_next_label = segmentation._next_label;
 
-		_image.copy(segmentation._image);
+		_image.view(segmentation._image);
 		_color_quantized_image.copy(segmentation._color_quantized_image);
-		_vector_converge_list_map.copy(segmentation._vector_converge_list_map);
+		_converge_map.copy(segmentation._converge_map);
+		_converge_offsets = segmentation._converge_offsets;
+		_converge_pixels = segmentation._converge_pixels;
 		_shift_vector_spatial.copy(segmentation._shift_vector_spatial);
 		_shift_vector_color.copy(segmentation._shift_vector_color);
 		_segmentation_map.copy(segmentation._segmentation_map);
 		_regions.assign(segmentation._regions.begin(), segmentation._regions.end());
+		_region_graph = segmentation._region_graph;
+		_region_labels = segmentation._region_labels;
 		return *this;
 	}
 
@@ -157,6 +195,33 @@ namespace ImgClass {
 		_min_pixels = min_number_of_pixels;
 	}
 
+	/*
+	 * The cells are attributed to the modes in the order the threads reach them,
+	 * so the modes and the regions with the shortcut depend on the number of the threads and the schedule
+	 * (they are reproducible only on a single thread).
+	 */
+	template <class T>
+	void
+	Segmentation<T>::set_basin_shortcut(const bool enable)
+	{
+		_basin_shortcut = enable;
+	}
+
+	template <class T>
+	void
+	Segmentation<T>::set_pyramid(const int levels, const int refine_iterations)
+	{
+		_pyramid_levels = std::max(levels, 0);
+		_pyramid_refine_iterations = std::max(refine_iterations, 1);
+	}
+
+	template <class T>
+	void
+	Segmentation<T>::set_superpixel(const bool enable)
+	{
+		_superpixel = enable;
+	}
+
 
 	template <class T>
 	Segmentation<T> &
@@ -168,13 +233,20 @@ namespace ImgClass {
 		_min_pixels = rvalue._min_pixels;
 		_kernel_spatial = rvalue._kernel_spatial;
 		_kernel_intensity = rvalue._kernel_intensity;
+		_basin_shortcut = rvalue._basin_shortcut;
+		_superpixel = rvalue._superpixel;
+		_pyramid_levels = rvalue._pyramid_levels;
+		_pyramid_refine_iterations = rvalue._pyramid_refine_iterations;
+		_next_label = rvalue._next_label;
 
-		_image.copy(rvalue._image);
+		_image.view(rvalue._image);
 		_color_quantized_image.copy(rvalue._color_quantized_image);
 		_shift_vector_spatial.copy(rvalue._shift_vector_spatial);
 		_shift_vector_color.copy(rvalue._shift_vector_color);
 		_segmentation_map.copy(rvalue._segmentation_map);
 		_regions.assign(rvalue._regions.begin(), rvalue._regions.end());
+		_region_graph = rvalue._region_graph;
+		_region_labels = rvalue._region_labels;
 		return *this;
 	}
 
@@ -197,10 +269,24 @@ namespace ImgClass {
 	}
 
 	template <class T>
-	const ImgVector<std::list<VECTOR_2D<int> > > &
-	Segmentation<T>::ref_vector_converge_list_map(void) const
+	const ImgVector<size_t> &
+	Segmentation<T>::ref_converge_map(void) const
+	{
+		return _converge_map;
+	}
+
+	template <class T>
+	const std::vector<size_t> &
+	Segmentation<T>::ref_converge_offsets(void) const
 	{
-		return _vector_converge_list_map;
+		return _converge_offsets;
+	}
+
+	template <class T>
+	const std::vector<size_t> &
+	Segmentation<T>::ref_converge_pixels(void) const
+	{
+		return _converge_pixels;
 	}
 
 	template <class T>
@@ -224,6 +310,20 @@ namespace ImgClass {
 		return _regions;
 	}
 
+	template <class T>
+	const std::vector<size_t> &
+	Segmentation<T>::ref_region_labels(void) const
+	{
+		return _region_labels;
+	}
+
+	template <class T>
+	const typename Segmentation<T>::RegionGraph &
+	Segmentation<T>::ref_region_graph(void) const
+	{
+		return _region_graph;
+	}
+
 
 	// ----- Accessor -----
 	template <class T>
@@ -247,6 +347,27 @@ namespace ImgClass {
 		return _size;
 	}
 
+	template <class T>
+	bool
+	Segmentation<T>::basin_shortcut(void) const
+	{
+		return _basin_shortcut;
+	}
+
+	template <class T>
+	int
+	Segmentation<T>::pyramid_levels(void) const
+	{
+		return _pyramid_levels;
+	}
+
+	template <class T>
+	bool
+	Segmentation<T>::superpixel(void) const
+	{
+		return _superpixel;
+	}
+
 
 	template <class T>
 	size_t & 
@@ -328,179 +449,690 @@ namespace ImgClass {
 	void
 	Segmentation<T>::Segmentation_MeanShift(const int Iter_Max)
 	{
-		const VECTOR_2D<int> adjacent[8] = {
-		    VECTOR_2D<int>(-1, -1), VECTOR_2D<int>(0, -1), VECTOR_2D<int>(1, -1),
-		    VECTOR_2D<int>(-1, 0), VECTOR_2D<int>(1, 0),
-		    VECTOR_2D<int>(-1, 1), VECTOR_2D<int>(0, 1), VECTOR_2D<int>(1, 1)};
-		const double Decreased_Gray_Max = 255.0;
-		std::vector<VECTOR_2D<int> > pel_list;
+		if (_width <= 0 || _height <= 0) {
+			return;
+		}
+		// Compute Mean Shift vector
+		const int Level = this->pyramid_level();
+		if (Level > 0) {
+			this->compute_shift_vectors_pyramid(Iter_Max);
+		} else {
+			this->compute_shift_vectors(Iter_Max, nullptr, nullptr, nullptr);
+		}
+		// The modes from the pyramid are as sparse as the pixels of its level
+		this->segment_convergence(1 << Level);
+		// Number the regions
+		_region_labels.resize(_regions.size());
+		for (size_t n = 0; n < _regions.size(); n++) {
+			_region_labels[n] = n + 1;
+		}
+		_next_label = _regions.size() + 1;
+	}
 
+	/*
+	 * SLIC superpixels (Achanta et al., 2012) seeded on the grid of the interval _kernel_spatial.
+	 * The distance of a pixel and a center is measured by the radii of Mean Shift:
+	 *   (normalized color distance / _kernel_intensity)^2 + (spatial distance / _kernel_spatial)^2
+	 * Each pixel takes the nearest center of the 3x3 grid cells around it, and the centers of each grid row are updated
+	 * from the rows of the pixels which can take them, so both steps run in parallel and take O(N) time.
+	 * The iterations stop when no center moves by 0.1 pixels.
+	 * The fragments of the superpixels smaller than a quarter of the grid cell (or _min_pixels) are merged into the adjacent ones.
+	 * The shift vectors and the convergence points of the pixels are the centers of their superpixels.
+	 */
+	template <class T>
+	void
+	Segmentation<T>::Segmentation_SLIC(const int Iter_Max)
+	{
 		if (_width <= 0 || _height <= 0) {
 			return;
 		}
-		// Make pixel list
-		pel_list.reserve(SQUARE(size_t(ceil(2.0 * _kernel_spatial)) + 1));
-		{
-			for (int m = -int(ceil(_kernel_spatial)); m <= int(ceil(_kernel_spatial)); m++) {
-				for (int n = -int(ceil(_kernel_spatial)); n <= int(ceil(_kernel_spatial)); n++) {
-					if (n * n + m * m <= SQUARE(_kernel_spatial)) {
-						pel_list.push_back(VECTOR_2D<int>(n, m));
+		this->compute_superpixels(Iter_Max);
+		// Number the regions
+		_region_labels.resize(_regions.size());
+		for (size_t n = 0; n < _regions.size(); n++) {
+			_region_labels[n] = n + 1;
+		}
+		_next_label = _regions.size() + 1;
+	}
+
+	template <class T>
+	void
+	Segmentation<T>::compute_superpixels(const int Iter_Max)
+	{
+		const double Interval = std::max(_kernel_spatial, 1.0);
+		const int Grid_Width = std::max(1, int(round(_width / Interval)));
+		const int Grid_Height = std::max(1, int(round(_height / Interval)));
+		const double Cell_Width = double(_width) / double(Grid_Width);
+		const double Cell_Height = double(_height) / double(Grid_Height);
+		const double Converged_Move = 0.1;
+		const size_t Row_Grain = std::max(size_t(1), ImgParallel::grain_size() / size_t(_width));
+		const ImgVector<T>& image = _image;
+		std::vector<Segmentation<T>::tuple> centers;
+		std::vector<double> moves;
+		std::vector<size_t> labels;
+
+		try {
+			centers.resize(size_t(Grid_Width) * size_t(Grid_Height));
+			moves.resize(size_t(Grid_Height));
+			labels.resize(_size);
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "void Segmentation<T>::Segmentation_SLIC(const int) : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		// Seed the centers at the centers of the grid cells moved to the lowest gradient in 3x3 pixels
+		for (int j = 0; j < Grid_Height; j++) {
+			for (int i = 0; i < Grid_Width; i++) {
+				const int seed_x = std::min(int((i + 0.5) * Cell_Width), _width - 1);
+				const int seed_y = std::min(int((j + 0.5) * Cell_Height), _height - 1);
+				VECTOR_2D<int> r(seed_x, seed_y);
+				double min = DBL_MAX;
+				for (int y = std::max(seed_y - 1, 0); y <= std::min(seed_y + 1, _height - 1); y++) {
+					for (int x = std::max(seed_x - 1, 0); x <= std::min(seed_x + 1, _width - 1); x++) {
+						const double gradient = SQUARE(normalized_distance(image.get_mirror(x + 1, y), image.get_mirror(x - 1, y)))
+						    + SQUARE(normalized_distance(image.get_mirror(x, y + 1), image.get_mirror(x, y - 1)));
+						if (gradient < min) {
+							min = gradient;
+							r = VECTOR_2D<int>(x, y);
+						}
 					}
 				}
+				Segmentation<T>::tuple& center = centers[size_t(Grid_Width) * size_t(j) + size_t(i)];
+				center.spatial = VECTOR_2D<double>(double(r.x), double(r.y));
+				center.color = image.get(r.x, r.y);
 			}
 		}
-		// Compute Mean Shift vector
-#if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
-		size_t finished = 0;
-		size_t progress = .0;
-		printf(" Mean-Shift method:   0.0%%\x1b[1A\n");
-#endif
-		// Compute Mean Shift
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic)
-#endif
-		for (int y = 0; y < _height; y++) {
-			for (int x = 0; x < _width; x++) {
-				Segmentation<T>::tuple tmp = MeanShift(x, y, pel_list, Iter_Max);
-				auto lambda = [](double value, double max) -> double {
-					return value >= 0 ? value < max ? value : max - 1.0 : 0;
+		for (int iteration = 0; iteration < std::max(Iter_Max, 1); iteration++) {
+			// Assign each pixel to the nearest center of the 3x3 grid cells around it
+			ImgParallel::for_each(size_t(_height), Row_Grain,
+			    [&](const size_t begin, const size_t end) {
+				for (int y = int(begin); y < int(end); y++) {
+					const int cell_y = std::min(int(y / Cell_Height), Grid_Height - 1);
+					for (int x = 0; x < _width; x++) {
+						const int cell_x = std::min(int(x / Cell_Width), Grid_Width - 1);
+						const T color = image.get(x, y);
+						double min = DBL_MAX;
+						size_t label = 0;
+						for (int j = std::max(cell_y - 1, 0); j <= std::min(cell_y + 1, Grid_Height - 1); j++) {
+							for (int i = std::max(cell_x - 1, 0); i <= std::min(cell_x + 1, Grid_Width - 1); i++) {
+								const size_t k = size_t(Grid_Width) * size_t(j) + size_t(i);
+								const double distance = SQUARE(normalized_distance(color, centers[k].color) / _kernel_intensity)
+								    + (SQUARE(x - centers[k].spatial.x) + SQUARE(y - centers[k].spatial.y)) / SQUARE(Interval);
+								if (distance < min) {
+									min = distance;
+									label = k;
+								}
+							}
+						}
+						labels[size_t(_width) * size_t(y) + size_t(x)] = label;
+					}
+				}
+			});
+			// Update the centers of each grid row j by the mean of their pixels (in the cells of the rows j - 1 to j + 1)
+			ImgParallel::for_each(size_t(Grid_Height), 1,
+			    [&](const size_t begin, const size_t end) {
+				std::vector<Segmentation<T>::tuple> sums(static_cast<size_t>(Grid_Width));
+				std::vector<size_t> counts(static_cast<size_t>(Grid_Width));
+				for (int j = int(begin); j < int(end); j++) {
+					const size_t first = size_t(Grid_Width) * size_t(j);
+					const int y_begin = std::max(int(floor((j - 1) * Cell_Height)) - 1, 0);
+					const int y_end = std::min(int(ceil((j + 2) * Cell_Height)) + 1, _height);
+					for (int i = 0; i < Grid_Width; i++) {
+						sums[i].spatial = VECTOR_2D<double>(0.0, 0.0);
+						sums[i].color = T();
+						counts[i] = 0;
+					}
+					for (int y = y_begin; y < y_end; y++) {
+						for (int x = 0; x < _width; x++) {
+							const size_t k = labels[size_t(_width) * size_t(y) + size_t(x)];
+							if (first <= k && k < first + size_t(Grid_Width)) {
+								sums[k - first].spatial += VECTOR_2D<double>(double(x), double(y));
+								sums[k - first].color += image.get(x, y);
+								counts[k - first]++;
+							}
+						}
+					}
+					moves[j] = 0.0;
+					for (int i = 0; i < Grid_Width; i++) {
+						if (counts[i] > 0) {
+							Segmentation<T>::tuple& center = centers[first + size_t(i)];
+							const VECTOR_2D<double> spatial = sums[i].spatial / double(counts[i]);
+							moves[j] = std::max(moves[j], norm_squared(spatial - center.spatial));
+							center.spatial = spatial;
+							center.color = sums[i].color / double(counts[i]);
+						}
+					}
+				}
+			});
+			if (*std::max_element(moves.begin(), moves.end()) < SQUARE(Converged_Move)) {
+				break;
+			}
+		}
+		// The centers of the superpixels as the convergence points
+		VECTOR_2D<double>* shift_spatial = _shift_vector_spatial.data();
+		T* shift_color = _shift_vector_color.data();
+		size_t* converge = _converge_map.data();
+		size_t* map = _segmentation_map.data();
+		ImgParallel::for_each(_size,
+		    [&](const size_t begin, const size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				const Segmentation<T>::tuple& center = centers[labels[n]];
+				shift_spatial[n] = center.spatial;
+				shift_color[n] = center.color;
+				converge[n] = size_t(_width) * size_t(round(center.spatial.y)) + size_t(round(center.spatial.x));
+				map[n] = labels[n] + 1;
+			}
+		});
+		this->bucket_convergence();
+		this->regions_from_segmentation_map(std::max(_min_pixels, size_t(SQUARE(Interval) / 4.0)));
+	}
+
+	/*
+	 * Segment image by the tiles of tile_size x tile_size pixels with the settings of *this (the kernel, the minimum pixels and the engine)
+	 * and write the numbers of the regions (from 1) to segmentation_map (and the color-quantized image if it is given).
+	 * The outputs are used as they are if they have the size of image (e.g. the views of ImgMapped), otherwise they are reset.
+	 * Each tile is segmented in parallel on the window with the halo of the spatial radius,
+	 * and the regions of the adjacent tiles are stitched at the seams if the windows of both tiles connect the 8-adjacent pixels across the seam (the corners of the tiles included).
+	 * The regions are numbered tile by tile in raster order of their first pixels in the first tile they cover.
+	 * The memory other than image and the outputs is bounded by the tiles on the threads and the number of the regions.
+	 * *this is not modified and the number of the regions is returned.
+	 */
+	template <class T>
+	size_t
+	Segmentation<T>::Segmentation_Tiled(const ImgVector<T>& image, ImgVector<size_t>* segmentation_map, const int tile_size, const int IterMax, ImgVector<T>* color_quantized_image) const
+	{
+		const double Decreased_Gray_Max = 255.0;
+		const size_t None = size_t(-1);
+		const int width = image.width();
+		const int height = image.height();
+		const int Tile = std::max(tile_size, 1);
+		const int Halo = std::max(1, int(ceil(_kernel_spatial)));
+
+		if (segmentation_map == nullptr) {
+			throw std::invalid_argument("size_t Segmentation<T>::Segmentation_Tiled(const ImgVector<T>&, ImgVector<size_t>*, const int, const int, ImgVector<T>*) const : segmentation_map is NULL");
+		}
+		if (segmentation_map->width() != width || segmentation_map->height() != height) {
+			segmentation_map->reset(width, height);
+		}
+		if (width <= 0 || height <= 0) {
+			return 0;
+		}
+		const int Tiles_X = (width + Tile - 1) / Tile;
+		const int Tiles_Y = (height + Tile - 1) / Tile;
+		const size_t Num_Tiles = size_t(Tiles_X) * size_t(Tiles_Y);
+		std::vector<size_t> num_regions;
+		std::vector<std::vector<size_t> > rings; // rings[t] : the numbers of the regions of the tile t seen by its window on the pixels around the tile
+		std::vector<std::vector<T> > tile_sum_colors;
+		std::vector<std::vector<size_t> > tile_counts;
+		try {
+			num_regions.assign(Num_Tiles + 1, 0);
+			rings.resize(Num_Tiles);
+			if (color_quantized_image != nullptr) {
+				tile_sum_colors.resize(Num_Tiles);
+				tile_counts.resize(Num_Tiles);
+			}
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "size_t Segmentation<T>::Segmentation_Tiled(const ImgVector<T>&, ImgVector<size_t>*, const int, const int, ImgVector<T>*) const : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		// The index of (x, y) on the ring of the pixels around the tile t (the upper row, the lower row, the left column and the right column)
+		auto ring_index = [Tile, Tiles_X, width, height](const size_t t, const int x, const int y) -> size_t {
+			const int x0 = int(t % size_t(Tiles_X)) * Tile;
+			const int y0 = int(t / size_t(Tiles_X)) * Tile;
+			const int x1 = std::min(x0 + Tile, width);
+			const int y1 = std::min(y0 + Tile, height);
+			const size_t ring_width = size_t(x1 - x0 + 2);
+			if (y == y0 - 1) {
+				return size_t(x - x0 + 1);
+			} else if (y == y1) {
+				return ring_width + size_t(x - x0 + 1);
+			} else if (x == x0 - 1) {
+				return 2 * ring_width + size_t(y - y0);
+			}
+			return 2 * ring_width + size_t(y1 - y0) + size_t(y - y0);
+		};
+		const T* pixels = image.data();
+		size_t* map = segmentation_map->data();
+		// Segment the tiles (the numbers of the regions in the tiles are written to the cores of the tiles from 0)
+		ImgParallel::for_each(Num_Tiles, 1,
+		    [&](const size_t begin, const size_t end) {
+			for (size_t t = begin; t < end; t++) {
+				const int x0 = int(t % size_t(Tiles_X)) * Tile;
+				const int y0 = int(t / size_t(Tiles_X)) * Tile;
+				const int x1 = std::min(x0 + Tile, width);
+				const int y1 = std::min(y0 + Tile, height);
+				const int window_x = std::max(x0 - Halo, 0);
+				const int window_y = std::max(y0 - Halo, 0);
+				ImgVector<T> window(std::min(x1 + Halo, width) - window_x, std::min(y1 + Halo, height) - window_y);
+				for (int y = 0; y < window.height(); y++) {
+					std::copy(
+					    pixels + size_t(width) * size_t(window_y + y) + size_t(window_x),
+					    pixels + size_t(width) * size_t(window_y + y) + size_t(window_x + window.width()),
+					    window.data() + size_t(window.width()) * size_t(y));
+				}
+				Segmentation<T> local;
+				local.set_basin_shortcut(_basin_shortcut);
+				local.set_pyramid(_pyramid_levels, _pyramid_refine_iterations);
+				local.set_superpixel(_superpixel);
+				local.reset(window, IterMax, _kernel_spatial, _kernel_intensity, _min_pixels);
+				// Renumber the regions of the window in raster order of their first pixels in the core (the regions only in the halo are dropped)
+				std::vector<size_t> number(local.ref_regions().size(), None);
+				size_t count = 0;
+				if (color_quantized_image != nullptr) {
+					tile_sum_colors[t].assign(number.size(), T());
+					tile_counts[t].assign(number.size(), 0);
+				}
+				for (int y = y0; y < y1; y++) {
+					for (int x = x0; x < x1; x++) {
+						const size_t index = size_t(width) * size_t(y) + size_t(x);
+						size_t& region = number[local.get(x - window_x, y - window_y) - 1];
+						if (region == None) {
+							region = count++;
+						}
+						map[index] = region;
+						if (color_quantized_image != nullptr) {
+							tile_sum_colors[t][region] += pixels[index];
+							tile_counts[t][region]++;
+						}
+					}
+				}
+				num_regions[t + 1] = count;
+				if (color_quantized_image != nullptr) {
+					tile_sum_colors[t].resize(count);
+					tile_counts[t].resize(count);
+				}
+				// The regions seen by the window on the ring (None if the pixel is out of the image or its region is not in the core)
+				rings[t].assign(2 * size_t(x1 - x0 + 2) + 2 * size_t(y1 - y0), None);
+				auto see = [&](const int x, const int y) {
+					if (0 <= x && x < width && 0 <= y && y < height) {
+						rings[t][ring_index(t, x, y)] = number[local.get(x - window_x, y - window_y) - 1];
+					}
 				};
-				// Saturation
-				tmp.spatial.x = lambda(tmp.spatial.x, _width);
-				tmp.spatial.y = lambda(tmp.spatial.y, _height);
-				// Set vector
-				_shift_vector_spatial.at(x, y) = tmp.spatial;
-				_shift_vector_color.at(x, y) = tmp.color;
-				// Assign start point to converge list
-				VECTOR_2D<int> shift(int(tmp.spatial.x), int(tmp.spatial.y));
-#ifdef _OPENMP
-#pragma omp critical
-#endif
-				{
-					_vector_converge_list_map.at(shift.x, shift.y).push_back(VECTOR_2D<int>(x, y));
+				for (int x = x0 - 1; x <= x1; x++) {
+					see(x, y0 - 1);
+					see(x, y1);
 				}
-#if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
-#ifdef _OPENMP
-#pragma omp critical
-#endif
-				{
-					double ratio = double(++finished) / _image.size();
-					if (round(ratio * 1000.0) > progress) {
-						progress = size_t(round(ratio * 1000.0)); // Take account of Over-Run
-						printf("\r Mean-Shift method: %5.1f%%\x1b[1A\n", progress * 0.1);
+				for (int y = y0; y < y1; y++) {
+					see(x0 - 1, y);
+					see(x1, y);
+				}
+			}
+		});
+		// Stitch the regions at the seams (the region n of the tile t is num_regions[t] + n)
+		for (size_t t = 0; t < Num_Tiles; t++) {
+			num_regions[t + 1] += num_regions[t];
+		}
+		ImgDisjointSet disjoint_set(num_regions[Num_Tiles]);
+		auto tile_of = [Tile, Tiles_X](const int x, const int y) -> size_t {
+			return size_t(y / Tile) * size_t(Tiles_X) + size_t(x / Tile);
+		};
+		// Each pair of the 8-adjacent pixels across the seams is seen from the upper or the left one,
+		// and they are united if the windows of both tiles connect them
+		auto stitch = [&](const size_t t, const int x, const int y) {
+			const size_t index = size_t(width) * size_t(y) + size_t(x);
+			const int neighbor_x[4] = {x + 1, x - 1, x, x + 1};
+			const int neighbor_y[4] = {y, y + 1, y + 1, y + 1};
+			for (int k = 0; k < 4; k++) {
+				if (0 <= neighbor_x[k] && neighbor_x[k] < width && neighbor_y[k] < height) {
+					const size_t t_r = tile_of(neighbor_x[k], neighbor_y[k]);
+					const size_t index_r = size_t(width) * size_t(neighbor_y[k]) + size_t(neighbor_x[k]);
+					if (t_r != t
+					    && rings[t][ring_index(t, neighbor_x[k], neighbor_y[k])] == map[index]
+					    && rings[t_r][ring_index(t_r, x, y)] == map[index_r]) {
+						disjoint_set.unite(num_regions[t] + map[index], num_regions[t_r] + map[index_r]);
 					}
 				}
-#endif
+			}
+		};
+		for (size_t t = 0; t < Num_Tiles; t++) {
+			const int x0 = int(t % size_t(Tiles_X)) * Tile;
+			const int y0 = int(t / size_t(Tiles_X)) * Tile;
+			const int x1 = std::min(x0 + Tile, width);
+			const int y1 = std::min(y0 + Tile, height);
+			for (int y = y0; y < y1 - 1; y++) {
+				stitch(t, x0, y);
+				if (x1 - 1 > x0) {
+					stitch(t, x1 - 1, y);
+				}
+			}
+			for (int x = x0; x < x1; x++) {
+				stitch(t, x, y1 - 1);
+			}
+		}
+		std::vector<std::vector<size_t> >().swap(rings);
+		// Number the roots (the first regions of the stitched regions) tile by tile
+		std::vector<size_t> number;
+		std::vector<size_t> tile_offsets;
+		try {
+			number.resize(num_regions[Num_Tiles]);
+			tile_offsets.assign(Num_Tiles + 1, 0);
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "size_t Segmentation<T>::Segmentation_Tiled(const ImgVector<T>&, ImgVector<size_t>*, const int, const int, ImgVector<T>*) const : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		const ImgDisjointSet* sets = &disjoint_set;
+		size_t* offsets = tile_offsets.data();
+		ImgParallel::for_each(Num_Tiles, 1,
+		    [sets, offsets, &num_regions](const size_t begin, const size_t end) {
+			for (size_t t = begin; t < end; t++) {
+				size_t count = 0;
+				for (size_t k = num_regions[t]; k < num_regions[t + 1]; k++) {
+					if (sets->is_root(k)) {
+						count++;
+					}
+				}
+				offsets[t + 1] = count;
+			}
+		});
+		for (size_t t = 0; t < Num_Tiles; t++) {
+			offsets[t + 1] += offsets[t];
+		}
+		ImgParallel::for_each(Num_Tiles, 1,
+		    [sets, offsets, &num_regions, &number](const size_t begin, const size_t end) {
+			for (size_t t = begin; t < end; t++) {
+				size_t num = offsets[t];
+				for (size_t k = num_regions[t]; k < num_regions[t + 1]; k++) {
+					if (sets->is_root(k)) {
+						number[k] = num++;
+					}
+				}
+			}
+		});
+		ImgParallel::for_each(num_regions[Num_Tiles],
+		    [sets, &number](const size_t begin, const size_t end) {
+			for (size_t k = begin; k < end; k++) {
+				if (sets->is_root(k) == false) {
+					number[k] = number[sets->root(k)];
+				}
+			}
+		});
+		// Label the pixels by the numbers of their roots tile by tile
+		ImgParallel::for_each(Num_Tiles, 1,
+		    [&](const size_t begin, const size_t end) {
+			for (size_t t = begin; t < end; t++) {
+				const int x0 = int(t % size_t(Tiles_X)) * Tile;
+				const int y0 = int(t / size_t(Tiles_X)) * Tile;
+				const int x1 = std::min(x0 + Tile, width);
+				const int y1 = std::min(y0 + Tile, height);
+				for (int y = y0; y < y1; y++) {
+					for (int x = x0; x < x1; x++) {
+						const size_t index = size_t(width) * size_t(y) + size_t(x);
+						map[index] = number[num_regions[t] + map[index]] + 1;
+					}
+				}
+			}
+		});
+		const size_t num = tile_offsets[Num_Tiles];
+		// Make color-quantized image
+		if (color_quantized_image != nullptr) {
+			std::vector<T> sum_colors;
+			std::vector<size_t> counts;
+			try {
+				sum_colors.assign(num, T());
+				counts.assign(num, 0);
+			}
+			catch (const std::bad_alloc& bad) {
+				std::cerr << bad.what() << std::endl
+				    << "size_t Segmentation<T>::Segmentation_Tiled(const ImgVector<T>&, ImgVector<size_t>*, const int, const int, ImgVector<T>*) const : Cannot Allocate Memory" << std::endl;
+				throw;
+			}
+			for (size_t t = 0; t < Num_Tiles; t++) {
+				for (size_t n = 0; n < tile_counts[t].size(); n++) {
+					sum_colors[number[num_regions[t] + n]] += tile_sum_colors[t][n];
+					counts[number[num_regions[t] + n]] += tile_counts[t][n];
+				}
+			}
+			if (color_quantized_image->width() != width || color_quantized_image->height() != height) {
+				color_quantized_image->reset(width, height);
+			}
+			T* quantized = color_quantized_image->data();
+			ImgParallel::for_each(size_t(width) * size_t(height),
+			    [&](const size_t begin, const size_t end) {
+				for (size_t n = begin; n < end; n++) {
+					quantized[n] = sum_colors[map[n] - 1] * Decreased_Gray_Max / double(counts[map[n] - 1]);
+				}
+			});
+		}
+		return num;
+	}
+
+	/*
+	 * Segment the next frame of the video from the modes of the current frame.
+	 * motion is the displacement of each pixel of image from the current frame (optional).
+	 * The regions overlapping the regions of the current frame keep their labels (ref_region_labels()).
+	 * If the size of image is changed, the frame is segmented from scratch (the superpixels are always computed from scratch).
+	 */
+	template <class T>
+	Segmentation<T> &
+	Segmentation<T>::next_frame(const ImgVector<T>& image, const ImgVector<VECTOR_2D<double> >* motion, const int IterMax)
+	{
+		if (image.width() != _width || image.height() != _height || _regions.empty()) {
+			return this->reset(image, IterMax, _kernel_spatial, _kernel_intensity, _min_pixels);
+		}
+		if (motion != nullptr
+		    && (motion->width() != _width || motion->height() != _height)) {
+			throw std::invalid_argument("Segmentation<T>& Segmentation<T>::next_frame(const ImgVector<T>&, const ImgVector<VECTOR_2D<double> >*, const int) : the size of motion is different from image");
+		}
+		// The current frame (the images are shared until they are written)
+		Segmentation<T> previous;
+		previous._width = _width;
+		previous._height = _height;
+		previous._size = _size;
+		previous._image.view(_image);
+		previous._shift_vector_spatial.copy(_shift_vector_spatial);
+		previous._shift_vector_color.copy(_shift_vector_color);
+		previous._segmentation_map.copy(_segmentation_map);
+		previous._region_labels.swap(_region_labels);
+
+		_image.view(image);
+		_color_quantized_image.reset(_width, _height);
+		_segmentation_map.reset(_width, _height);
+		_regions.clear();
+		_converge_map.reset(_width, _height);
+		_shift_vector_spatial.reset(_width, _height);
+		_shift_vector_color.reset(_width, _height);
+		if (_superpixel) {
+			this->compute_superpixels(IterMax > 0 ? IterMax : 10);
+		} else {
+			this->compute_shift_vectors(IterMax > 0 ? IterMax : 32, nullptr, &previous, motion);
+			this->segment_convergence(1);
+		}
+		// Take over the labels of the regions of the current frame by the largest overlap
+		{
+			const size_t None = size_t(-1);
+			std::vector<size_t> overlap_region(_regions.size(), None);
+			std::vector<size_t> overlap_count(_regions.size(), 0);
+			std::vector<size_t> owner(previous._region_labels.size(), None); // The region taking over each label
+			for (size_t n = 0; n < _regions.size(); n++) {
+				std::vector<size_t> sources;
+				sources.reserve(_regions[n].size());
+				for (const VECTOR_2D<int>& r : _regions[n]) {
+					VECTOR_2D<double> v(0.0, 0.0);
+					if (motion != nullptr) {
+						v = motion->get(r.x, r.y);
+					}
+					const VECTOR_2D<int> source = this->motion_source(r.x, r.y, v);
+					const size_t region = previous._segmentation_map.get(source.x, source.y);
+					if (0 < region && region <= previous._region_labels.size()) {
+						sources.push_back(region - 1);
+					}
+				}
+				std::sort(sources.begin(), sources.end());
+				for (size_t begin = 0, end = 0; begin < sources.size(); begin = end) {
+					for (end = begin; end < sources.size() && sources[end] == sources[begin]; end++) {
+					}
+					if (end - begin > overlap_count[n]) {
+						overlap_region[n] = sources[begin];
+						overlap_count[n] = end - begin;
+					}
+				}
+				if (overlap_region[n] != None
+				    && (owner[overlap_region[n]] == None || overlap_count[owner[overlap_region[n]]] < overlap_count[n])) {
+					owner[overlap_region[n]] = n;
+				}
+			}
+			_region_labels.resize(_regions.size());
+			for (size_t n = 0; n < _regions.size(); n++) {
+				if (overlap_region[n] != None && owner[overlap_region[n]] == n) {
+					_region_labels[n] = previous._region_labels[overlap_region[n]];
+				} else {
+					_region_labels[n] = _next_label++;
+				}
 			}
 		}
-		// Concatenate the list of connected regions
+		return *this;
+	}
+
+	/*
+	 * The pixel of the current frame which moves to (x, y) of the next frame by motion
+	 */
+	template <class T>
+	VECTOR_2D<int>
+	Segmentation<T>::motion_source(const int x, const int y, const VECTOR_2D<double>& motion) const
+	{
+		VECTOR_2D<int> r(
+		    static_cast<int>(round(x - motion.x)),
+		    static_cast<int>(round(y - motion.y)));
+		r.x = std::max(0, std::min(r.x, _width - 1));
+		r.y = std::max(0, std::min(r.y, _height - 1));
+		return r;
+	}
+
+	/*
+	 * Group the pixels into the regions by their convergence points.
+	 * The convergence points within Radius pixels are connected.
+	 */
+	template <class T>
+	void
+	Segmentation<T>::segment_convergence(const int Radius)
+	{
+		const size_t None = size_t(-1);
+		std::vector<VECTOR_2D<int> > adjacent;
+
+		for (int m = -Radius; m <= Radius; m++) {
+			for (int n = -Radius; n <= Radius; n++) {
+				if (n != 0 || m != 0) {
+					adjacent.push_back(VECTOR_2D<int>(n, m));
+				}
+			}
+		}
+		// Bucket the start pixels by their convergence points
+		this->bucket_convergence();
+		// Concatenate the buckets of connected convergence points
+		// (the buckets concatenated to the pixel n are chained from converge_head[n] by converge_next)
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
 		printf(" Mean-Shift method: Concatenation\n");
 #endif
+		std::vector<size_t> converge_head(_size, None);
+		std::vector<size_t> converge_tail(_size, None);
+		std::vector<size_t> converge_next(_size, None);
+		std::vector<VECTOR_2D<int> > queue;
+		for (size_t n = 0; n < _size; n++) {
+			if (_converge_offsets[n + 1] > _converge_offsets[n]) {
+				converge_head[n] = n;
+				converge_tail[n] = n;
+			}
+		}
 		for (int y = 0; y < _height; y++) {
 			for (int x = 0; x < _width; x++) {
-				if (_vector_converge_list_map.at(x, y).size() > 0) {
-					std::list<VECTOR_2D<int> > tmp_list;
-					tmp_list.push_back(VECTOR_2D<int>(x, y));
-					for (auto ite = tmp_list.begin(); ite != tmp_list.end(); ++ite) {
-						for (size_t i = 0; i < 8; i++) {
-							VECTOR_2D<int> r(ite->x + adjacent[i].x, ite->y + adjacent[i].y);
+				const size_t index = size_t(_width) * size_t(y) + size_t(x);
+				if (converge_head[index] != None) {
+					queue.clear();
+					queue.push_back(VECTOR_2D<int>(x, y));
+					for (size_t head = 0; head < queue.size(); head++) {
+						const VECTOR_2D<int> element = queue[head];
+						for (size_t i = 0; i < adjacent.size(); i++) {
+							VECTOR_2D<int> r(element.x + adjacent[i].x, element.y + adjacent[i].y);
+							const size_t index_r = size_t(_width) * size_t(r.y) + size_t(r.x);
 							if (0 <= r.x && r.x < _width
 							    && 0 <= r.y && r.y < _height
 							    && r.x != x && r.y != y
-							    && _vector_converge_list_map.at(r.x, r.y).size() > 0) {
-								tmp_list.push_back(r);
-								_vector_converge_list_map.at(x, y).splice(
-								    _vector_converge_list_map.at(x, y).end(),
-								    _vector_converge_list_map.at(r.x, r.y));
+							    && converge_head[index_r] != None) {
+								queue.push_back(r);
+								// Splice the chain of r to the end of the chain of (x, y)
+								converge_next[converge_tail[index]] = converge_head[index_r];
+								converge_tail[index] = converge_tail[index_r];
+								converge_head[index_r] = None;
 							}
 						}
 					}
 				}
 			}
 		}
-		std::list<std::list<VECTOR_2D<int> > > regions_list; // start_point, shift_vector_spatial, shift_vector_color
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
 		printf(" Mean-Shift method: Concatenate pixels which converge into same connected region");
 #endif
-		for (int y = 0; y < _height; y++) {
-			for (int x = 0; x < _width; x++) {
-				// Search converge point
-				if (_vector_converge_list_map.at(x, y).size() > 0) {
-					std::list<Segmentation<T>::Region> tmp_regions_list;
-					for (VECTOR_2D<int>& candidate : _vector_converge_list_map.at(x, y)) {
-						bool found = false;
-						const T& color_cand = color_quantize(_shift_vector_color.get(candidate.x, candidate.y));
-						for (Segmentation<T>::Region& region : tmp_regions_list) {
-							if (normalized_distance(color_cand, region.color) < 0.5) {
-								region.points.push_back(candidate);
-								found = true;
-								break;
+		// Number the groups of the similar colors in each concatenated bucket on _segmentation_map
+		_segmentation_map.resize(_width, _height);
+		{
+			size_t num = 1;
+			std::vector<T> group_colors;
+			for (int y = 0; y < _height; y++) {
+				for (int x = 0; x < _width; x++) {
+					// Search converge point
+					const size_t index = size_t(_width) * size_t(y) + size_t(x);
+					if (converge_head[index] == None) {
+						continue;
+					}
+					group_colors.clear();
+					for (size_t bucket = converge_head[index]; bucket != None; bucket = converge_next[bucket]) {
+						for (size_t k = _converge_offsets[bucket]; k < _converge_offsets[bucket + 1]; k++) {
+							const size_t pixel = _converge_pixels[k];
+							const T color_cand = color_quantize(_shift_vector_color.get(pixel));
+							size_t group = 0;
+							while (group < group_colors.size()
+							    && !(normalized_distance(color_cand, group_colors[group]) < 0.5)) {
+								group++;
 							}
+							if (group == group_colors.size()) {
+								group_colors.push_back(color_cand);
+							}
+							_segmentation_map[pixel] = num + group;
 						}
-						if (found == false) {
-							Segmentation<T>::Region new_region;
-							new_region.points.push_back(candidate);
-							new_region.color = color_cand;
-							tmp_regions_list.push_back(new_region);
-						}
-					}
-					for (auto region : tmp_regions_list) {
-						regions_list.push_back(region.points);
 					}
+					num += group_colors.size();
 				}
 			}
 		}
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
 		printf("\n Mean-Shift method: Finished\n");
 #endif
-		// Make region map
-		_segmentation_map.resize(_width, _height);
-		{
-			size_t num = 1;
-			for (const std::list<VECTOR_2D<int> >& region : regions_list) {
-				for (const VECTOR_2D<int>& r : region) {
-					_segmentation_map.at(r.x, r.y) = num;
-				}
-				num++;
-			}
-		}
+		this->regions_from_segmentation_map(_min_pixels);
+	}
+
+	/*
+	 * Make _regions, _region_graph and _color_quantized_image from the connected regions of the same number on _segmentation_map
+	 * with the regions smaller than min_pixels merged, and set _segmentation_map by the numbers of _regions.
+	 */
+	template <class T>
+	void
+	Segmentation<T>::regions_from_segmentation_map(const size_t min_pixels)
+	{
+		const double Decreased_Gray_Max = 255.0;
+
 		// Collect connected regions from Mean-Shift filtered image
-		size_t num_region = collect_regions_in_segmentation_map(&regions_list);
-		// Set _segmentation_map by _regions No.
-		{
-			size_t n = 1;
-			for (const std::list<VECTOR_2D<int> >& region : regions_list) {
-				for (const VECTOR_2D<int>& r : region) {
-					_segmentation_map.at(r.x, r.y) = n;
-				}
-				n++;
-			}
-		}
+		std::vector<size_t> labels;
+		size_t num_region = collect_regions_in_segmentation_map(&labels);
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
 		printf(" Mean-Shift method: Eliminate small regions\n");
+		const size_t num_collected = num_region;
 #endif
-		// Eliminate small regions
-		small_region_concatenator(&regions_list);
-		small_region_eliminator(&regions_list);
+		// Eliminate small regions (_region_graph is made for the merged regions)
+		num_region = merge_small_regions(&labels, num_region, min_pixels, &_region_graph);
 #if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
-		std::cout << " Mean-Shift method: The number of regions reduced " << num_region << " -> " << regions_list.size() << std::endl;
+		std::cout << " Mean-Shift method: The number of regions reduced " << num_collected << " -> " << num_region << std::endl;
 #endif
-		// Copy regions_list to _regions
-		num_region = regions_list.size();
+		// Copy regions to _regions and set _segmentation_map by _regions No.
+		Segmentation<T>::RegionList regions;
+		this->regions_from_labels(labels, num_region, &regions);
 		_regions.resize(num_region);
-		{
-			size_t test = 0;
-			std::vector<std::vector<VECTOR_2D<int> > >::iterator ite = _regions.begin();
-			for (const std::list<VECTOR_2D<int> >& region : regions_list) {
-				ite->assign(region.begin(), region.end());
-				++ite;
-				test += region.size();
-			}
-		}
-		regions_list.clear();
-		// Reset _segmentation_map by _regions No.
-		for (size_t n = 0; n < _regions.size(); n++) {
+		for (size_t n = 0; n < num_region; n++) {
+			_regions[n].assign(regions.points.begin() + regions.offsets[n], regions.points.begin() + regions.offsets[n + 1]);
 			for (size_t i = 0; i < _regions[n].size(); i++) {
 				_segmentation_map.at(_regions[n][i].x, _regions[n][i].y) = n + 1;
 			}
@@ -519,227 +1151,712 @@ namespace ImgClass {
 	}
 
 
+	/*
+	 * The level of the pyramid actually used.
+	 * The spatial radius and the smaller side of the image should be at least 1 and 2 on the level.
+	 */
 	template <class T>
-	size_t
-	Segmentation<T>::collect_regions_in_segmentation_map(std::list<std::list<VECTOR_2D<int> > >* regions_list)
+	int
+	Segmentation<T>::pyramid_level(void) const
 	{
-		const VECTOR_2D<int> adjacent[8] = {
-		    VECTOR_2D<int>(-1, -1), VECTOR_2D<int>(0, -1), VECTOR_2D<int>(1, -1),
-		    VECTOR_2D<int>(-1, 0), VECTOR_2D<int>(1, 0),
-		    VECTOR_2D<int>(-1, 1), VECTOR_2D<int>(0, 1), VECTOR_2D<int>(1, 1)};
-		ImgVector<bool> collected(_width, _height, false);
+		int level = 0;
+		while (level < _pyramid_levels
+		    && _kernel_spatial / double(1 << (level + 1)) >= 1.0
+		    && (std::min(_width, _height) >> (level + 1)) >= 2) {
+			level++;
+		}
+		return level;
+	}
 
-		regions_list->clear();
-		size_t num_region = 0;
-		for (int y = 0; y < _height; y++) {
-			for (int x = 0; x < _width; x++) {
-				if (collected.get(x, y)) {
-					continue;
-				}
-				VECTOR_2D<int> r(x, y);
-				collected.at(x, y) = true;
-				size_t N = _segmentation_map.get(r.x, r.y);
-				regions_list->push_back(std::list<VECTOR_2D<int> >(1, r));
-				num_region++;
-				// Search connected regions with 8-adjacent
-				for (const VECTOR_2D<int>& element : regions_list->back()) {
-					for (int k = 0; k < 8; k++) {
-						r.x = element.x + adjacent[k].x;
-						r.y = element.y + adjacent[k].y;
-						if (0 <= r.x && r.x < _width && 0 <= r.y && r.y < _height
-						    && collected.get(r.x, r.y) == false
-						    && _segmentation_map.get(r.x, r.y) == N) {
-							collected.at(r.x, r.y) = true;
-							regions_list->back().push_back(r);
-						}
+	/*
+	 * The rows of the disc of the spatial kernel
+	 */
+	template <class T>
+	void
+	Segmentation<T>::kernel_disc(std::vector<Span>* disc) const
+	{
+		const int Radius = int(ceil(_kernel_spatial));
+
+		disc->clear();
+		disc->reserve(size_t(2 * Radius + 1));
+		for (int m = -Radius; m <= Radius; m++) {
+			Span span;
+			span.y = m;
+			span.x_begin = 1;
+			span.x_end = 0;
+			for (int n = -Radius; n <= Radius; n++) {
+				if (n * n + m * m <= SQUARE(_kernel_spatial)) {
+					if (span.x_begin > span.x_end) {
+						span.x_begin = n;
 					}
+					span.x_end = n;
 				}
 			}
+			if (span.x_begin <= span.x_end) {
+				disc->push_back(span);
+			}
 		}
-		return num_region;
 	}
 
-
+	/*
+	 * Compute the shift vectors and the convergence points of all pixels.
+	 * If coarse is given, the pixels take the modes of the nearest pixels of coarse
+	 * (refined at full resolution by compute_shift_vectors_pyramid()) if the colors are in their range.
+	 * If previous (the previous frame) is given, the pixels take the modes of the pixels of previous
+	 * displaced by motion if the colors are almost the same, and start from the modes if they are in their range.
+	 */
 	template <class T>
-	size_t
-	Segmentation<T>::small_region_concatenator(std::list<std::list<VECTOR_2D<int> > >* region_list)
-	{
-		const VECTOR_2D<int> adjacent[8] = {
-		    VECTOR_2D<int>(-1, -1), VECTOR_2D<int>(0, -1), VECTOR_2D<int>(1, -1),
-		    VECTOR_2D<int>(-1, 0), VECTOR_2D<int>(1, 0),
-		    VECTOR_2D<int>(-1, 1), VECTOR_2D<int>(0, 1), VECTOR_2D<int>(1, 1)};
-		std::list<std::list<VECTOR_2D<int> > > small_region_list;
-		ImgVector<bool> small_region_map(_width, _height, false);
-		ImgVector<bool> dense_small_region_map(_width, _height, false);
-		ImgVector<std::list<VECTOR_2D<int> >*> region_list_map(_width, _height);
-		size_t num_small_region = 0;
+	void
+	Segmentation<T>::compute_shift_vectors(const int Iter_Max, const Segmentation<T>* coarse, const Segmentation<T>* previous, const ImgVector<VECTOR_2D<double> >* motion)
+	{
+		const size_t None = size_t(-1);
+		const double Still_Tolerance = 0.1;
+		std::vector<Span> disc;
 
-		// Make region_list_map
-		for (std::list<std::list<VECTOR_2D<int> > >::iterator ite = region_list->begin();
-		    ite != region_list->end();
-		    ++ite) {
-			for (const VECTOR_2D<int>& r : *ite) {
-				region_list_map.at(r.x, r.y) = &(*ite);
-			}
+		this->kernel_disc(&disc);
+#if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
+		size_t finished = 0;
+		size_t progress = .0;
+		printf(" Mean-Shift method:   0.0%%\x1b[1A\n");
+#endif
+		// Compute Mean Shift (the outputs should not be shared before the parallel writes)
+		const ImgVector<T>& image = _image;
+		const int scale = coarse != nullptr ? 1 << (this->pyramid_level()) : 1;
+		_shift_vector_spatial.unshare();
+		_shift_vector_color.unshare();
+		size_t* converge = _converge_map.data();
+		// The cells attributed to the modes by the basin-of-attraction shortcut
+		std::vector<Segmentation<T>::BasinCell> basin;
+		if (_basin_shortcut) {
+			Segmentation<T>::BasinCell empty;
+			empty.source = None;
+			empty.color = T();
+			empty.claimed = 0;
+			basin.assign(_size, empty);
 		}
-		// Search small regions
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
 		{
-			std::list<std::list<VECTOR_2D<int> > >::iterator ite = region_list->begin();
-			while (ite != region_list->end()) {
-				if (ite->size() < _min_pixels) {
-					// Count the number of small regions here because some regions may become larger on this routine
-					num_small_region++;
-					small_region_list.emplace_back();
-					small_region_list.back().assign(ite->begin(), ite->end());
-					for (const VECTOR_2D<int>& r : *ite) {
-						small_region_map.at(r.x, r.y) = true;
-						region_list_map.at(r.x, r.y) = &(small_region_list.back());
+			Segmentation<T>::Trajectory trajectory;
+			trajectory.basin = basin.data();
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+			for (int y = 0; y < _height; y++) {
+				for (int x = 0; x < _width; x++) {
+					trajectory.cells.clear();
+					trajectory.colors.clear();
+					trajectory.mode = None;
+					Segmentation<T>::tuple tmp;
+					tmp.spatial = VECTOR_2D<double>(static_cast<double>(x), static_cast<double>(y));
+					tmp.color = image.get(x, y);
+					bool attributed = false;
+					if (coarse != nullptr) {
+						// Take the refined mode of the nearest coarse pixel if the color is in its range
+						const int coarse_x = std::min((x + scale / 2) / scale, coarse->_width - 1);
+						const int coarse_y = std::min((y + scale / 2) / scale, coarse->_height - 1);
+						const T mode_color = coarse->_shift_vector_color.get(coarse_x, coarse_y);
+						if (normalized_distance(tmp.color, mode_color) <= _kernel_intensity) {
+							tmp.spatial = coarse->_shift_vector_spatial.get(coarse_x, coarse_y);
+							tmp.color = mode_color;
+							attributed = true;
+						}
+					} else if (previous != nullptr) {
+						// Warm start from the mode of the pixel in the previous frame
+						VECTOR_2D<double> v(0.0, 0.0);
+						if (motion != nullptr) {
+							v = motion->get(x, y);
+						}
+						const VECTOR_2D<int> r = this->motion_source(x, y, v);
+						const T mode_color = previous->_shift_vector_color.get(r.x, r.y);
+						if (normalized_distance(tmp.color, previous->_image.get(r.x, r.y)) <= Still_Tolerance * _kernel_intensity) {
+							tmp.spatial = previous->_shift_vector_spatial.get(r.x, r.y) + v;
+							tmp.color = mode_color;
+							attributed = true;
+						} else if (normalized_distance(tmp.color, mode_color) <= _kernel_intensity) {
+							tmp.spatial = previous->_shift_vector_spatial.get(r.x, r.y) + v;
+							tmp.color = mode_color;
+						}
 					}
-					ite = region_list->erase(ite);
-				} else {
-					++ite;
+					if (attributed == false) {
+						tmp = MeanShift(tmp, disc, Iter_Max, _basin_shortcut ? &trajectory : nullptr);
+					}
+					auto lambda = [](double value, double max) -> double {
+						return value >= 0 ? value < max ? value : max - 1.0 : 0;
+					};
+					// Saturation
+					tmp.spatial.x = lambda(tmp.spatial.x, _width);
+					tmp.spatial.y = lambda(tmp.spatial.y, _height);
+					// Set vector
+					_shift_vector_spatial.at(x, y) = tmp.spatial;
+					_shift_vector_color.at(x, y) = tmp.color;
+					// Record the convergence point (each pixel is written by only one thread)
+					converge[size_t(_width) * size_t(y) + size_t(x)] = size_t(_width) * size_t(tmp.spatial.y) + size_t(tmp.spatial.x);
+					if (_basin_shortcut) {
+						// Attribute the visited cells to the mode after the mode is written (the first trajectory claims each cell)
+						const size_t source = trajectory.mode != None ? trajectory.mode : size_t(_width) * size_t(y) + size_t(x);
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+						for (size_t n = 0; n < trajectory.cells.size(); n++) {
+							Segmentation<T>::BasinCell& cell = basin[trajectory.cells[n]];
+							int claimed;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+							claimed = cell.claimed++;
+							if (claimed == 0) {
+								cell.color = trajectory.colors[n];
+#ifdef _OPENMP
+#pragma omp flush
+#pragma omp atomic write
+#endif
+								cell.source = source;
+							}
+						}
+					}
+#if defined(OUTPUT_IMG_CLASS) || defined(OUTPUT_IMG_CLASS_SEGMENTATION)
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+					{
+						double ratio = double(++finished) / _image.size();
+						if (round(ratio * 1000.0) > progress) {
+							progress = size_t(round(ratio * 1000.0)); // Take account of Over-Run
+							printf("\r Mean-Shift method: %5.1f%%\x1b[1A\n", progress * 0.1);
+						}
+					}
+#endif
 				}
 			}
 		}
-		// Search densely small regions
-		for (std::list<std::list<VECTOR_2D<int> > >::const_iterator ite_region = small_region_list.begin();
-		    ite_region != small_region_list.end();
-		    ++ite_region) {
-			bool dense = true;
-			for (const VECTOR_2D<int>& r : *ite_region) {
-				for (size_t i = 0; i < 8; i++) {
-					if (small_region_map.get_zeropad(r.x + adjacent[i].x, r.y + adjacent[i].y) == false) {
-						dense = false;
-						break;
-					}
-				}
-				if (dense == false) {
-					break;
-				}
+	}
+
+	/*
+	 * Run Mean Shift on the level pyramid_level() of the image pyramid
+	 * with the spatial radius scaled down by the same factor.
+	 * The modes of the coarse pixels are upsampled and refined by _pyramid_refine_iterations iterations at full resolution,
+	 * and they are assigned to the full resolution pixels.
+	 */
+	template <class T>
+	void
+	Segmentation<T>::compute_shift_vectors_pyramid(const int Iter_Max)
+	{
+		const int Level = this->pyramid_level();
+		const double Scale = double(1 << Level);
+		ImgPyramid<T> pyramid(_image, Level + 1);
+		Segmentation<T> coarse;
+		std::vector<Span> disc;
+
+		coarse._image.copy(pyramid[Level]);
+		coarse._width = coarse._image.width();
+		coarse._height = coarse._image.height();
+		coarse._size = coarse._image.size();
+		coarse._kernel_spatial = _kernel_spatial / Scale;
+		coarse._kernel_intensity = _kernel_intensity;
+		coarse._basin_shortcut = _basin_shortcut;
+		coarse._converge_map.reset(coarse._width, coarse._height);
+		coarse._shift_vector_spatial.reset(coarse._width, coarse._height);
+		coarse._shift_vector_color.reset(coarse._width, coarse._height);
+		coarse.compute_shift_vectors(Iter_Max, nullptr, nullptr, nullptr);
+		// Refine the modes at full resolution
+		this->kernel_disc(&disc);
+		VECTOR_2D<double>* mode_spatial = coarse._shift_vector_spatial.data();
+		T* mode_color = coarse._shift_vector_color.data();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for (int y = 0; y < coarse._height; y++) {
+			for (int x = 0; x < coarse._width; x++) {
+				const size_t index = size_t(coarse._width) * size_t(y) + size_t(x);
+				Segmentation<T>::tuple mode;
+				mode.spatial = mode_spatial[index] * Scale;
+				mode.color = mode_color[index];
+				mode = MeanShift(mode, disc, std::min(Iter_Max, _pyramid_refine_iterations), nullptr);
+				mode_spatial[index] = mode.spatial;
+				mode_color[index] = mode.color;
 			}
-			if (dense) {
-				for (const VECTOR_2D<int>& r : *ite_region) {
-					dense_small_region_map.at(r.x, r.y) = true;
+		}
+		this->compute_shift_vectors(Iter_Max, &coarse, nullptr, nullptr);
+	}
+
+
+	/*
+	 * Counting sort of the pixels by their convergence points (_converge_map).
+	 * The pixels are counted and scattered in parallel with the atomic counters,
+	 * and each bucket is sorted afterwards so the pixels are in raster order regardless of the threads.
+	 */
+	template <class T>
+	void
+	Segmentation<T>::bucket_convergence(void)
+	{
+		const size_t* converge = _converge_map.data();
+		std::vector<size_t> cursor;
+
+		try {
+			_converge_offsets.assign(_size + 1, 0);
+			_converge_pixels.resize(_size);
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "void Segmentation<T>::bucket_convergence(void) : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		size_t* offsets = _converge_offsets.data();
+		size_t* pixels = _converge_pixels.data();
+		// Count
+		ImgParallel::for_each(_size,
+		    [converge, offsets](const size_t begin, const size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				size_t& count = offsets[converge[n] + 1];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+				count++;
+			}
+		});
+		for (size_t n = 0; n < _size; n++) {
+			offsets[n + 1] += offsets[n];
+		}
+		// Scatter
+		cursor.assign(_converge_offsets.begin(), _converge_offsets.end() - 1);
+		size_t* position = cursor.data();
+		ImgParallel::for_each(_size,
+		    [converge, pixels, position](const size_t begin, const size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				size_t k;
+				size_t& next = position[converge[n]];
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+				k = next++;
+				pixels[k] = n;
+			}
+		});
+		// Sort the pixels in each bucket
+		ImgParallel::for_each(_size,
+		    [offsets, pixels](const size_t begin, const size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				if (offsets[n + 1] - offsets[n] > 1) {
+					std::sort(pixels + offsets[n], pixels + offsets[n + 1]);
 				}
 			}
+		});
+	}
+
+
+	/*
+	 * Make the regions in CSR form from the label of each pixel (None for the pixels out of the regions).
+	 * The points of each region are in raster order.
+	 */
+	template <class T>
+	void
+	Segmentation<T>::regions_from_labels(const std::vector<size_t>& labels, const size_t num_region, Segmentation<T>::RegionList* regions)
+	{
+		const size_t None = size_t(-1);
+
+		regions->offsets.assign(num_region + 1, 0);
+		for (size_t n = 0; n < _size; n++) {
+			if (labels[n] != None) {
+				regions->offsets[labels[n] + 1]++;
+			}
 		}
-		// Concatenate dense small regions and small regions connecting to dense small regions
+		for (size_t k = 0; k < num_region; k++) {
+			regions->offsets[k + 1] += regions->offsets[k];
+		}
+		regions->points.resize(regions->offsets[num_region]);
+		std::vector<size_t> position(regions->offsets.begin(), regions->offsets.end() - 1);
 		for (int y = 0; y < _height; y++) {
 			for (int x = 0; x < _width; x++) {
-				if (dense_small_region_map.get(x, y) == false) {
-					continue;
+				const size_t label = labels[size_t(_width) * size_t(y) + size_t(x)];
+				if (label != None) {
+					regions->points[position[label]++] = VECTOR_2D<int>(x, y);
 				}
-				// Search connected region of the dense small region and its neighborhood
-				std::list<VECTOR_2D<int> > tmp_list(1, VECTOR_2D<int>(x, y));
-				dense_small_region_map.at(x, y) = false;
-				small_region_map.at(x, y) = false;
-				for (std::list<VECTOR_2D<int> >::iterator ite = tmp_list.begin();
-				    ite != tmp_list.end();
-				    ++ite) {
-					for (size_t i = 0; i < 8; i++) {
-						VECTOR_2D<int> r(ite->x + adjacent[i].x, ite->y + adjacent[i].y);
-						if (0 <= r.x && r.x < _width
-						    && 0 <= r.y && r.y < _height
-						    && small_region_map.get(r.x, r.y)) {
-							small_region_map.at(r.x, r.y) = false;
-							if (dense_small_region_map.get(r.x, r.y)) {
-								dense_small_region_map.at(r.x, r.y) = false;
-								tmp_list.push_back(r);
-							} else {
-								tmp_list.push_front(r);
+			}
+		}
+	}
+
+
+	/*
+	 * Label the 8-connected regions of the same number on _segmentation_map by union-find of the pixels.
+	 * The strips of the rows are labelled in parallel (the sets of the pixels do not cross the strips),
+	 * then the sets are united along the borders of the strips.
+	 * The regions are numbered in raster order of their first pixels (from 0 on region_labels and from 1 on _segmentation_map).
+	 */
+	template <class T>
+	size_t
+	Segmentation<T>::collect_regions_in_segmentation_map(std::vector<size_t>* region_labels)
+	{
+		const int width = _width;
+		const size_t Strip_Rows = std::max(size_t(1), ImgParallel::grain_size() / size_t(_width));
+		const size_t Num_Strips = ImgParallel::chunks(size_t(_height), Strip_Rows);
+		size_t* map = _segmentation_map.data();
+		ImgDisjointSet disjoint_set;
+		std::vector<size_t> strip_offsets;
+
+		try {
+			region_labels->resize(_size);
+			disjoint_set.reset(_size);
+			strip_offsets.assign(Num_Strips + 1, 0);
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "size_t Segmentation<T>::collect_regions_in_segmentation_map(std::vector<size_t>*) : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		size_t* labels = region_labels->data();
+		ImgDisjointSet* sets = &disjoint_set;
+		// Unite the pixels with the upper and the left neighbors of the same number
+		// (the neighbors out of [y_begin, y_end) are skipped)
+		auto unite_rows = [width, map, sets](const int y_begin, const int y_end, const int y_top) {
+			for (int y = y_begin; y < y_end; y++) {
+				for (int x = 0; x < width; x++) {
+					const size_t index = size_t(width) * size_t(y) + size_t(x);
+					const int neighbor_x[4] = {x - 1, x - 1, x, x + 1};
+					const int neighbor_y[4] = {y, y - 1, y - 1, y - 1};
+					for (int k = 0; k < 4; k++) {
+						if (0 <= neighbor_x[k] && neighbor_x[k] < width && y_top <= neighbor_y[k]) {
+							const size_t index_r = size_t(width) * size_t(neighbor_y[k]) + size_t(neighbor_x[k]);
+							if (map[index_r] == map[index]) {
+								sets->unite(index, index_r);
 							}
 						}
 					}
 				}
-				// Append new region to region_list
-				region_list->emplace_back(std::list<VECTOR_2D<int> >(0));
-				for (const VECTOR_2D<int>& r : tmp_list) {
-					if (region_list_map.get(r.x, r.y) != nullptr) {
-						std::list<VECTOR_2D<int> >* small_region = region_list_map.get(r.x, r.y);
-						for (const VECTOR_2D<int>& r_tmp : *small_region) {
-							region_list_map.at(r_tmp.x, r_tmp.y) = nullptr;
+			}
+		};
+		ImgParallel::for_each(size_t(_height), Strip_Rows,
+		    [&unite_rows](const size_t begin, const size_t end) {
+			unite_rows(int(begin), int(end), int(begin));
+		});
+		for (size_t c = 1; c < Num_Strips; c++) {
+			const int y = int(c * Strip_Rows);
+			unite_rows(y, y + 1, y - 1);
+		}
+		// Number the roots (the first pixels of the regions) in raster order
+		const size_t strip_size = Strip_Rows * size_t(_width);
+		size_t* offsets = strip_offsets.data();
+		ImgParallel::for_each(_size, strip_size,
+		    [sets, offsets, strip_size](const size_t begin, const size_t end) {
+			size_t count = 0;
+			for (size_t n = begin; n < end; n++) {
+				if (sets->is_root(n)) {
+					count++;
+				}
+			}
+			offsets[begin / strip_size + 1] = count;
+		});
+		for (size_t c = 0; c < Num_Strips; c++) {
+			offsets[c + 1] += offsets[c];
+		}
+		ImgParallel::for_each(_size, strip_size,
+		    [sets, offsets, labels, strip_size](const size_t begin, const size_t end) {
+			size_t num = offsets[begin / strip_size];
+			for (size_t n = begin; n < end; n++) {
+				if (sets->is_root(n)) {
+					labels[n] = num++;
+				}
+			}
+		});
+		// Label the other pixels by their roots
+		ImgParallel::for_each(_size, strip_size,
+		    [sets, labels, map](const size_t begin, const size_t end) {
+			for (size_t n = begin; n < end; n++) {
+				if (sets->is_root(n) == false) {
+					labels[n] = labels[sets->root(n)];
+				}
+				map[n] = labels[n] + 1;
+			}
+		});
+		return strip_offsets[Num_Strips];
+	}
+
+
+	/*
+	 * Make the region adjacency graph of the 8-adjacent regions with the number of the pixels and the mean color of each region.
+	 * The neighbors of the regions on the 8-adjacent pixels are counted and scattered to the regions in parallel with the atomic counters
+	 * as bucket_convergence(), then the neighbors of each region are sorted and the duplicates are removed.
+	 */
+	template <class T>
+	void
+	Segmentation<T>::region_graph(const std::vector<size_t>& labels, const size_t num_region, Segmentation<T>::RegionGraph* graph) const
+	{
+		const int width = _width;
+		const int height = _height;
+		const size_t* label = labels.data();
+		std::vector<T> sum_colors;
+		std::vector<size_t> cursor;
+
+		try {
+			graph->offsets.assign(num_region + 1, 0);
+			graph->pixels.assign(num_region, 0);
+			graph->colors.resize(num_region);
+			sum_colors.assign(num_region, T());
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "void Segmentation<T>::region_graph(const std::vector<size_t>&, const size_t, RegionGraph*) const : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		for (size_t n = 0; n < _size; n++) {
+			graph->pixels[label[n]]++;
+			sum_colors[label[n]] += _image.get(n);
+		}
+		for (size_t k = 0; k < num_region; k++) {
+			graph->colors[k] = sum_colors[k] / double(graph->pixels[k]);
+		}
+		// Each pair of the 8-adjacent pixels in the different regions is seen from the upper or the left one
+		auto for_each_pair = [width, height, label](const size_t begin, const size_t end, size_t* counts, size_t* adjacent) {
+			for (size_t n = begin; n < end; n++) {
+				const int x = int(n % size_t(width));
+				const int y = int(n / size_t(width));
+				const int neighbor_x[4] = {x + 1, x - 1, x, x + 1};
+				const int neighbor_y[4] = {y, y + 1, y + 1, y + 1};
+				for (int k = 0; k < 4; k++) {
+					if (0 <= neighbor_x[k] && neighbor_x[k] < width && neighbor_y[k] < height) {
+						const size_t region = label[n];
+						const size_t region_r = label[size_t(width) * size_t(neighbor_y[k]) + size_t(neighbor_x[k])];
+						if (region_r == region) {
+							continue;
+						}
+						if (adjacent == nullptr) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+							counts[region + 1]++;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+							counts[region_r + 1]++;
+						} else {
+							size_t i, j;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+							i = counts[region]++;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+							j = counts[region_r]++;
+							adjacent[i] = region_r;
+							adjacent[j] = region;
 						}
-						region_list->back().splice(region_list->back().end(), *small_region);
 					}
 				}
 			}
+		};
+		// Count
+		size_t* offsets = graph->offsets.data();
+		ImgParallel::for_each(_size,
+		    [&for_each_pair, offsets](const size_t begin, const size_t end) {
+			for_each_pair(begin, end, offsets, nullptr);
+		});
+		for (size_t k = 0; k < num_region; k++) {
+			offsets[k + 1] += offsets[k];
 		}
-		// Append the rest of small regions which is not next to densely one to region_list
-		for (std::list<std::list<VECTOR_2D<int> > >::iterator ite = small_region_list.begin();
-		    ite != small_region_list.end();
-		    ++ite) {
-			if (ite->size() > 0) {
-				region_list->emplace_back();
-				region_list->back().assign(ite->begin(), ite->end());
+		// Scatter
+		try {
+			graph->adjacent.resize(offsets[num_region]);
+			cursor.assign(graph->offsets.begin(), graph->offsets.end() - 1);
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "void Segmentation<T>::region_graph(const std::vector<size_t>&, const size_t, RegionGraph*) const : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		size_t* adjacent = graph->adjacent.data();
+		size_t* position = cursor.data();
+		ImgParallel::for_each(_size,
+		    [&for_each_pair, position, adjacent](const size_t begin, const size_t end) {
+			for_each_pair(begin, end, position, adjacent);
+		});
+		this->pack_region_graph(num_region, graph);
+	}
+
+	/*
+	 * Sort the neighbors of each region of graph in parallel, remove the duplicates and pack them.
+	 */
+	template <class T>
+	void
+	Segmentation<T>::pack_region_graph(const size_t num_region, Segmentation<T>::RegionGraph* graph) const
+	{
+		std::vector<size_t> unique_count;
+
+		try {
+			unique_count.resize(num_region);
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "void Segmentation<T>::pack_region_graph(const size_t, RegionGraph*) const : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		size_t* offsets = graph->offsets.data();
+		size_t* adjacent = graph->adjacent.data();
+		size_t* unique = unique_count.data();
+		ImgParallel::for_each(num_region,
+		    [offsets, adjacent, unique](const size_t begin, const size_t end) {
+			for (size_t k = begin; k < end; k++) {
+				std::sort(adjacent + offsets[k], adjacent + offsets[k + 1]);
+				unique[k] = size_t(std::unique(adjacent + offsets[k], adjacent + offsets[k + 1]) - (adjacent + offsets[k]));
 			}
+		});
+		size_t num_adjacent = 0;
+		for (size_t k = 0; k < num_region; k++) {
+			std::copy(adjacent + offsets[k], adjacent + offsets[k] + unique[k], adjacent + num_adjacent);
+			offsets[k] = num_adjacent;
+			num_adjacent += unique[k];
 		}
-		// Remove empty region from region_list
-		region_list->remove_if([](std::list<VECTOR_2D<int> >& region) { return region.size() == 0; });
-		return num_small_region;
+		offsets[num_region] = num_adjacent;
+		graph->adjacent.resize(num_adjacent);
 	}
 
 
+	/*
+	 * Merge the regions smaller than min_pixels into the adjacent regions on the region adjacency graph.
+	 * The two regions of an edge are merged unless both of them include a large region,
+	 * and the edges are taken in ascending order of the distance of the mean colors of the collected regions (the minimum spanning forest),
+	 * so each small region joins the large region reached by the nearest colors (the small regions out of reach of any large region are merged together).
+	 * The forest is found by Boruvka's rounds: every group of the small regions takes its nearest edge in each round
+	 * and the number of the groups is at least halved, so the edges are scanned O(log V) times without sorting.
+	 * The ties of the distance are broken by the order of the edges (a, b).
+	 * The regions are renumbered in raster order of their first pixels and the number of the regions is returned.
+	 * graph is set to the region adjacency graph of the merged regions, which is contracted from the graph of the collected regions.
+	 */
 	template <class T>
-	void
-	Segmentation<T>::small_region_eliminator(std::list<std::list<VECTOR_2D<int> > >* region_list)
+	size_t
+	Segmentation<T>::merge_small_regions(std::vector<size_t>* labels, const size_t num_region, const size_t min_pixels, Segmentation<T>::RegionGraph* graph)
 	{
-		const VECTOR_2D<int> adjacent[8] = {
-		    VECTOR_2D<int>(-1, -1), VECTOR_2D<int>(0, -1), VECTOR_2D<int>(1, -1),
-		    VECTOR_2D<int>(-1, 0), VECTOR_2D<int>(1, 0),
-		    VECTOR_2D<int>(-1, 1), VECTOR_2D<int>(0, 1), VECTOR_2D<int>(1, 1)};
-		std::list<VECTOR_2D<int> > small_region;
-		ImgVector<std::list<VECTOR_2D<int> >*> region_list_map(_width, _height);
+		const size_t None = size_t(-1);
+		std::vector<Segmentation<T>::RegionEdge> edges;
+		std::vector<bool> large(num_region, false);
+		std::vector<size_t> nearest(num_region, None);
+		ImgDisjointSet disjoint_set(num_region);
+		size_t num_small_region = 0;
 
-		// Search small regions
-		{
-			std::list<std::list<VECTOR_2D<int> > >::iterator ite = region_list->begin();
-			while (ite != region_list->end()) {
-				if (ite->size() < _min_pixels) {
-					// Count the number of small regions here because some regions may become larger on this routine
-					small_region.splice(small_region.end(), *ite);
-					ite = region_list->erase(ite);
-				} else {
-					++ite;
+		this->region_graph(*labels, num_region, graph);
+		for (size_t k = 0; k < num_region; k++) {
+			if (graph->pixels[k] >= min_pixels) {
+				large[k] = true;
+			} else {
+				num_small_region++;
+			}
+		}
+		if (num_small_region == 0) {
+			return num_region;
+		}
+		// The edges with the nearest edge of each small region
+		edges.reserve(graph->adjacent.size() / 2);
+		for (size_t a = 0; a < num_region; a++) {
+			for (size_t i = graph->offsets[a]; i < graph->offsets[a + 1]; i++) {
+				const size_t b = graph->adjacent[i];
+				if (a < b && (large[a] == false || large[b] == false)) {
+					Segmentation<T>::RegionEdge edge = {normalized_distance(graph->colors[a], graph->colors[b]), a, b};
+					edges.push_back(edge);
+					if (large[a] == false && (nearest[a] == None || edge.distance < edges[nearest[a]].distance)) {
+						nearest[a] = edges.size() - 1;
+					}
+					if (large[b] == false && (nearest[b] == None || edge.distance < edges[nearest[b]].distance)) {
+						nearest[b] = edges.size() - 1;
+					}
+				}
+			}
+		}
+		while (edges.empty() == false) {
+			// Merge the groups along their nearest edges
+			for (size_t k = 0; k < num_region; k++) {
+				if (nearest[k] == None) {
+					continue;
+				}
+				const size_t a = disjoint_set.find(edges[nearest[k]].a);
+				const size_t b = disjoint_set.find(edges[nearest[k]].b);
+				nearest[k] = None;
+				if (a != b && (large[a] == false || large[b] == false)) {
+					large[disjoint_set.unite(a, b)] = large[a] || large[b];
+					num_small_region--;
+				}
+			}
+			if (num_small_region == 0) {
+				break;
+			}
+			// The nearest edge of each group of the small regions (the edges inside the groups are removed)
+			size_t num_edge = 0;
+			for (size_t i = 0; i < edges.size(); i++) {
+				const size_t a = disjoint_set.find(edges[i].a);
+				const size_t b = disjoint_set.find(edges[i].b);
+				if (a == b || (large[a] && large[b])) {
+					continue;
 				}
+				edges[num_edge].distance = edges[i].distance;
+				edges[num_edge].a = a;
+				edges[num_edge].b = b;
+				if (large[a] == false
+				    && (nearest[a] == None || edges[num_edge].distance < edges[nearest[a]].distance)) {
+					nearest[a] = num_edge;
+				}
+				if (large[b] == false
+				    && (nearest[b] == None || edges[num_edge].distance < edges[nearest[b]].distance)) {
+					nearest[b] = num_edge;
+				}
+				num_edge++;
 			}
+			edges.resize(num_edge);
 		}
-		// Make region_list_map
-		for (std::list<std::list<VECTOR_2D<int> > >::iterator ite = region_list->begin();
-		    ite != region_list->end();
-		    ++ite) {
-			for (const VECTOR_2D<int>& r : *ite) {
-				region_list_map.at(r.x, r.y) = &(*ite);
+		// Renumber the regions by their roots (the region whose first pixel comes first)
+		std::vector<size_t> number(num_region, None);
+		size_t num = 0;
+		for (size_t k = 0; k < num_region; k++) {
+			if (disjoint_set.is_root(k)) {
+				number[k] = num++;
 			}
 		}
-		// Concatenate dense small regions and small regions connecting to dense small regions
+		for (size_t k = 0; k < num_region; k++) {
+			number[k] = number[disjoint_set.find(k)];
+		}
+		for (size_t n = 0; n < _size; n++) {
+			(*labels)[n] = number[(*labels)[n]];
+		}
+		// Contract the graph (the edges are relabelled by the merged regions, then sorted and uniqued)
+		Segmentation<T>::RegionGraph merged;
+		std::vector<T> sum_colors;
+		try {
+			merged.offsets.assign(num + 1, 0);
+			merged.pixels.assign(num, 0);
+			merged.colors.resize(num);
+			sum_colors.assign(num, T());
+		}
+		catch (const std::bad_alloc& bad) {
+			std::cerr << bad.what() << std::endl
+			    << "size_t Segmentation<T>::merge_small_regions(std::vector<size_t>*, const size_t, const size_t, RegionGraph*) : Cannot Allocate Memory" << std::endl;
+			throw;
+		}
+		for (size_t k = 0; k < num_region; k++) {
+			merged.pixels[number[k]] += graph->pixels[k];
+			sum_colors[number[k]] += graph->colors[k] * double(graph->pixels[k]);
+			for (size_t i = graph->offsets[k]; i < graph->offsets[k + 1]; i++) {
+				if (number[graph->adjacent[i]] != number[k]) {
+					merged.offsets[number[k] + 1]++;
+				}
+			}
+		}
+		for (size_t m = 0; m < num; m++) {
+			merged.colors[m] = sum_colors[m] / double(merged.pixels[m]);
+			merged.offsets[m + 1] += merged.offsets[m];
+		}
+		merged.adjacent.resize(merged.offsets[num]);
 		{
-			while (small_region.size() > 0) {
-				VECTOR_2D<int> r(small_region.front());
-				VECTOR_2D<int> r_new(r);
-				T color = _image.get(r.x, r.y);
-				double min = DBL_MAX;
-				for (size_t i = 0; i < 8; i++) {
-					VECTOR_2D<int> r_tmp(r + adjacent[i]);
-					if (0 <= r_tmp.x && r_tmp.x < _width
-					    && 0 <= r_tmp.y && r_tmp.y < _height
-					    && region_list_map.get(r_tmp.x, r_tmp.y) != nullptr) {
-						double dist = norm_squared(color - _image.get(r_tmp.x, r_tmp.y));
-						if (dist < min) {
-							min = dist;
-							r_new = r_tmp;
-						}
+			std::vector<size_t> cursor(merged.offsets.begin(), merged.offsets.end() - 1);
+			for (size_t k = 0; k < num_region; k++) {
+				for (size_t i = graph->offsets[k]; i < graph->offsets[k + 1]; i++) {
+					if (number[graph->adjacent[i]] != number[k]) {
+						merged.adjacent[cursor[number[k]]++] = number[graph->adjacent[i]];
 					}
 				}
-				// Concatenate the pixel to nearest region
-				if (region_list_map.get(r_new.x, r_new.y) != nullptr) {
-					region_list_map.at(r_new.x, r_new.y)->push_back(r);
-					region_list_map.at(r.x, r.y) = region_list_map.get(r_new.x, r_new.y);
-				} else {
-					small_region.push_back(r);
-				}
-				small_region.pop_front();
 			}
 		}
+		this->pack_region_graph(num, &merged);
+		std::swap(*graph, merged);
+		return num;
 	}
 
 
@@ -748,16 +1865,23 @@ namespace ImgClass {
 	double
 	Segmentation<T>::distance(const T& lvalue, const T& rvalue)
 	{
-		return fabs(lvalue - rvalue);
+		return norm(lvalue - rvalue);
+	}
+
+	template <class T>
+	double
+	Segmentation<T>::normalized_distance(const T& lvalue, const T& rvalue)
+	{
+		return distance(lvalue, rvalue);
 	}
 
 	template <>
 	double
-	Segmentation<ImgClass::RGB>::distance(const ImgClass::RGB& lvalue, const ImgClass::RGB& rvalue);
+	Segmentation<ImgClass::Lab>::normalized_distance(const ImgClass::Lab& lvalue, const ImgClass::Lab& rvalue);
 
 	template <>
 	double
-	Segmentation<ImgClass::Lab>::distance(const ImgClass::Lab& lvalue, const ImgClass::Lab& rvalue);
+	Segmentation<ImgClass::Labf>::normalized_distance(const ImgClass::Labf& lvalue, const ImgClass::Labf& rvalue);
 
 
 	/*
@@ -768,34 +1892,51 @@ namespace ImgClass {
 	 */
 	template <class T>
 	const typename Segmentation<T>::tuple
-	Segmentation<T>::MeanShift(const int x, const int y, std::vector<VECTOR_2D<int> >& pel_list, int Iter_Max)
+	Segmentation<T>::MeanShift(const tuple& start, const std::vector<Span>& disc, int Iter_Max, Trajectory* trajectory)
 	{
 		const double radius_spatial_squared = SQUARE(_kernel_spatial);
 		const double radius_intensity_squared = SQUARE(_kernel_intensity);
 		const double displacement_min = SQUARE(0.01);
+		const ImgVector<T>& image = _image;
+		const T* pixels = image.data();
 		// Initialize
 		Segmentation<T>::tuple tuple;
-		tuple.spatial = VECTOR_2D<double>(static_cast<double>(x), static_cast<double>(y));
-		tuple.color = _image.get(x, y);
+		tuple = start;
 		// Iterate until it converge
 		for (int i = 0; i < Iter_Max; i++) {
+			if (trajectory != nullptr && attributed_mode(&tuple, trajectory)) {
+				break;
+			}
+			const double center_x = round(tuple.spatial.x);
+			const double center_y = round(tuple.spatial.y);
 			double N = 0.0;
 			double sum_intensity_diff = 0.0;
 			VECTOR_2D<double> sum_d(0.0, 0.0);
-			for (size_t n = 0; n < pel_list.size(); n++) {
-				VECTOR_2D<int> r(
-				    static_cast<int>(round(tuple.spatial.x) + pel_list[n].x),
-				    static_cast<int>(round(tuple.spatial.y) + pel_list[n].y));
-				if (0 <= r.x && r.x < _width && 0 <= r.y && r.y < _height) {
-					double intensity_diff = _image.get(r.x, r.y) - tuple.color;
-					VECTOR_2D<double> d(r.x - tuple.spatial.x, r.y - tuple.spatial.y);
+			for (size_t k = 0; k < disc.size(); k++) {
+				// Clip the row to the image instead of checking each pixel
+				const double row_y = center_y + disc[k].y;
+				const double row_begin = std::max(center_x + disc[k].x_begin, 0.0);
+				const double row_end = std::min(center_x + disc[k].x_end, _width - 1.0);
+				if (!(0.0 <= row_y && row_y < _height && row_begin <= row_end)) {
+					continue;
+				}
+				const int r_y = static_cast<int>(row_y);
+				const int x_begin = static_cast<int>(row_begin);
+				const int x_end = static_cast<int>(row_end);
+				const T* row = pixels + size_t(_width) * size_t(r_y);
+				const double d_y = r_y - tuple.spatial.y;
+				const double d_y_squared = d_y * d_y;
+				for (int r_x = x_begin; r_x <= x_end; r_x++) {
+					double intensity_diff = row[r_x] - tuple.color;
+					double d_x = r_x - tuple.spatial.x;
 					double ratio_intensity = SQUARE(intensity_diff) / radius_intensity_squared;
-					double ratio_spatial = norm_squared(d) / radius_spatial_squared;
+					double ratio_spatial = (d_x * d_x + d_y_squared) / radius_spatial_squared;
 					if (ratio_intensity <= 1.0 && ratio_spatial <= 1.0) {
 						double coeff = 1.0 - (ratio_intensity * ratio_spatial);
 						N += coeff;
 						sum_intensity_diff += intensity_diff * coeff;
-						sum_d += d * coeff;
+						sum_d.x += d_x * coeff;
+						sum_d.y += d_y * coeff;
 					}
 				}
 			}
@@ -809,15 +1950,130 @@ namespace ImgClass {
 		return tuple;
 	}
 
+	/*
+	 * Mean Shift for the color types.
+	 * The color difference is thresholded by its norm with radius_intensity.
+	 */
+	template <class T>
+	const typename Segmentation<T>::tuple
+	Segmentation<T>::MeanShift_color(const tuple& start, const std::vector<Span>& disc, int Iter_Max, const double radius_intensity, Trajectory* trajectory)
+	{
+		const double radius_spatial_squared = SQUARE(_kernel_spatial);
+		const double radius_intensity_squared = SQUARE(radius_intensity);
+		const double displacement_color_min = SQUARE(0.0001);
+		const double displacement_spatial_min = SQUARE(0.01);
+		const ImgVector<T>& image = _image;
+		const T* pixels = image.data();
+		Segmentation<T>::tuple tuple;
+
+		// Initialize
+		tuple = start;
+		// Iterate until it converge
+		T sum_diff;
+		VECTOR_2D<double> sum_d(0.0, 0.0);
+		for (int i = 0; i < Iter_Max; i++) {
+			if (trajectory != nullptr && attributed_mode(&tuple, trajectory)) {
+				break;
+			}
+			const double center_x = round(tuple.spatial.x);
+			const double center_y = round(tuple.spatial.y);
+			double N = 0.0;
+			sum_diff = T();
+			sum_d.x = 0.0; sum_d.y = 0.0;
+			for (size_t k = 0; k < disc.size(); k++) {
+				// Clip the row to the image instead of checking each pixel
+				const double row_y = center_y + disc[k].y;
+				const double row_begin = std::max(center_x + disc[k].x_begin, 0.0);
+				const double row_end = std::min(center_x + disc[k].x_end, _width - 1.0);
+				if (!(0.0 <= row_y && row_y < _height && row_begin <= row_end)) {
+					continue;
+				}
+				const int r_y = static_cast<int>(row_y);
+				const int x_begin = static_cast<int>(row_begin);
+				const int x_end = static_cast<int>(row_end);
+				const T* row = pixels + size_t(_width) * size_t(r_y);
+				const double d_y = r_y - tuple.spatial.y;
+				const double d_y_squared = d_y * d_y;
+				for (int r_x = x_begin; r_x <= x_end; r_x++) {
+					T diff(row[r_x] - tuple.color);
+					double d_x = r_x - tuple.spatial.x;
+					double ratio_intensity = norm_squared(diff) / radius_intensity_squared;
+					double ratio_spatial = (d_x * d_x + d_y_squared) / radius_spatial_squared;
+					if (ratio_intensity <= 1.0 && ratio_spatial <= 1.0) {
+						double coeff = 1.0 - (ratio_intensity * ratio_spatial);
+						N += coeff;
+						sum_diff += diff * coeff;
+						sum_d.x += d_x * coeff;
+						sum_d.y += d_y * coeff;
+					}
+				}
+			}
+			tuple.color += sum_diff / N;
+			VECTOR_2D<double> displacement(sum_d.x / N, sum_d.y / N);
+			tuple.spatial += displacement;
+			if (norm_squared(sum_diff / N) < displacement_color_min && norm_squared(displacement) < displacement_spatial_min) {
+				break;
+			}
+		}
+		return tuple;
+	}
+
+	/*
+	 * Basin-of-attraction shortcut.
+	 * If an earlier trajectory visited the cell of the current position
+	 * with the color within Range_Tolerance * _kernel_intensity of the current color,
+	 * the tuple is replaced by the mode of the earlier trajectory and true is returned.
+	 * Otherwise the cell is recorded in the trajectory.
+	 */
+	template <class T>
+	bool
+	Segmentation<T>::attributed_mode(Segmentation<T>::tuple* tuple, Segmentation<T>::Trajectory* trajectory)
+	{
+		const size_t None = size_t(-1);
+		const double Range_Tolerance = 0.1;
+		const double center_x = round(tuple->spatial.x);
+		const double center_y = round(tuple->spatial.y);
+
+		if (!(0.0 <= center_x && center_x < _width && 0.0 <= center_y && center_y < _height)) {
+			return false;
+		}
+		const size_t index = size_t(_width) * size_t(center_y) + size_t(center_x);
+		const Segmentation<T>::BasinCell& cell = trajectory->basin[index];
+		size_t source;
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+		source = cell.source;
+		if (source != None) {
+			// The color of the cell and the mode of source are written before the source
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+			if (normalized_distance(tuple->color, cell.color) <= Range_Tolerance * _kernel_intensity) {
+				tuple->spatial = _shift_vector_spatial.get(source);
+				tuple->color = _shift_vector_color.get(source);
+				trajectory->mode = source;
+				return true;
+			}
+		}
+		trajectory->cells.push_back(index);
+		trajectory->colors.push_back(tuple->color);
+		return false;
+	}
+
 	/*
 	 * std::vector<double> kernel has kernel radius for each dimensions.
 	 * The values it needs are below:
 	 *	_kernel_spatial : the spatial radius of mean shift kernel
-	 *	_kernel_intensity : the norm threshold of mean shift kernel in L*a*b* space
+	 *	_kernel_intensity : the norm threshold of mean shift kernel in RGB space
 	 */
-	template <> // Specialized for ImgClass::RGB<double>
+	template <> // Specialized for ImgClass::RGB
 	const Segmentation<ImgClass::RGB>::tuple
-	Segmentation<ImgClass::RGB>::MeanShift(const int x, const int y, std::vector<VECTOR_2D<int> >& pel_list, int Iter_Max);
+	Segmentation<ImgClass::RGB>::MeanShift(const tuple& start, const std::vector<Span>& disc, int Iter_Max, Trajectory* trajectory);
+
+	template <> // Specialized for ImgClass::RGBf
+	const Segmentation<ImgClass::RGBf>::tuple
+	Segmentation<ImgClass::RGBf>::MeanShift(const tuple& start, const std::vector<Span>& disc, int Iter_Max, Trajectory* trajectory);
 
 	/*
 	 * std::vector<double> kernel has kernel radius for each dimensions.
@@ -827,6 +2083,9 @@ namespace ImgClass {
 	 */
 	template <> // Specialized for ImgClass::Lab
 	const Segmentation<ImgClass::Lab>::tuple
-	Segmentation<ImgClass::Lab>::MeanShift(const int x, const int y, std::vector<VECTOR_2D<int> >& pel_list, int Iter_Max);
-}
+	Segmentation<ImgClass::Lab>::MeanShift(const tuple& start, const std::vector<Span>& disc, int Iter_Max, Trajectory* trajectory);
 
+	template <> // Specialized for ImgClass::Labf
+	const Segmentation<ImgClass::Labf>::tuple
+	Segmentation<ImgClass::Labf>::MeanShift(const tuple& start, const std::vector<Span>& disc, int Iter_Max, Trajectory* trajectory);
+}
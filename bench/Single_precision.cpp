@@ -0,0 +1,175 @@
+/*
+ * Measure BlockMatching, ImgClass::Segmentation and MotionCompensation in single precision against double precision.
+ * The times are the best of Repeat runs and the differences are the largest differences of the results from double precision.
+ *
+ * g++ -std=c++11 -O2 -fopenmp -I.. Single_precision.cpp ../RGB.cpp ../Lab.cpp ../HSV.cpp ../BlockMatching.cpp ../Segmentation.cpp ../ImgStatistics.cpp ../CrossCorrelation.cpp -o Single_precision
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../Color.h"
+#include "../Vector.h"
+#include "../ImgClass.h"
+#include "../BlockMatching.h"
+#include "../MotionCompensation.h"
+#include "../Segmentation.h"
+
+namespace {
+	const int Width = 320;
+	const int Height = 240;
+	const int Repeat = 5;
+	const int BlockSize = 8;
+	const int Search_Range = 17;
+
+	// The smooth texture moved by (t, t / 2) on the frame t
+	double
+	texture(const int x, const int y, const int t, const int c)
+	{
+		const double u = double(x - t);
+		const double v = double(y - t / 2);
+		return 0.5 + 0.2 * std::sin(0.21 * u + 0.7 * c) * std::cos(0.17 * v) + 0.15 * std::sin(0.05 * (u + v) + 0.3 * c);
+	}
+
+	template <class T>
+	struct Frame
+	{
+		static T pixel(const int x, const int y, const int t) { return T(texture(x, y, t, 0)); }
+		static double distance(const T& a, const T& b) { return std::fabs(double(a) - double(b)); }
+	};
+
+	template <class S>
+	struct Frame<ImgClass::basic_RGB<S> >
+	{
+		static ImgClass::basic_RGB<S> pixel(const int x, const int y, const int t) { return ImgClass::basic_RGB<S>(S(texture(x, y, t, 0)), S(texture(x, y, t, 1)), S(texture(x, y, t, 2))); }
+		static double distance(const ImgClass::basic_RGB<S>& a, const ImgClass::basic_RGB<S>& b) { return std::max(std::fabs(double(a.R) - double(b.R)), std::max(std::fabs(double(a.G) - double(b.G)), std::fabs(double(a.B) - double(b.B)))); }
+	};
+
+	template <class T>
+	ImgVector<T>
+	frame(const int t)
+	{
+		ImgVector<T> image(Width, Height);
+		for (int y = 0; y < Height; y++) {
+			for (int x = 0; x < Width; x++) {
+				image.at(x, y) = Frame<T>::pixel(x, y, t);
+			}
+		}
+		return image;
+	}
+
+	// The best time of Repeat runs in milliseconds
+	template <class F>
+	double
+	best_time(F f)
+	{
+		double best = 0.0;
+		for (int i = 0; i < Repeat; i++) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			f();
+			double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (i == 0 || elapsed < best) {
+				best = elapsed;
+			}
+		}
+		return best;
+	}
+
+	template <class D, class F>
+	void
+	block_matching(const char* name)
+	{
+		const ImgVector<D> prev_d = frame<D>(0), current_d = frame<D>(1), next_d = frame<D>(2);
+		const ImgVector<F> prev_f = frame<F>(0), current_f = frame<F>(1), next_f = frame<F>(2);
+		BlockMatching<D> result_d;
+		BlockMatching<F> result_f;
+		const double time_d = best_time([&]() {
+			result_d.reset(prev_d, current_d, next_d, BlockSize);
+			result_d.block_matching(Search_Range);
+		});
+		const double time_f = best_time([&]() {
+			result_f.reset(prev_f, current_f, next_f, BlockSize);
+			result_f.block_matching(Search_Range);
+		});
+		size_t differ = 0;
+		for (int y = 0; y < result_d.vector_field_height(); y++) {
+			for (int x = 0; x < result_d.vector_field_width(); x++) {
+				VECTOR_2D<double> prev = result_d.get_block_prev(x, y);
+				VECTOR_2D<double> next = result_d.get_block_next(x, y);
+				if (prev != result_f.get_block_prev(x, y) || next != result_f.get_block_next(x, y)) {
+					differ++;
+				}
+			}
+		}
+		printf("BlockMatching      %-5s %9.1f ms %9.1f ms %6.2f   %zu of %d blocks differ\n",
+		    name, time_d, time_f, time_d / time_f, differ, result_d.vector_field_width() * result_d.vector_field_height());
+	}
+
+	template <class D, class F>
+	void
+	segmentation(const char* name, const double kernel_intensity)
+	{
+		const ImgVector<D> image_d = frame<D>(0);
+		const ImgVector<F> image_f = frame<F>(0);
+		ImgClass::Segmentation<D> result_d;
+		ImgClass::Segmentation<F> result_f;
+		const double time_d = best_time([&]() {
+			result_d.reset(image_d, 8.0, kernel_intensity);
+		});
+		const double time_f = best_time([&]() {
+			result_f.reset(image_f, 8.0, kernel_intensity);
+		});
+		size_t differ = 0;
+		for (size_t n = 0; n < image_d.size(); n++) {
+			if (result_d.ref_segmentation_map().get(n) != result_f.ref_segmentation_map().get(n)) {
+				differ++;
+			}
+		}
+		printf("Segmentation       %-5s %9.1f ms %9.1f ms %6.2f   %zu of %zu labels differ (%zu and %zu regions)\n",
+		    name, time_d, time_f, time_d / time_f, differ, image_d.size(), result_d.ref_regions().size(), result_f.ref_regions().size());
+	}
+
+	template <class D, class F>
+	void
+	motion_compensation(const char* name)
+	{
+		const ImgVector<D> prev_d = frame<D>(0), current_d = frame<D>(1);
+		const ImgVector<F> prev_f = frame<F>(0), current_f = frame<F>(1);
+		// The subpixel motion to use the interpolation
+		const ImgVector<VECTOR_2D<double> > vector(Width, Height, VECTOR_2D<double>(0.75, 0.25));
+		ImgVector<D> compensated_d;
+		ImgVector<F> compensated_f;
+		// The constructor creates the compensated image
+		const double time_d = best_time([&]() {
+			MotionCompensation<D> compensation(prev_d, current_d, vector);
+			compensated_d = compensation.ref_image_compensated();
+		});
+		const double time_f = best_time([&]() {
+			MotionCompensation<F> compensation(prev_f, current_f, vector);
+			compensated_f = compensation.ref_image_compensated();
+		});
+		double max_difference = 0.0;
+		for (size_t n = 0; n < compensated_d.size(); n++) {
+			max_difference = std::max(max_difference, Frame<D>::distance(compensated_d.get(n), D(compensated_f.get(n))));
+		}
+		printf("MotionCompensation %-5s %9.1f ms %9.1f ms %6.2f   max difference %.2e\n",
+		    name, time_d, time_f, time_d / time_f, max_difference);
+	}
+}
+
+int
+main(void)
+{
+	printf("%d x %d, best of %d runs\n", Width, Height, Repeat);
+	printf("                         double       float   ratio\n");
+	block_matching<double, float>("gray");
+	block_matching<ImgClass::RGB, ImgClass::RGBf>("RGB");
+	segmentation<double, float>("gray", 10.0 / 255.0);
+	segmentation<ImgClass::RGB, ImgClass::RGBf>("RGB", 10.0 / 255.0);
+	motion_compensation<double, float>("gray");
+	motion_compensation<ImgClass::RGB, ImgClass::RGBf>("RGB");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,238 @@
+/*
+ * Measure the tiled access against the row-major access on the wide frames.
+ * BlockMatching searches in the window copied by ImgVector<T>::copy_window_zeropad(), and it is compared with
+ * the previous search which reads the reference frame by get_zeropad() for every candidate.
+ * MotionCompensation samples the reference frame row by row, and it is compared with the sampling of 32 x 32 tiles.
+ * The results of both accesses must be equal.
+ *
+ * g++ -std=c++11 -O2 -fopenmp -I.. Tiled_search_window.cpp ../RGB.cpp ../Lab.cpp ../HSV.cpp ../BlockMatching.cpp ../Segmentation.cpp ../ImgStatistics.cpp ../CrossCorrelation.cpp -o Tiled_search_window
+ */
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../Color.h"
+#include "../Vector.h"
+#include "../ImgClass.h"
+#include "../IntegralImage.h"
+#include "../BlockMatching.h"
+#include "../MotionCompensation.h"
+
+namespace {
+	const int Width = 3840;
+	const int Height = 96;
+	const int Repeat = 3;
+	const int BlockSize = 8;
+	const int Search_Range = 17;
+
+	// The smooth texture moved by (t, t / 2) on the frame t
+	ImgVector<double>
+	frame(const int width, const int height, const int t)
+	{
+		ImgVector<double> image(width, height);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				const double u = double(x - t);
+				const double v = double(y - t / 2);
+				image.at(x, y) = 0.5 + 0.2 * std::sin(0.21 * u) * std::cos(0.17 * v) + 0.15 * std::sin(0.05 * (u + v));
+			}
+		}
+		return image;
+	}
+
+	// The best time of Repeat runs in milliseconds
+	template <class F>
+	double
+	best_time(F f)
+	{
+		double best = 0.0;
+		for (int i = 0; i < Repeat; i++) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			f();
+			double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (i == 0 || elapsed < best) {
+				best = elapsed;
+			}
+		}
+		return best;
+	}
+
+	double
+	MAD_row_major(const ImgVector<double>& reference, const ImgVector<double>& interest, const int x_ref, const int y_ref, const int x_int, const int y_int)
+	{
+		double sad = 0;
+		for (int y = 0; y < BlockSize; y++) {
+			for (int x = 0; x < BlockSize; x++) {
+				sad += std::fabs(reference.get_zeropad(x_ref + x, y_ref + y) - interest.get_zeropad(x_int + x, y_int + y));
+			}
+		}
+		return sad / double(BlockSize * BlockSize);
+	}
+
+	double
+	ZNCC_row_major(const ImgVector<double>& reference, const ImgVector<double>& interest, const IntegralImage<double>& integral_reference, const IntegralImage<double>& integral_interest, const int x_ref, const int y_ref, const int x_int, const int y_int)
+	{
+		const double N = BlockSize * BlockSize;
+		const double sum_reference = integral_reference.sum(x_ref, y_ref, BlockSize, BlockSize);
+		const double sum_interest = integral_interest.sum(x_int, y_int, BlockSize, BlockSize);
+		const double sum_sq_reference = integral_reference.sum_squared(x_ref, y_ref, BlockSize, BlockSize);
+		const double sum_sq_interest = integral_interest.sum_squared(x_int, y_int, BlockSize, BlockSize);
+		double sum_sq_reference_interest = 0;
+		for (int y = 0; y < BlockSize; y++) {
+			for (int x = 0; x < BlockSize; x++) {
+				sum_sq_reference_interest += reference.get_zeropad(x_ref + x, y_ref + y) * interest.get_zeropad(x_int + x, y_int + y);
+			}
+		}
+		return (N * sum_sq_reference_interest - sum_reference * sum_interest)
+		    / (sqrt((N * sum_sq_reference - sum_reference * sum_reference) * (N * sum_sq_interest - sum_interest * sum_interest)) + DBL_EPSILON);
+	}
+
+	// The search of BlockMatching<double>::block_matching_lattice() with the row-major access
+	void
+	block_matching_row_major(ImgVector<VECTOR_2D<double> >* vectors, const ImgVector<double>& reference, const ImgVector<double>& current)
+	{
+		const IntegralImage<double> integral_reference(reference);
+		const IntegralImage<double> integral_current(current);
+		const int cells_width = Width / BlockSize;
+		const int cells_height = Height / BlockSize;
+		vectors->reset(cells_width, cells_height);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int Y_b = 0; Y_b < cells_height; Y_b++) {
+			const int y_b = Y_b * BlockSize;
+			for (int X_b = 0; X_b < cells_width; X_b++) {
+				const int x_b = X_b * BlockSize;
+				const int x_start = std::max(x_b - Search_Range / 2, 1 - BlockSize);
+				const int x_end = std::min(x_b + Search_Range / 2, Width - 1);
+				const int y_start = std::max(y_b - Search_Range / 2, 1 - BlockSize);
+				const int y_end = std::min(y_b + Search_Range / 2, Height - 1);
+				double E_min = DBL_MAX;
+				VECTOR_2D<double> MV(.0, .0);
+				for (int y = y_start; y <= y_end; y++) {
+					for (int x = x_start; x <= x_end; x++) {
+						VECTOR_2D<double> v_tmp(double(x - x_b), double(y - y_b));
+						double MAD = MAD_row_major(reference, current, x, y, x_b, y_b);
+						double ZNCC = ZNCC_row_major(reference, current, integral_reference, integral_current, x, y, x_b, y_b);
+						double E_tmp = MAD + 0.0 * (1.0 - ZNCC);
+						if (E_tmp < E_min) {
+							E_min = E_tmp;
+							MV = v_tmp;
+						} else if (fabs(E_tmp - E_min) < 1.0E-6
+						    && norm_squared(MV) >= norm_squared(v_tmp)) {
+							E_min = E_tmp;
+							MV = v_tmp;
+						}
+					}
+				}
+				vectors->at(X_b, Y_b) = MV;
+			}
+		}
+	}
+
+	// The motion compensation of MotionCompensation<double>::create_image_compensated() by the batches of 32 x 32 tiles
+	void
+	motion_compensation_tiled(ImgVector<double>* compensated, const ImgVector<double>& reference, const ImgVector<VECTOR_2D<double> >& vector)
+	{
+		const int TileSize = 32;
+		const int tiles_width = (Width + TileSize - 1) / TileSize;
+		const int tiles_height = (Height + TileSize - 1) / TileSize;
+		const ImgKernel kernel = ImgKernel::bicubic();
+		compensated->reset(Width, Height);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+		{
+			const size_t tile_size = size_t(TileSize) * size_t(TileSize);
+			std::vector<size_t> pixel_prev(tile_size);
+			std::vector<double> x_prev(tile_size);
+			std::vector<double> y_prev(tile_size);
+			std::vector<double> values_prev(tile_size);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+			for (int tile = 0; tile < tiles_width * tiles_height; tile++) {
+				const int x_tile = (tile % tiles_width) * TileSize;
+				const int y_tile = (tile / tiles_width) * TileSize;
+				size_t n_prev = 0;
+				for (int y = y_tile; y < std::min(y_tile + TileSize, Height); y++) {
+					for (int x = x_tile; x < std::min(x_tile + TileSize, Width); x++) {
+						pixel_prev[n_prev] = size_t(Width) * size_t(y) + size_t(x);
+						x_prev[n_prev] = x + vector.get(x, y).x;
+						y_prev[n_prev] = y + vector.get(x, y).y;
+						n_prev++;
+					}
+				}
+				reference.sample_zeropad(values_prev.data(), x_prev.data(), y_prev.data(), n_prev, kernel);
+				for (size_t n = 0; n < n_prev; n++) {
+					compensated->at(pixel_prev[n]) = values_prev[n];
+				}
+			}
+		}
+	}
+}
+
+int
+main(void)
+{
+	int failures = 0;
+	const ImgVector<double> prev = frame(Width, Height, 0);
+	const ImgVector<double> current = frame(Width, Height, 1);
+	const ImgVector<double> next = frame(Width, Height, 2);
+
+	printf("%d x %d, best of %d runs\n", Width, Height, Repeat);
+	printf("                        row-major       tiled   ratio\n");
+	// Block matching of the previous and the next frames (the tiled search window in the library)
+	{
+		ImgVector<VECTOR_2D<double> > vectors_prev;
+		ImgVector<VECTOR_2D<double> > vectors_next;
+		BlockMatching<double> block_matching;
+		const double time_row_major = best_time([&]() {
+			block_matching_row_major(&vectors_prev, prev, current);
+			block_matching_row_major(&vectors_next, next, current);
+		});
+		const double time_tiled = best_time([&]() {
+			block_matching.reset(prev, current, next, BlockSize);
+			block_matching.block_matching(Search_Range);
+		});
+		for (size_t n = 0; n < vectors_prev.size(); n++) {
+			if (vectors_prev[n] != block_matching.ref_motion_vector_prev()[n]
+			    || vectors_next[n] != block_matching.ref_motion_vector_next()[n]) {
+				failures++;
+			}
+		}
+		printf("BlockMatching      %9.1f ms %9.1f ms %6.2f\n", time_row_major, time_tiled, time_row_major / time_tiled);
+	}
+	// Motion compensation by the smoothly varying motion (the row-major batches in the library)
+	{
+		ImgVector<VECTOR_2D<double> > vector(Width, Height);
+		for (int y = 0; y < Height; y++) {
+			for (int x = 0; x < Width; x++) {
+				vector.at(x, y) = VECTOR_2D<double>(2.5 * std::sin(y / 50.0) + 0.25, 1.5 * std::cos(x / 70.0) + 0.5);
+			}
+		}
+		MotionCompensation<double> compensation(prev, current, vector);
+		ImgVector<double> compensated_tiled;
+		const double time_row_major = best_time([&]() {
+			compensation.create_image_compensated();
+		});
+		const double time_tiled = best_time([&]() {
+			motion_compensation_tiled(&compensated_tiled, prev, vector);
+		});
+		for (size_t n = 0; n < compensated_tiled.size(); n++) {
+			if (compensation.ref_image_compensated()[n] != compensated_tiled[n]) {
+				failures++;
+			}
+		}
+		printf("MotionCompensation %9.1f ms %9.1f ms %6.2f\n", time_row_major, time_tiled, time_row_major / time_tiled);
+	}
+	if (failures > 0) {
+		printf("%d results differ from the row-major access\n", failures);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+/*
+ * Unite the random pairs of ImgDisjointSet and compare the sets with the naive relabelling of the components.
+ *
+ * g++ -std=c++11 -I.. ImgDisjointSet.cpp -o ImgDisjointSet
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../ImgDisjointSet.h"
+
+int
+main(void)
+{
+	const size_t Size = 1000;
+	const size_t Pairs = 700;
+	int failures = 0;
+
+	ImgDisjointSet disjoint_set(Size);
+	std::vector<size_t> component(Size); // The smallest index of the set of each index
+	for (size_t n = 0; n < Size; n++) {
+		component[n] = n;
+		if (disjoint_set.is_root(n) == false || disjoint_set.find(n) != n) {
+			failures++;
+		}
+	}
+	std::mt19937 random(1);
+	std::uniform_int_distribution<size_t> index(0, Size - 1);
+	for (size_t i = 0; i < Pairs; i++) {
+		const size_t a = index(random);
+		const size_t b = index(random);
+		const size_t smallest = std::min(component[a], component[b]);
+		const size_t largest = std::max(component[a], component[b]);
+		for (size_t n = 0; n < Size; n++) {
+			if (component[n] == largest) {
+				component[n] = smallest;
+			}
+		}
+		// The root of the united set is its smallest index
+		if (disjoint_set.unite(a, b) != smallest) {
+			failures++;
+		}
+	}
+	for (size_t n = 0; n < Size; n++) {
+		if (disjoint_set.root(n) != component[n]
+		    || disjoint_set.find(n) != component[n]
+		    || disjoint_set.is_root(n) != (component[n] == n)) {
+			failures++;
+		}
+	}
+	// A new set and the reset
+	const size_t added = disjoint_set.add();
+	if (added != Size || disjoint_set.size() != Size + 1 || disjoint_set.find(added) != added) {
+		failures++;
+	}
+	if (disjoint_set.unite(added, Size - 1) != component[Size - 1] || disjoint_set.find(added) != component[Size - 1]) {
+		failures++;
+	}
+	disjoint_set.reset(Size);
+	for (size_t n = 0; n < Size; n++) {
+		if (disjoint_set.is_root(n) == false) {
+			failures++;
+		}
+	}
+	if (failures > 0) {
+		std::cerr << "ImgDisjointSet : " << failures << " failures" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "ImgDisjointSet : OK" << std::endl;
+	return EXIT_SUCCESS;
+}
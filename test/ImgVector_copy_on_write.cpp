@@ -0,0 +1,53 @@
+/*
+ * Write the different pixels of the copied images from multiple threads.
+ *
+ * g++ -std=c++11 -fopenmp -I.. ImgVector_copy_on_write.cpp -o ImgVector_copy_on_write
+ */
+#include <cstdlib>
+#include <iostream>
+
+#include "../ImgClass.h"
+
+int
+main(void)
+{
+	const int Width = 256;
+	const int Height = 256;
+	const int Repeat = 64;
+	int failures = 0;
+
+	for (int repeat = 0; repeat < Repeat; repeat++) {
+		ImgVector<double> original(Width, Height, 1.0);
+		ImgVector<double> copy(original);
+		ImgVector<double> copy_of_copy;
+		copy_of_copy = copy;
+		// Each thread writes its own pixels through the non-const accessors of the shared images
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int y = 0; y < Height; y++) {
+			for (int x = 0; x < Width; x++) {
+				copy.at(x, y) = double(y * Width + x);
+				copy_of_copy[size_t(Width) * size_t(y) + size_t(x)] = -1.0;
+			}
+		}
+		for (int y = 0; y < Height; y++) {
+			for (int x = 0; x < Width; x++) {
+				if (original.get(x, y) != 1.0
+				    || copy.get(x, y) != double(y * Width + x)
+				    || copy_of_copy.get(x, y) != -1.0) {
+					failures++;
+				}
+			}
+		}
+		if (original.isShared() || copy.isShared() || copy_of_copy.isShared()) {
+			failures++;
+		}
+	}
+	if (failures > 0) {
+		std::cerr << "ImgVector copy-on-write : " << failures << " failures" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "ImgVector copy-on-write : OK" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+/*
+ * Segment an image with the strips of the different ImgParallel::grain_size() and check the regions
+ * are the 8-connected components numbered in raster order (by a serial flood fill) and do not depend on the strips.
+ *
+ * g++ -std=c++11 -fopenmp -I.. Segmentation_collect_regions.cpp ../RGB.cpp ../Lab.cpp ../HSV.cpp ../Segmentation.cpp -o Segmentation_collect_regions
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../Color.h"
+#include "../ImgClass.h"
+#include "../Segmentation.h"
+
+namespace {
+	// Label the 8-connected components of the same number by a serial flood fill (from 1 in raster order of their first pixels)
+	std::vector<size_t>
+	flood_fill(const ImgVector<size_t>& segmentation_map)
+	{
+		const int width = segmentation_map.width();
+		const int height = segmentation_map.height();
+		std::vector<size_t> labels(segmentation_map.size(), 0);
+		std::vector<size_t> stack;
+		size_t num = 0;
+		for (size_t n = 0; n < labels.size(); n++) {
+			if (labels[n] != 0) {
+				continue;
+			}
+			labels[n] = ++num;
+			stack.push_back(n);
+			while (stack.empty() == false) {
+				const int x = int(stack.back() % size_t(width));
+				const int y = int(stack.back() / size_t(width));
+				stack.pop_back();
+				for (int dy = -1; dy <= 1; dy++) {
+					for (int dx = -1; dx <= 1; dx++) {
+						if (0 <= x + dx && x + dx < width && 0 <= y + dy && y + dy < height
+						    && labels[size_t(width) * size_t(y + dy) + size_t(x + dx)] == 0
+						    && segmentation_map.get(x + dx, y + dy) == segmentation_map.get(n)) {
+							labels[size_t(width) * size_t(y + dy) + size_t(x + dx)] = num;
+							stack.push_back(size_t(width) * size_t(y + dy) + size_t(x + dx));
+						}
+					}
+				}
+			}
+		}
+		return labels;
+	}
+}
+
+int
+main(void)
+{
+	const int Width = 97;
+	const int Height = 83;
+	const size_t Grains[] = {size_t(1) << 30, 1, size_t(Width) * 3, 500};
+	ImgVector<double> image(Width, Height);
+	std::mt19937 random(1);
+	std::uniform_int_distribution<int> level(0, 3);
+	for (int y = 0; y < Height; y++) {
+		for (int x = 0; x < Width; x++) {
+			image.at(x, y) = 0.25 * level(random);
+		}
+	}
+	const size_t Default_Grain = ImgParallel::grain_size();
+	std::vector<size_t> serial; // The segmentation map in a single strip
+	int failures = 0;
+	for (const size_t grain : Grains) {
+		ImgParallel::set_grain_size(grain);
+		ImgClass::Segmentation<double> segmentation(image, 2.0, 10.0 / 255.0, 1);
+		const ImgVector<size_t>& segmentation_map = segmentation.ref_segmentation_map();
+		const std::vector<size_t> labels = flood_fill(segmentation_map);
+		std::vector<size_t> map(segmentation_map.data(), segmentation_map.data() + segmentation_map.size());
+		if (serial.empty()) {
+			serial = map;
+		}
+		if (map != labels || map != serial || labels.back() == 0 || segmentation.ref_regions().size() != *std::max_element(labels.begin(), labels.end())) {
+			std::cerr << "grain size " << grain << " : the regions differ from the serial flood fill" << std::endl;
+			failures++;
+		}
+	}
+	ImgParallel::set_grain_size(Default_Grain);
+	if (failures > 0) {
+		std::cerr << "Segmentation collect_regions_in_segmentation_map : " << failures << " failures" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "Segmentation collect_regions_in_segmentation_map : OK" << std::endl;
+	return EXIT_SUCCESS;
+}
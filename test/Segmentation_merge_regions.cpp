@@ -0,0 +1,110 @@
+/*
+ * Segment the images with min_number_of_pixels and check no region is smaller than it
+ * and ref_region_graph() is the region adjacency graph rebuilt from the segmentation map.
+ *
+ * g++ -std=c++11 -fopenmp -I.. Segmentation_merge_regions.cpp ../RGB.cpp ../Lab.cpp ../HSV.cpp ../Segmentation.cpp -o Segmentation_merge_regions
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../Color.h"
+#include "../ImgClass.h"
+#include "../Segmentation.h"
+
+namespace {
+	double
+	color_error(const double& lvalue, const double& rvalue)
+	{
+		return fabs(lvalue - rvalue);
+	}
+
+	double
+	color_error(const ImgClass::RGB& lvalue, const ImgClass::RGB& rvalue)
+	{
+		return fabs(lvalue.R - rvalue.R) + fabs(lvalue.G - rvalue.G) + fabs(lvalue.B - rvalue.B);
+	}
+
+	template <class T>
+	int
+	merge_regions(const ImgVector<T>& image, const char* name, const size_t min_pixels)
+	{
+		const int width = image.width();
+		const int height = image.height();
+		ImgClass::Segmentation<T> segmentation(image, 6.0, 12.0 / 255.0, min_pixels);
+		const ImgVector<size_t>& segmentation_map = segmentation.ref_segmentation_map();
+		const typename ImgClass::Segmentation<T>::RegionGraph& graph = segmentation.ref_region_graph();
+		const size_t num_regions = segmentation.ref_regions().size();
+		int failures = 0;
+		// The image is connected, so every small region can reach a large region
+		for (size_t n = 0; n < num_regions; n++) {
+			if (segmentation.ref_regions()[n].size() < min_pixels) {
+				std::cerr << name << " : the region " << n << " has " << segmentation.ref_regions()[n].size() << " pixels" << std::endl;
+				failures++;
+			}
+		}
+		// Rebuild the graph from the segmentation map
+		std::vector<size_t> pixels(num_regions, 0);
+		std::vector<T> sum_colors(num_regions, T());
+		std::vector<std::vector<size_t> > adjacent(num_regions);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				const size_t region = segmentation_map.get(x, y) - 1;
+				pixels[region]++;
+				sum_colors[region] += image.get(x, y);
+				for (int dy = -1; dy <= 1; dy++) {
+					for (int dx = -1; dx <= 1; dx++) {
+						if (0 <= x + dx && x + dx < width && 0 <= y + dy && y + dy < height
+						    && segmentation_map.get(x + dx, y + dy) - 1 != region) {
+							adjacent[region].push_back(segmentation_map.get(x + dx, y + dy) - 1);
+						}
+					}
+				}
+			}
+		}
+		if (graph.offsets.size() != num_regions + 1 || graph.pixels.size() != num_regions || graph.colors.size() != num_regions) {
+			std::cerr << name << " : the graph has the wrong number of the regions" << std::endl;
+			return failures + 1;
+		}
+		for (size_t n = 0; n < num_regions; n++) {
+			std::sort(adjacent[n].begin(), adjacent[n].end());
+			adjacent[n].erase(std::unique(adjacent[n].begin(), adjacent[n].end()), adjacent[n].end());
+			const std::vector<size_t> neighbors(graph.adjacent.begin() + graph.offsets[n], graph.adjacent.begin() + graph.offsets[n + 1]);
+			if (neighbors != adjacent[n]
+			    || graph.pixels[n] != pixels[n]
+			    || color_error(graph.colors[n], sum_colors[n] / double(pixels[n])) > 1.0e-9) {
+				std::cerr << name << " : the region " << n << " of the graph differs from the segmentation map" << std::endl;
+				failures++;
+			}
+		}
+		return failures;
+	}
+}
+
+int
+main(void)
+{
+	const int Width = 120;
+	const int Height = 90;
+	ImgVector<double> gray(Width, Height);
+	ImgVector<ImgClass::RGB> rgb(Width, Height);
+	for (int y = 0; y < Height; y++) {
+		for (int x = 0; x < Width; x++) {
+			const double value = 0.5 + 0.3 * sin(x * 0.05) * cos(y * 0.07) + ((x / 25 + y / 25) % 2) * 0.2 + 0.01 * ((x * 7 + y * 13) % 5);
+			gray.at(x, y) = value;
+			rgb.at(x, y) = ImgClass::RGB(value, 0.5 + 0.4 * sin(y * 0.03), 0.3 + 0.2 * ((x / 40) % 2));
+		}
+	}
+	int failures = 0;
+	failures += merge_regions(gray, "gray", 4);
+	failures += merge_regions(gray, "gray", 40);
+	failures += merge_regions(rgb, "RGB", 40);
+	if (failures > 0) {
+		std::cerr << "Segmentation merge_small_regions : " << failures << " failures" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "Segmentation merge_small_regions : OK" << std::endl;
+	return EXIT_SUCCESS;
+}
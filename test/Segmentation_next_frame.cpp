@@ -0,0 +1,116 @@
+/*
+ * Segment the frames of a moving image by next_frame() with and without the motion field
+ * and check the labels of the regions stay with the moved pixels.
+ *
+ * g++ -std=c++11 -fopenmp -I.. Segmentation_next_frame.cpp ../RGB.cpp ../Lab.cpp ../HSV.cpp ../Segmentation.cpp -o Segmentation_next_frame
+ */
+#include <cstdlib>
+#include <iostream>
+
+#include "../Color.h"
+#include "../ImgClass.h"
+#include "../Segmentation.h"
+
+namespace {
+	const int Width = 96;
+	const int Height = 64;
+	const int Shift = 3; // The objects move Shift pixels to the right on each frame
+
+	// Rectangles of the different colors on the gradation
+	ImgClass::Lab
+	scene(const int x, const int y)
+	{
+		if (12 <= x && x < 40 && 10 <= y && y < 34) {
+			return ImgClass::Lab(60.0, 40.0, 20.0);
+		} else if (48 <= x && x < 80 && 30 <= y && y < 56) {
+			return ImgClass::Lab(40.0, -30.0, 30.0);
+		}
+		return ImgClass::Lab(80.0 - 0.1 * y, 0.0, 0.0);
+	}
+
+	ImgVector<ImgClass::Lab>
+	frame(const int t)
+	{
+		ImgVector<ImgClass::Lab> image(Width, Height);
+		for (int y = 0; y < Height; y++) {
+			for (int x = 0; x < Width; x++) {
+				image.at(x, y) = scene(x - Shift * t, y);
+			}
+		}
+		return image;
+	}
+
+	size_t
+	label(const ImgClass::Segmentation<ImgClass::Lab>& segmentation, const int x, const int y)
+	{
+		return segmentation.ref_region_labels()[segmentation.ref_segmentation_map().get(x, y) - 1];
+	}
+
+	// The fraction of the pixels of the next frame whose labels are the labels of the pixels they moved from
+	// (only the pixels of the colors unchanged from the pixels they moved from are counted if unchanged is true)
+	double
+	stable_fraction(const ImgClass::Segmentation<ImgClass::Lab>& current, const ImgClass::Segmentation<ImgClass::Lab>& next, const ImgVector<ImgClass::Lab>& image_current, const ImgVector<ImgClass::Lab>& image_next, const int shift, const bool unchanged)
+	{
+		size_t stable = 0;
+		size_t count = 0;
+		for (int y = 0; y < Height; y++) {
+			for (int x = shift; x < Width; x++) {
+				if (unchanged && image_next.get(x, y) != image_current.get(x - shift, y)) {
+					continue;
+				}
+				count++;
+				if (label(next, x, y) == label(current, x - shift, y)) {
+					stable++;
+				}
+			}
+		}
+		return double(stable) / double(count);
+	}
+}
+
+int
+main(void)
+{
+	const double Kernel_Spatial = 8.0;
+	const double Kernel_Intensity = 9.0 / 255.0;
+	int failures = 0;
+
+	ImgClass::Segmentation<ImgClass::Lab> current(frame(0), Kernel_Spatial, Kernel_Intensity);
+	// The same frame again : every pixel keeps its label
+	{
+		ImgClass::Segmentation<ImgClass::Lab> next(current);
+		next.next_frame(frame(0));
+		const double fraction = stable_fraction(current, next, frame(0), frame(0), 0, false);
+		if (fraction != 1.0 || next.ref_regions().size() != current.ref_regions().size()) {
+			std::cerr << "next_frame() of the same frame : " << fraction << " of the labels are kept" << std::endl;
+			failures++;
+		}
+	}
+	// The moved frame with the motion field
+	{
+		ImgVector<VECTOR_2D<double> > motion(Width, Height, VECTOR_2D<double>(double(Shift), 0.0));
+		ImgClass::Segmentation<ImgClass::Lab> next(current);
+		next.next_frame(frame(1), &motion);
+		const double fraction = stable_fraction(current, next, frame(0), frame(1), Shift, false);
+		if (fraction < 0.95) {
+			std::cerr << "next_frame() with the motion : " << fraction << " of the labels are kept" << std::endl;
+			failures++;
+		}
+	}
+	// The moved frame without the motion field : the pixels of the unchanged colors keep their labels
+	{
+		ImgClass::Segmentation<ImgClass::Lab> next(current);
+		next.next_frame(frame(1));
+		const double fraction = stable_fraction(current, next, frame(0), frame(1), 0, true);
+		if (fraction < 0.95) {
+			std::cerr << "next_frame() without the motion : " << fraction << " of the labels are kept" << std::endl;
+			failures++;
+		}
+	}
+	if (failures > 0) {
+		std::cerr << "Segmentation next_frame : " << failures << " failures" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "Segmentation next_frame : OK" << std::endl;
+	return EXIT_SUCCESS;
+}
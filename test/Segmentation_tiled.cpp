@@ -0,0 +1,97 @@
+/*
+ * Segment the images by Segmentation_Tiled() and check a single tile gives the untiled segmentation
+ * and the regions crossing the corners of the tiles only diagonally are stitched.
+ *
+ * g++ -std=c++11 -fopenmp -I.. Segmentation_tiled.cpp ../RGB.cpp ../Lab.cpp ../HSV.cpp ../Segmentation.cpp -o Segmentation_tiled
+ */
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "../Color.h"
+#include "../ImgClass.h"
+#include "../Segmentation.h"
+
+namespace {
+	template <class T>
+	int
+	single_tile(const ImgVector<T>& image, const char* name, const double kernel_spatial, const double kernel_intensity)
+	{
+		ImgClass::Segmentation<T> untiled(image, kernel_spatial, kernel_intensity);
+		ImgClass::Segmentation<T> settings;
+		settings.set_kernel(kernel_spatial, kernel_intensity);
+		ImgVector<size_t> segmentation_map;
+		const size_t num_regions = settings.Segmentation_Tiled(image, &segmentation_map, std::max(image.width(), image.height()));
+		int failures = 0;
+		if (num_regions != untiled.ref_regions().size()) {
+			failures++;
+		}
+		for (size_t n = 0; n < image.size(); n++) {
+			if (segmentation_map.get(n) != untiled.ref_segmentation_map().get(n)) {
+				failures++;
+				break;
+			}
+		}
+		if (failures > 0) {
+			std::cerr << name << " : a single tile differs from the untiled segmentation" << std::endl;
+		}
+		return failures;
+	}
+
+	// The diagonal line crosses the corners of the tiles where only the pixels (Tile * k - 1, Tile * k - 1) and (Tile * k, Tile * k) are on it
+	int
+	corner_stitching(const int tile_size)
+	{
+		const int Size = 32;
+		ImgVector<double> image(Size, Size, 0.2);
+		for (int n = 0; n < Size; n++) {
+			image.at(n, n) = 0.8;
+		}
+		ImgClass::Segmentation<double> untiled(image, 4.0, 10.0 / 255.0, 1);
+		ImgClass::Segmentation<double> settings;
+		settings.set_kernel(4.0, 10.0 / 255.0);
+		settings.set_min_pixels(1);
+		ImgVector<size_t> segmentation_map;
+		settings.Segmentation_Tiled(image, &segmentation_map, tile_size);
+		int failures = 0;
+		for (int n = 1; n < Size; n++) {
+			if (untiled.get(n, n) == untiled.get(0, 0) && segmentation_map.get(n, n) != segmentation_map.get(0, 0)) {
+				failures++;
+			}
+		}
+		if (segmentation_map.get(tile_size, tile_size - 1) == segmentation_map.get(tile_size, tile_size)) {
+			failures++;
+		}
+		if (failures > 0) {
+			std::cerr << "tiles of " << tile_size << " pixels : the diagonal line is not stitched at the corners" << std::endl;
+		}
+		return failures;
+	}
+}
+
+int
+main(void)
+{
+	const int Width = 120;
+	const int Height = 90;
+	ImgVector<double> gray(Width, Height);
+	ImgVector<ImgClass::RGB> rgb(Width, Height);
+	for (int y = 0; y < Height; y++) {
+		for (int x = 0; x < Width; x++) {
+			const double value = 0.5 + 0.3 * sin(x * 0.05) * cos(y * 0.07) + ((x / 25 + y / 25) % 2) * 0.2;
+			gray.at(x, y) = value;
+			rgb.at(x, y) = ImgClass::RGB(value, 0.5 + 0.4 * sin(y * 0.03), 0.3 + 0.2 * ((x / 40) % 2));
+		}
+	}
+	int failures = 0;
+	failures += single_tile(gray, "gray", 6.0, 12.0 / 255.0);
+	failures += single_tile(rgb, "RGB", 6.0, 12.0 / 255.0);
+	failures += corner_stitching(16);
+	failures += corner_stitching(8);
+	if (failures > 0) {
+		std::cerr << "Segmentation Segmentation_Tiled : " << failures << " failures" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "Segmentation Segmentation_Tiled : OK" << std::endl;
+	return EXIT_SUCCESS;
+}